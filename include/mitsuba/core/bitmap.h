@@ -481,8 +481,24 @@ public:
                         Struct::Type component_format,
                         bool srgb_gamma = true) const;
 
+    /**
+     * \brief Convert the bitmap into the pixel and component format of an
+     * existing bitmap of the same size
+     */
     void convert(Bitmap *target) const;
 
+    /**
+     * \brief Convert a rectangular region of this bitmap into a region of
+     * another bitmap with a potentially different pixel and component format
+     *
+     * The conversion follows the same rules as the main <tt>convert()</tt>
+     * implementation. Out-of-bounds regions are safely ignored.
+     */
+    void convert(Bitmap *target,
+                 Point2i source_offset,
+                 Point2i target_offset,
+                 Vector2i size) const;
+
     /**
      * \brief Accumulate the contents of another bitmap into the
      * region with the specified offset
@@ -693,6 +709,73 @@ void accumulate_2d(ConstT source,
     }
 }
 
+/**
+ * \brief Incrementally writes a tiled OpenEXR file
+ *
+ * This makes it possible to store images that are too large to be held in
+ * memory as a whole. The file is created by the constructor, after which the
+ * tiles can be written in arbitrary order (and from several threads) using
+ * \ref write_tile(). The file is complete once every tile has been written
+ * and the writer was closed.
+ */
+class MTS_EXPORT_CORE TiledEXRWriter : public Object {
+public:
+    using Float = float;
+    MTS_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a tiled OpenEXR file
+     *
+     * \param filename
+     *     Path of the output file
+     *
+     * \param layout
+     *     Bitmap, whose pixel format, component format, channel names and
+     *     metadata are used for the file (its size is irrelevant)
+     *
+     * \param size
+     *     Resolution of the complete image
+     *
+     * \param tile_size
+     *     Edge length of the (square) tiles
+     */
+    TiledEXRWriter(const fs::path &filename, const Bitmap *layout,
+                   const Vector2u &size, uint32_t tile_size);
+
+    /**
+     * \brief Write a tile of the image
+     *
+     * The offset must be a multiple of the tile size, and the bitmap must
+     * have the layout that was specified to the constructor. Its size must
+     * match the tile size, except for tiles at the right and bottom edges
+     * of the image.
+     */
+    void write_tile(const Point2u &offset, const Bitmap *tile);
+
+    /// Finish writing the file. This function is idempotent.
+    void close();
+
+    /// Return the resolution of the complete image
+    const Vector2u &size() const { return m_size; }
+
+    /// Return the edge length of the tiles
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /// Return a human-readable summary of this writer
+    std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor, closes the file
+    virtual ~TiledEXRWriter();
+
+private:
+    struct TiledEXRWriterPrivate;
+    Vector2u m_size;
+    uint32_t m_tile_size;
+    std::unique_ptr<TiledEXRWriterPrivate> d;
+};
+
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value);
 extern MTS_EXPORT_CORE std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value);
 
@@ -36,12 +36,15 @@ class Mutex;
 class PluginManager;
 class Properties;
 class ScopedThreadEnvironment;
+class ServerSocket;
+class SocketStream;
 class Stream;
 class StreamAppender;
 class Struct;
 class StructConverter;
 class Thread;
 class ThreadLocalBase;
+class TiledEXRWriter;
 class TraversalCallback;
 class ZStream;
 enum LogLevel : int;
@@ -285,11 +288,14 @@ template <typename Float_> struct CoreAliases {
     if constexpr (is_scalar_v<Float>)                                                              \
         mask = true;
 
+#if defined(MTS_ENABLE_PROFILER)
 #define MTS_MASKED_FUNCTION(profiler_phase, mask)                                                  \
-    ScopedPhase scope_phase(profiler_phase);                                                       \
-    (void) mask;                                                                                   \
-    if constexpr (is_scalar_v<Float>)                                                              \
-        mask = true;
+    ScopedPhase scope_phase(profiler_phase, this);                                                 \
+    MTS_MASK_ARGUMENT(mask)
+#else
+#define MTS_MASKED_FUNCTION(profiler_phase, mask)                                                  \
+    MTS_MASK_ARGUMENT(mask)
+#endif
 
 NAMESPACE_BEGIN(filesystem)
 class path;
@@ -116,8 +116,13 @@ protected:
     virtual ~Object();
 
 private:
+    friend class Profiler;
+
     mutable std::atomic<int> m_ref_count { 0 };
 
+    /// Was a name registered for this object? (see \ref Profiler::register_object())
+    mutable bool m_profiler_registered = false;
+
     static Class *m_class;
 };
 
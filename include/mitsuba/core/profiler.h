@@ -3,9 +3,15 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <atomic>
 
 #if !defined(MTS_PROFILE_HASH_SIZE)
-#  define MTS_PROFILE_HASH_SIZE 256
+#  define MTS_PROFILE_HASH_SIZE 1024
+#endif
+
+/// Capacity of the per-thread ring buffers holding timeline events
+#if !defined(MTS_PROFILE_TRACE_SIZE)
+#  define MTS_PROFILE_TRACE_SIZE 65536
 #endif
 
 NAMESPACE_BEGIN(mitsuba)
@@ -21,6 +27,9 @@ enum class ProfilerPhase : int {
     LoadTexture,                /* Texture loading */
     InitKDTree,                 /* kd-tree construction */
     Render,                     /* Integrator::render() */
+    RenderBlock,                /* SamplingIntegrator::render_block() */
+    FilmDevelop,                /* Film::develop() */
+    BitmapWrite,                /* Bitmap::write() */
     SamplingIntegratorSample,   /* SamplingIntegrator::sample() */
     SampleEmitterRay,           /* Scene::sample_emitter_ray() */
     SampleEmitterDirection,     /* Scene::sample_emitter_direction() */
@@ -50,6 +59,9 @@ constexpr const char
         "Texture loading",
         "kd-tree construction",
         "Integrator::render()",
+        "SamplingIntegrator::render_block()",
+        "Film::develop()",
+        "Bitmap::write()",
         "SamplingIntegrator::sample()",
         "Scene::sample_emitter_ray()",
         "Scene::sample_emitter_direction()",
@@ -87,25 +99,68 @@ static_assert(std::extent_v<decltype(profiler_phase_id)> ==
 extern MTS_EXPORT_CORE uint64_t *profiler_flags()
     __attribute__((noinline, weak, const));
 
+/// Per-thread profiler state that is inspected by the sampling signal handler
+struct ProfilerState {
+    /// Active phases (one bit per \ref ProfilerPhase)
+    uint64_t flags = 0;
+    /// Innermost object (BSDF, texture, ..) that the thread is executing
+    const Object *object = nullptr;
+};
+
+/// Same as \ref profiler_flags(), but provides access to the complete state
+extern MTS_EXPORT_CORE ProfilerState *profiler_state()
+    __attribute__((noinline, weak, const));
+
+/// Set when \ref ScopedPhase should record timeline events (see \ref Profiler::set_trace_enabled())
+extern MTS_EXPORT_CORE std::atomic<bool> profiler_trace_enabled;
+
+/// Monotonic timestamp in nanoseconds (never zero) used for timeline events
+extern MTS_EXPORT_CORE uint64_t profiler_trace_time();
+
+/// Append a completed phase to the timeline ring buffer of the calling thread
+extern MTS_EXPORT_CORE void profiler_trace_event(ProfilerPhase phase,
+                                                 uint64_t start, uint64_t end);
+
 struct ScopedPhase {
     ScopedPhase(ProfilerPhase phase)
-        : m_target(profiler_flags()), m_flag(1ull << int(phase)) {
-        if ((*m_target & m_flag) == 0)
-            *m_target |= m_flag;
-        else
+        : m_target(profiler_state()), m_flag(1ull << int(phase)), m_phase(phase),
+          m_object_prev(m_target->object) {
+        if ((m_target->flags & m_flag) == 0) {
+            m_target->flags |= m_flag;
+            if (unlikely(profiler_trace_enabled.load(std::memory_order_relaxed)))
+                m_start = profiler_trace_time();
+        } else {
             m_flag = 0;
+        }
+    }
+
+    /**
+     * \brief Enter a phase and additionally attribute the time spent within
+     * the scope to \c object (see \ref Profiler::register_object())
+     *
+     * Object scopes nest, i.e. a texture evaluated by a BSDF takes precedence
+     * over the BSDF until the texture's scope is left.
+     */
+    ScopedPhase(ProfilerPhase phase, const Object *object) : ScopedPhase(phase) {
+        m_target->object = object;
     }
 
     ~ScopedPhase() {
-        *m_target &= ~m_flag;
+        m_target->flags &= ~m_flag;
+        m_target->object = m_object_prev;
+        if (unlikely(m_start != 0))
+            profiler_trace_event(m_phase, m_start, profiler_trace_time());
     }
 
     ScopedPhase(const ScopedPhase &) = delete;
     ScopedPhase &operator=(const ScopedPhase &) = delete;
 
 private:
-    uint64_t* m_target;
-    uint64_t  m_flag;
+    ProfilerState *m_target;
+    uint64_t m_flag;
+    uint64_t m_start = 0;
+    ProfilerPhase m_phase;
+    const Object *m_object_prev;
 };
 
 class MTS_EXPORT_CORE Profiler : public Object {
@@ -113,6 +168,62 @@ public:
     static void static_initialization();
     static void static_shutdown();
     static void print_report();
+
+    /**
+     * \brief Register a human-readable name for an object (BSDF, texture,
+     * shape, emitter, ..)
+     *
+     * Samples taken while \c object is the innermost object scope (see
+     * \ref ScopedPhase) are then reported individually by \ref
+     * print_report(), which helps to identify the scene assets that are
+     * expensive to render. Registrations persist after the object has been
+     * destroyed (see \ref unregister_object()), so that the report remains
+     * valid at the end of a session.
+     */
+    static void register_object(const Object *object, const std::string &name);
+
+    /**
+     * \brief Convenience wrapper around \ref register_object() that builds
+     * the name from the plugin name and the scene \c id found in \c props
+     */
+    static void register_object(const Object *object, const Properties &props);
+
+    /**
+     * \brief Notify the profiler that \c object is about to be destroyed
+     *
+     * Called by the destructor of \ref Object, but only for objects that
+     * were registered. Samples that were taken so far remain attributed to
+     * the object's name, while later samples involving another object at
+     * the same address are not. Names that no sample refers to are
+     * eventually discarded.
+     */
+    static void unregister_object(const Object *object);
+
+    /**
+     * \brief Enable or disable the recording of timeline events
+     *
+     * While enabled, every outermost \ref ScopedPhase stores its begin and
+     * end time in a per-thread ring buffer holding the most recent
+     * \c MTS_PROFILE_TRACE_SIZE events. The timeline can be exported using
+     * \ref write_trace().
+     */
+    static void set_trace_enabled(bool enabled);
+
+    /// Is the recording of timeline events currently enabled?
+    static bool trace_enabled() { return profiler_trace_enabled; }
+
+    /// Discard all recorded timeline events
+    static void clear_trace();
+
+    /**
+     * \brief Write the recorded timeline events to a JSON file using the
+     * Chrome trace event format
+     *
+     * The resulting file can be inspected using <tt>chrome://tracing</tt>
+     * or the Perfetto UI (https://ui.perfetto.dev).
+     */
+    static void write_trace(const fs::path &filename);
+
     MTS_DECLARE_CLASS()
 private:
     Profiler() = delete;
@@ -121,12 +232,22 @@ private:
 #else
 
 /* Profiler not supported on this platform */
-struct ScopedPhase { ScopedPhase(ProfilerPhase) { } };
+struct ScopedPhase {
+    ScopedPhase(ProfilerPhase) { }
+    ScopedPhase(ProfilerPhase, const Object *) { }
+};
 class Profiler {
 public:
     static void static_initialization() { }
     static void static_shutdown() { }
     static void print_report() { }
+    static void register_object(const Object *, const std::string &) { }
+    static void register_object(const Object *, const Properties &) { }
+    static void unregister_object(const Object *) { }
+    static void set_trace_enabled(bool) { }
+    static bool trace_enabled() { return false; }
+    static void clear_trace() { }
+    static void write_trace(const fs::path &) { }
 };
 
 #endif
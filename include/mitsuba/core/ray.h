@@ -110,6 +110,28 @@ struct RayDifferential : Ray<Point_, Spectrum_> {
         d_y = fmadd(d_y - d, amount, d);
     }
 
+    /**
+     * \brief Replace the differentials by two offset rays that approximate a
+     * cone around this ray
+     *
+     * This is used to track the footprint of rays that were sampled by the
+     * BSDF (which normally carry no differentials), e.g. for texture filtering.
+     *
+     * \param width
+     *     Radius of the cone at the ray origin
+     *
+     * \param spread
+     *     Increase of the radius per unit distance along the ray
+     */
+    void set_cone(Float width, Float spread) {
+        auto [s, t] = coordinate_system(d);
+        o_x = fmadd(s, width, o);
+        o_y = fmadd(t, width, o);
+        d_x = fmadd(s, spread, d);
+        d_y = fmadd(t, spread, d);
+        has_differentials = true;
+    }
+
     ENOKI_DERIVED_STRUCT(RayDifferential, Base,
         ENOKI_BASE_FIELDS(o, d, d_rcp, mint, maxt, time, wavelengths),
         ENOKI_DERIVED_FIELDS(o_x, o_y, d_x, d_y, has_differentials)
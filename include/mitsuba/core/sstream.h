@@ -0,0 +1,152 @@
+#pragma once
+
+#include <mitsuba/core/stream.h>
+#include <mitsuba/core/logger.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/** \brief \ref Stream implementation backed by a TCP connection.
+ *
+ * Data is exchanged without any kind of buffering, hence \ref flush() is a
+ * no-op. Seeking and truncation are not supported, and \ref tell() and \ref
+ * size() respectively return the number of bytes that have been read from
+ * and written to the connection so far.
+ *
+ * \sa ServerSocket
+ */
+class MTS_EXPORT_CORE SocketStream : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+
+    /** \brief Connects to the TCP server at the given host name and port.
+     *
+     * Throws an exception if the connection cannot be established.
+     */
+    SocketStream(const std::string &host, uint16_t port);
+
+    /** \brief Closes the connection.
+     * No further read or write operations are permitted.
+     *
+     * This function is idempotent.
+     * It is called automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override;
+
+    /// Return a description of the remote end of the connection
+    const std::string &peer() const { return m_peer; }
+
+    /// Return the number of bytes that have been received so far
+    size_t received() const { return m_received; }
+
+    /// Return the number of bytes that have been sent so far
+    size_t sent() const { return m_sent; }
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    /**
+     * \brief Reads a specified amount of data from the connection.
+     * Throws an exception when the connection was closed prematurely.
+     */
+    virtual void read(void *p, size_t size) override;
+
+    /**
+     * \brief Writes a specified amount of data to the connection.
+     * Throws an exception when the connection was closed.
+     */
+    virtual void write(const void *p, size_t size) override;
+
+    /// Unsupported. Always throws.
+    virtual void seek(size_t pos) override;
+
+    /// Unsupported. Always throws.
+    virtual void truncate(size_t size) override;
+
+    /// Returns the number of bytes that have been received so far
+    virtual size_t tell() const override { return m_received; }
+
+    /// Returns the number of bytes that have been sent so far
+    virtual size_t size() const override { return m_sent; }
+
+    /// No-op, data is never buffered
+    virtual void flush() override { }
+
+    /// True except if the connection was closed.
+    virtual bool can_write() const override { return !is_closed(); }
+
+    /// True except if the connection was closed.
+    virtual bool can_read() const override { return !is_closed(); }
+
+    /// Returns a string representation
+    virtual std::string to_string() const override;
+
+    //! @}
+    // =========================================================================
+
+    MTS_DECLARE_CLASS()
+protected:
+    friend class ServerSocket;
+
+    /// Wrap an already connected socket (used by \ref ServerSocket::accept())
+    SocketStream(int64_t socket, const std::string &peer);
+
+    /// Protected destructor
+    virtual ~SocketStream();
+
+private:
+    int64_t m_socket;
+    std::string m_peer;
+    size_t m_received;
+    size_t m_sent;
+};
+
+/** \brief Listens for incoming TCP connections on a given port.
+ *
+ * Each accepted connection is returned as a \ref SocketStream.
+ */
+class MTS_EXPORT_CORE ServerSocket : public Object {
+public:
+    /**
+     * \brief Listen on the given port of all network interfaces.
+     *
+     * When \c port is zero, the operating system picks an unused port,
+     * which can be queried using \ref port().
+     */
+    ServerSocket(uint16_t port = 0);
+
+    /**
+     * \brief Wait for an incoming connection
+     *
+     * \param timeout
+     *     Maximum time to wait (in milliseconds). A negative value waits
+     *     indefinitely.
+     *
+     * \return The new connection, or \c nullptr upon a timeout
+     */
+    ref<SocketStream> accept(int timeout = -1);
+
+    /// Stop listening for connections. This function is idempotent.
+    void close();
+
+    /// Return the port on which the socket listens for connections
+    uint16_t port() const { return m_port; }
+
+    /// Returns a string representation
+    virtual std::string to_string() const override;
+
+    MTS_DECLARE_CLASS()
+protected:
+    /// Protected destructor
+    virtual ~ServerSocket();
+
+private:
+    int64_t m_socket;
+    uint16_t m_port;
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,154 @@
+/* Lightweight per-thread counters for render statistics */
+
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <array>
+
+#if !defined(MTS_STATS_PATH_LENGTH_BINS)
+#  define MTS_STATS_PATH_LENGTH_BINS 32
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// List of event counters that are tracked by the statistics subsystem
+enum class StatsCounter : int {
+    RaysTraced = 0,             /* Scene::ray_intersect() */
+    ShadowRaysTraced,           /* Scene::ray_test() */
+    KDNodesVisited,             /* Interior and leaf nodes visited by the kd-tree traversal */
+    KDPrimitivesVisited,        /* Primitive intersection tests in kd-tree leaves */
+    RussianRouletteTerminations,/* Paths terminated by Russian roulette */
+    PathSplits,                 /* Additional paths created by splitting */
+    InvalidSamples,             /* ImageBlock::put() (NaN / negative / infinite values) */
+
+    StatsCounterCount
+};
+
+constexpr const char
+    *stats_counter_id[int(StatsCounter::StatsCounterCount)] = {
+        "Rays traced",
+        "Shadow rays traced",
+        "kd-tree nodes visited",
+        "kd-tree primitives visited",
+        "Russian roulette terminations",
+        "Paths created by splitting",
+        "Invalid samples"
+    };
+
+static_assert(std::extent_v<decltype(stats_counter_id)> ==
+                  int(StatsCounter::StatsCounterCount),
+              "Statistics counters and descriptions don't have matching length!");
+
+/// Storage for the counters of a single thread (or the merged result)
+struct StatsData {
+    std::array<uint64_t, int(StatsCounter::StatsCounterCount)> counters { };
+
+    /**
+     * Histogram of path lengths. Entry \c i counts paths that were terminated
+     * after \c i bounces, the last entry also accumulates all longer paths.
+     */
+    std::array<uint64_t, MTS_STATS_PATH_LENGTH_BINS> path_length { };
+
+    /// Accumulate the counters of another instance into this one
+    StatsData &operator+=(const StatsData &other) {
+        for (size_t i = 0; i < counters.size(); ++i)
+            counters[i] += other.counters[i];
+        for (size_t i = 0; i < path_length.size(); ++i)
+            path_length[i] += other.path_length[i];
+        return *this;
+    }
+
+    /// Return the value of a specific counter
+    uint64_t operator[](StatsCounter counter) const { return counters[int(counter)]; }
+};
+
+#if defined(MTS_ENABLE_STATISTICS)
+/// Return the counter storage associated with the calling thread
+extern MTS_EXPORT_CORE StatsData *stats_data();
+#endif
+
+/**
+ * \brief Statistics subsystem
+ *
+ * Every thread increments its own set of counters (see \ref StatsData), which
+ * avoids contention on shared cache lines in the rendering hot paths. The
+ * per-thread values are merged on demand by \ref Statistics::data(), which is
+ * done by the integrators once rendering has finished. The counters can be
+ * disabled at compile time by turning off the \c MTS_ENABLE_STATISTICS CMake
+ * option, in which case all increments turn into no-ops.
+ */
+class MTS_EXPORT_CORE Statistics : public Object {
+public:
+    /// Increment a counter of the calling thread
+    static void add(StatsCounter counter, uint64_t amount = 1) {
+#if defined(MTS_ENABLE_STATISTICS)
+        stats_data()->counters[int(counter)] += amount;
+#else
+        (void) counter; (void) amount;
+#endif
+    }
+
+    /// Record \c amount paths that were terminated after \c depth bounces
+    static void add_path_length(size_t depth, uint64_t amount = 1) {
+#if defined(MTS_ENABLE_STATISTICS)
+        depth = std::min(depth, (size_t) MTS_STATS_PATH_LENGTH_BINS - 1);
+        stats_data()->path_length[depth] += amount;
+#else
+        (void) depth; (void) amount;
+#endif
+    }
+
+    /// Reset the counters of all threads
+    static void reset();
+
+    /// Merge the counters of all threads and return the result
+    static StatsData data();
+
+    /**
+     * \brief Return a human-readable summary of the current counters
+     *
+     * \param render_time
+     *     Elapsed render time in seconds. When positive, ray throughput
+     *     (rays/sec) is also included in the summary.
+     */
+    static std::string summary(double render_time = 0.0);
+
+    MTS_DECLARE_CLASS()
+private:
+    Statistics() = delete;
+};
+
+/**
+ * \brief Accumulates increments of a counter in a local variable and commits
+ * them to the per-thread storage when going out of scope
+ *
+ * This is useful in tight loops (e.g. kd-tree traversal), where accessing the
+ * thread-local counter storage for every single event would be too costly.
+ */
+struct ScopedStatsCounter {
+    ScopedStatsCounter(StatsCounter counter) : m_counter(counter) { }
+
+    ~ScopedStatsCounter() {
+        if (m_value > 0)
+            Statistics::add(m_counter, m_value);
+    }
+
+    ScopedStatsCounter &operator+=(uint64_t amount) {
+        m_value += amount;
+        return *this;
+    }
+
+    ScopedStatsCounter &operator++() {
+        m_value++;
+        return *this;
+    }
+
+    ScopedStatsCounter(const ScopedStatsCounter &) = delete;
+    ScopedStatsCounter &operator=(const ScopedStatsCounter &) = delete;
+
+private:
+    StatsCounter m_counter;
+    uint64_t m_value = 0;
+};
+
+NAMESPACE_END(mitsuba)
@@ -357,11 +357,13 @@ constexpr bool has_flag(uint32_t flags, Struct::Flags f)          { return (flag
  * this reason, the implementation of this class relies on a JIT compiler that
  * generates fast conversion code on demand for each specific conversion. The
  * function is cached and reused in case the same conversion is needed later
- * on. Note that JIT compilation only works on x86_64 processors; other
- * platforms use a slow generic fallback implementation.
+ * on. Note that JIT compilation only works on x86_64 processors. Other
+ * platforms use a vectorized implementation for the most common conversions
+ * (uint8, float16 and float32 fields with gamma correction, weights and
+ * blending) and a slow generic fallback implementation otherwise.
  */
 class MTS_EXPORT_CORE StructConverter : public Object {
-    using FuncType = bool (*) (size_t, size_t, const void *, void *);
+    using FuncType = bool (*) (size_t, size_t, size_t, const void *, void *);
 public:
     using Float = float;
 
@@ -383,17 +385,30 @@ public:
      * performs dithering to avoid banding artifacts (if enabled in the
      * constructor).
      *
+     * Large images are converted in parallel using bands of rows. The
+     * dithering pattern only depends on the pixel position, hence the
+     * result does not depend on the number of threads.
+     *
      * \return \c true upon success
      */
-#if MTS_STRUCTCONVERTER_USE_JIT == 1
     bool convert_2d(size_t width, size_t height, const void *src,
                     void *dest) const {
-        return m_func(width, height, src, dest);
+        return convert_2d(width, height, src, dest, width * m_source->size(),
+                          width * m_target->size());
     }
-#else
-    bool convert_2d(size_t width, size_t height, const void *src,
-                    void *dest) const;
-#endif
+
+    /**
+     * \brief Convert a 2D image whose rows are separated by the given
+     * strides (in bytes)
+     *
+     * This is useful to convert a rectangular subregion of a larger image.
+     * Otherwise, it behaves exactly like the main \ref convert_2d()
+     * implementation.
+     *
+     * \return \c true upon success
+     */
+    bool convert_2d(size_t width, size_t height, const void *src, void *dest,
+                    size_t src_stride, size_t dest_stride) const;
 
     /// Return the source \c Struct descriptor
     const Struct *source() const { return m_source.get(); }
@@ -406,6 +421,19 @@ public:
 
     MTS_DECLARE_CLASS()
 protected:
+    /**
+     * \brief Single-threaded conversion kernel for \c height contiguous rows,
+     * the first of which has the index \c y_offset (used for dithering)
+     */
+#if MTS_STRUCTCONVERTER_USE_JIT == 1
+    bool convert_rows(size_t width, size_t height, size_t y_offset,
+                      const void *src, void *dest) const {
+        return m_func(width, height, y_offset, src, dest);
+    }
+#else
+    bool convert_rows(size_t width, size_t height, size_t y_offset,
+                      const void *src, void *dest) const;
+#endif
 
 #if MTS_STRUCTCONVERTER_USE_JIT == 0
     // Support data structures/functions for non-accelerated conversion backend
@@ -425,6 +453,33 @@ protected:
     bool load(const uint8_t *src, const Struct::Field &f, Value &value) const;
     void linearize(Value &value) const;
     void save(uint8_t *dst, const Struct::Field &f, Value value, size_t x, size_t y) const;
+
+    /* Vectorized backend for the most common conversions (uint8, float16 and
+       float32 fields with gamma, weights and blending), which processes
+       packets of pixels and falls back to the generic code otherwise */
+
+    /// Source field contributing to a target field
+    struct FastInput {
+        size_t offset;
+        Struct::Type type;
+        float scale;  // Normalization factor (applied before removing gamma)
+        float weight; // Blend weight
+        bool gamma;
+    };
+
+    /// Precomputed conversion steps for a single target field
+    struct FastField {
+        const Struct::Field *field;
+        std::vector<FastInput> inputs; // Empty: use the field's default value
+        bool copy;                     // Bitwise copy of the first input
+    };
+
+    /// Try to set up the vectorized backend. Returns \c false if unsupported.
+    bool fast_init();
+
+    /// Vectorized counterpart of \ref convert_rows()
+    bool fast_convert_rows(size_t width, size_t height, size_t y_offset,
+                           const uint8_t *src, uint8_t *dest) const;
 #endif
 
 protected:
@@ -434,6 +489,10 @@ protected:
     FuncType m_func;
 #else
     bool m_dither;
+    bool m_fast = false;
+    std::vector<FastField> m_fast_fields;
+    FastInput m_fast_weight;
+    bool m_fast_has_weight = false;
 #endif
 };
 
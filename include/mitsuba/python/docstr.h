@@ -308,6 +308,8 @@ setting combinations in BSDFContext::type_mask.)doc";
 
 static const char *__doc_mitsuba_BSDFFlags_All = R"doc(Any kind of scattering)doc";
 
+static const char *__doc_mitsuba_BSDFFlags_AlphaTest = R"doc(Transparency is resolved during ray traversal (see BSDF::alpha_test()))doc";
+
 static const char *__doc_mitsuba_BSDFFlags_Anisotropic = R"doc(The lobe is not invariant to rotation around the normal)doc";
 
 static const char *__doc_mitsuba_BSDFFlags_BackSide = R"doc(Supports interactions on the back-facing side)doc";
@@ -338,7 +340,10 @@ static const char *__doc_mitsuba_BSDFFlags_GlossyReflection = R"doc(Glossy refle
 
 static const char *__doc_mitsuba_BSDFFlags_GlossyTransmission = R"doc(Glossy transmission)doc";
 
-static const char *__doc_mitsuba_BSDFFlags_NeedsDifferentials = R"doc(Does the implementation require access to texture-space differentials)doc";
+static const char *__doc_mitsuba_BSDFFlags_NeedsDifferentials =
+R"doc(Does the implementation require access to texture-space differentials
+(e.g. because it evaluates filtered textures that depend on the
+footprint of the incident ray, see Texture::needs_differentials()))doc";
 
 static const char *__doc_mitsuba_BSDFFlags_NonSymmetric = R"doc(Flags non-symmetry (e.g. transmission in dielectric materials))doc";
 
@@ -397,10 +402,32 @@ static const char *__doc_mitsuba_BSDFSample3_wo = R"doc(Normalized outgoing dire
 
 static const char *__doc_mitsuba_BSDF_BSDF = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_BSDF_alpha_test =
+R"doc(Decide whether a surface intersection should be treated as opaque
+
+BSDFs that set BSDFFlags::AlphaTest are queried by the kd-tree while
+it is being traversed. Intersections for which this function returns
+``False`` are skipped, and the traversal continues as if the surface
+was not there. This applies to both regular and shadow rays, and it
+avoids having to spawn a new ray for every transparent hit.
+
+The surface interaction provided to this function only contains the
+geometric information of the intersection (position, UV coordinates,
+frames, and incident direction). The default implementation returns
+``True``.)doc";
+
 static const char *__doc_mitsuba_BSDF_class = R"doc()doc";
 
 static const char *__doc_mitsuba_BSDF_component_count = R"doc(Number of components this BSDF is comprised of.)doc";
 
+static const char *__doc_mitsuba_BSDF_disable_alpha_test =
+R"doc(Resolve transparency while shading instead of during traversal
+
+The kd-tree only evaluates the alpha test of the BSDF that is attached
+to a shape. BSDFs that wrap other BSDFs (e.g. ``blendbsdf``) call this
+function on their children, which clears BSDFFlags::AlphaTest and
+makes them fall back to their regular treatment of transparency.)doc";
+
 static const char *__doc_mitsuba_BSDF_eval =
 R"doc(Evaluate the BSDF f(wi, wo) or its adjoint version f^{*}(wi, wo) and
 multiply by the cosine foreshortening term.
@@ -442,6 +469,8 @@ static const char *__doc_mitsuba_BSDF_flags = R"doc(Flags for all components com
 
 static const char *__doc_mitsuba_BSDF_flags_2 = R"doc(Flags for a specific component of this BSDF.)doc";
 
+static const char *__doc_mitsuba_BSDF_has_alpha_test = R"doc(Does the implementation resolve transparency during ray traversal?)doc";
+
 static const char *__doc_mitsuba_BSDF_id = R"doc(Return a string identifier)doc";
 
 static const char *__doc_mitsuba_BSDF_m_components = R"doc(Flags for each component of this BSDF.)doc";
@@ -798,7 +827,16 @@ component_format Specifies the desired component format
 srgb_gamma Specifies whether a sRGB gamma ramp should be applied to
 the ouutput values.)doc";
 
-static const char *__doc_mitsuba_Bitmap_convert_2 = R"doc()doc";
+static const char *__doc_mitsuba_Bitmap_convert_2 =
+R"doc(Convert the bitmap into the pixel and component format of an existing
+bitmap of the same size)doc";
+
+static const char *__doc_mitsuba_Bitmap_convert_3 =
+R"doc(Convert a rectangular region of this bitmap into a region of another
+bitmap with a potentially different pixel and component format
+
+The conversion follows the same rules as the main ``convert()``
+implementation. Out-of-bounds regions are safely ignored.)doc";
 
 static const char *__doc_mitsuba_Bitmap_data = R"doc(Return a pointer to the underlying bitmap storage)doc";
 
@@ -2131,6 +2169,36 @@ image)
 Returns:
     ``True`` upon success)doc";
 
+static const char *__doc_mitsuba_Film_develop_incremental =
+R"doc(Incrementally develop a subregion of the film
+
+Behaves like develop(offset, size, target_offset, target), except that
+films which track modified regions may skip parts that have not
+received new samples since the previous call of this function. The
+target bitmap is therefore expected to hold the result of that
+previous call, which makes this function suitable for polling live
+previews of a rendering in progress. The default implementation
+develops the entire region.
+
+Parameter ``regions``:
+    When specified, the offset and size (in the coordinates of
+    ``target``) of every rectangle that was developed is appended to
+    this list, so that callers only need to process these parts of the
+    target bitmap.
+
+Returns:
+    ``True`` upon success)doc";
+
+static const char *__doc_mitsuba_Film_developed_bitmap =
+R"doc(Return a persistent bitmap storing the developed contents of the film
+
+In contrast to bitmap(), the returned bitmap is owned by the film and
+reused by subsequent calls, which only develop regions that have
+received new samples in the meantime (see develop_incremental()).
+Views of its pixel data (e.g. NumPy arrays) hence remain valid and can
+be refreshed without allocating and converting the entire image again.
+The default implementation returns the result of bitmap().)doc";
+
 static const char *__doc_mitsuba_Film_has_high_quality_edges =
 R"doc(Should regions slightly outside the image plane be sampled to improve
 the quality of the reconstruction at the edges? This only makes sense
@@ -2156,6 +2224,15 @@ static const char *__doc_mitsuba_Film_set_crop_window = R"doc(Set the size and o
 
 static const char *__doc_mitsuba_Film_set_destination_file = R"doc(Set the target filename (with or without extension))doc";
 
+static const char *__doc_mitsuba_Film_set_pass_count =
+R"doc(Announce how many times every pixel of the crop window will be covered
+by the image blocks passed to put()
+
+Integrators that render in several passes call this function before
+prepare(). Films that write their output incrementally use it to
+determine when a region has received all of its samples. The default
+implementation does nothing.)doc";
+
 static const char *__doc_mitsuba_Film_size =
 R"doc(Ignoring the crop window, return the resolution of the underlying
 sensor)doc";
@@ -3024,6 +3101,36 @@ depend on the wavelength.
 Returns:
     This method returns a pair of (Transmittance, PDF).)doc";
 
+static const char *__doc_mitsuba_Medium_eval_transmittance =
+R"doc(Estimate the transmittance along a ray segment
+
+This function returns an unbiased estimate of the transmittance
+between ``ray.mint`` and ``ray.maxt``, which is e.g. needed to
+evaluate shadow rays towards emitters. In contrast to repeatedly
+calling sample_interaction(), no intersections with the scene are
+required, and the estimate is smooth instead of binary.
+
+The default implementation performs ratio tracking with respect to the
+medium's majorant. Subclasses can provide better estimators, e.g. the
+closed-form solution for homogeneous media.
+
+Parameter ``ray``:
+    Ray segment along which the transmittance is estimated
+
+Parameter ``sampler``:
+    Source of random numbers (not used by deterministic
+    implementations))doc";
+
+static const char *__doc_mitsuba_Medium_eval_transmittance_residual =
+R"doc(Residual ratio tracking transmittance estimator
+
+Splits the extinction into a constant control component ``control``,
+whose transmittance is evaluated in closed form, and a residual
+component that is estimated using ratio tracking with the residual
+majorant ``majorant - control``. When ``control`` is zero, this is
+standard ratio tracking. Both values must bound the medium's
+extinction from below and above, respectively.)doc";
+
 static const char *__doc_mitsuba_Medium_get_combined_extinction = R"doc(Returns the medium's majorant used for delta tracking)doc";
 
 static const char *__doc_mitsuba_Medium_get_scattering_coefficients =
@@ -3258,6 +3365,15 @@ static const char *__doc_mitsuba_Mesh_bbox_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_class = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_clear_dirty = R"doc(Clear the flag returned by dirty())doc";
+
+static const char *__doc_mitsuba_Mesh_dirty =
+R"doc(Has the geometry changed since the last call to clear_dirty()?
+
+This flag is set by parameters_changed() when the vertex positions or
+faces were modified, and it is used by the scene to determine whether
+its acceleration data structure must be updated.)doc";
+
 static const char *__doc_mitsuba_Mesh_face = R"doc(Return a pointer (or packet of pointers) to a specific face)doc";
 
 static const char *__doc_mitsuba_Mesh_face_2 =
@@ -3353,13 +3469,27 @@ static const char *__doc_mitsuba_Mesh_recompute_bbox = R"doc(Recompute the bound
 
 static const char *__doc_mitsuba_Mesh_recompute_vertex_normals = R"doc(Compute smooth vertex normals and replace the current normal values)doc";
 
+static const char *__doc_mitsuba_Mesh_release_buffers =
+R"doc(Release the flat copies of the geometry that traverse() exports in CPU
+variants
+
+The copies are otherwise kept until parameters_changed() is called.
+Callers that traversed the mesh without modifying its geometry can use
+this function to avoid keeping a second copy of it.)doc";
+
 static const char *__doc_mitsuba_Mesh_sample_position = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_surface_area = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_to_string = R"doc(Return a human-readable string representation of the shape contents.)doc";
 
-static const char *__doc_mitsuba_Mesh_traverse = R"doc()doc";
+static const char *__doc_mitsuba_Mesh_traverse =
+R"doc(Expose the parameters of the mesh
+
+On CPU variants, this creates flat copies of the face indices and
+vertex attributes (``faces_buf``, ``vertex_positions_buf``, ...). They
+are written back and released by parameters_changed(), hence the mesh
+must be traversed again to access the geometry after an update.)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex = R"doc(Return a pointer (or packet of pointers) to a specific vertex)doc";
 
@@ -3556,12 +3686,32 @@ static const char *__doc_mitsuba_MonteCarloIntegrator_MonteCarloIntegrator = R"d
 
 static const char *__doc_mitsuba_MonteCarloIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloIntegrator_init_cone =
+R"doc(Initialize the footprint of a path from the differentials of its
+first ray (see propagate_cone())
+
+Returns ``False`` and a cone of size zero when the ray does not carry
+differentials, in which case the footprint should not be tracked.)doc";
+
 static const char *__doc_mitsuba_MonteCarloIntegrator_m_hide_emitters = R"doc()doc";
 
 static const char *__doc_mitsuba_MonteCarloIntegrator_m_max_depth = R"doc()doc";
 
 static const char *__doc_mitsuba_MonteCarloIntegrator_m_rr_depth = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloIntegrator_propagate_cone =
+R"doc(Propagate the footprint of a path through a scattering event
+
+The footprint is approximated by a cone with radius ``width`` at the
+origin of the current ray, whose radius increases by ``spread`` per
+unit distance. This function moves the cone to the next vertex at
+distance ``dist`` and accounts for the direction that was sampled
+there with density ``pdf``. Delta interactions keep the spread angle
+(ignoring surface curvature), while other interactions widen the cone
+to the solid angle associated with the density, so that e.g. diffuse
+bounces access strongly filtered textures. See
+RayDifferential::set_cone().)doc";
+
 static const char *__doc_mitsuba_NamedReference = R"doc(Wrapper object used to represent named references to Object instances)doc";
 
 static const char *__doc_mitsuba_NamedReference_NamedReference = R"doc()doc";
@@ -4435,6 +4585,20 @@ static const char *__doc_mitsuba_RayDifferential_operator_assign_2 = R"doc()doc"
 
 static const char *__doc_mitsuba_RayDifferential_scale_differential = R"doc()doc";
 
+static const char *__doc_mitsuba_RayDifferential_set_cone =
+R"doc(Replace the differentials by two offset rays that approximate a cone
+around this ray
+
+This is used to track the footprint of rays that were sampled by the
+BSDF (which normally carry no differentials), e.g. for texture
+filtering.
+
+Parameter ``width``:
+    Radius of the cone at the ray origin
+
+Parameter ``spread``:
+    Increase of the radius per unit distance along the ray)doc";
+
 static const char *__doc_mitsuba_Ray_Ray = R"doc(Construct a new ray (o, d) at time 'time')doc";
 
 static const char *__doc_mitsuba_Ray_Ray_2 = R"doc(Construct a new ray (o, d) with time)doc";
@@ -4642,6 +4806,8 @@ In the context of wavefront ray tracing & dynamic arrays, this
 function must be called with a ``seed_value`` matching the size of the
 wavefront.)doc";
 
+static const char *__doc_mitsuba_Sampler_set_sample_count = R"doc(Set the number of samples per pixel)doc";
+
 static const char *__doc_mitsuba_Sampler_wavefront_size = R"doc(Return the size of the wavefront (or 0, if not seeded))doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator =
@@ -4667,8 +4833,12 @@ static const char *__doc_mitsuba_SamplingIntegrator_cancel = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_coordinator_socket = R"doc(Return the socket used to communicate with remote workers (if any))doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_block_size = R"doc(Size of (square) image blocks to render per core.)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_m_coordinator_socket = R"doc(Socket on which remote workers connect during render() (optional))doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_render_timer = R"doc(Timer used to enforce the timeout.)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_m_samples_per_pass =
@@ -4690,6 +4860,19 @@ static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_render_worker =
+R"doc(Render image blocks on behalf of a remote coordinator
+
+Opens ``connections`` connections to the process running render() at
+the given host and port (one per local thread when ``connections`` is
+zero). Each of them repeatedly receives the description of a block,
+renders it and sends the resulting pixel data back, until the
+coordinator has no blocks left. The scene and sensor must match those
+used by the coordinator.
+
+Returns:
+    ``True`` upon success)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_sample =
 R"doc(Sample the incident radiance along a ray.
 
@@ -4726,6 +4909,16 @@ Remark:
     argument as an additional return value. In other words: `` (spec,
     mask, aov) = integrator.sample(scene, sampler, ray, active) ``)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_set_coordinator_socket =
+R"doc(Additionally distribute image blocks to remote worker processes
+
+When a socket is specified, render() accepts connections from workers
+(see render_worker()) while it runs. Workers and local threads then
+pull blocks from the same queue, and the blocks rendered by the
+workers are merged into the film of this process. Blocks of workers
+that disconnect prematurely are rendered again. Pass ``nullptr`` to
+render locally only.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_should_stop =
 R"doc(Indicates whether cancel() or a timeout have occured. Should be
 checked regularly in the integrator's main loop so that timeouts are
@@ -4999,6 +5192,39 @@ static const char *__doc_mitsuba_Sensor_shutter_open_time = R"doc(Return the len
 
 static const char *__doc_mitsuba_Sensor_traverse = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_ServerSocket =
+R"doc(Listens for incoming TCP connections on a given port.
+
+Each accepted connection is returned as a SocketStream.)doc";
+
+static const char *__doc_mitsuba_ServerSocket_ServerSocket =
+R"doc(Listen on the given port of all network interfaces.
+
+When ``port`` is zero, the operating system picks an unused port,
+which can be queried using port().)doc";
+
+static const char *__doc_mitsuba_ServerSocket_accept =
+R"doc(Wait for an incoming connection
+
+Parameter ``timeout``:
+    Maximum time to wait (in milliseconds). A negative value waits
+    indefinitely.
+
+Returns:
+    The new connection, or ``nullptr`` upon a timeout)doc";
+
+static const char *__doc_mitsuba_ServerSocket_class = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_close = R"doc(Stop listening for connections. This function is idempotent.)doc";
+
+static const char *__doc_mitsuba_ServerSocket_m_port = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_m_socket = R"doc()doc";
+
+static const char *__doc_mitsuba_ServerSocket_port = R"doc(Return the port on which the socket listens for connections)doc";
+
+static const char *__doc_mitsuba_ServerSocket_to_string = R"doc(Returns a string representation)doc";
+
 static const char *__doc_mitsuba_Shape =
 R"doc(Base class of all geometric shapes in Mitsuba
 
@@ -5315,6 +5541,73 @@ The default implementation throws an exception.)doc";
 
 static const char *__doc_mitsuba_Shape_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_SocketStream =
+R"doc(Stream implementation backed by a TCP connection.
+
+Data is exchanged without any kind of buffering, hence flush() is a
+no-op. Seeking and truncation are not supported, and tell() and size()
+respectively return the number of bytes that have been read from and
+written to the connection so far.
+
+See also:
+    ServerSocket)doc";
+
+static const char *__doc_mitsuba_SocketStream_SocketStream =
+R"doc(Connects to the TCP server at the given host name and port.
+
+Throws an exception if the connection cannot be established.)doc";
+
+static const char *__doc_mitsuba_SocketStream_SocketStream_2 = R"doc(Wrap an already connected socket (used by ServerSocket::accept()))doc";
+
+static const char *__doc_mitsuba_SocketStream_can_read = R"doc(True except if the connection was closed.)doc";
+
+static const char *__doc_mitsuba_SocketStream_can_write = R"doc(True except if the connection was closed.)doc";
+
+static const char *__doc_mitsuba_SocketStream_class = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_close =
+R"doc(Closes the connection. No further read or write operations are
+permitted.
+
+This function is idempotent. It is called automatically by the
+destructor.)doc";
+
+static const char *__doc_mitsuba_SocketStream_flush = R"doc(No-op, data is never buffered)doc";
+
+static const char *__doc_mitsuba_SocketStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_SocketStream_m_peer = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_received = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_sent = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_m_socket = R"doc()doc";
+
+static const char *__doc_mitsuba_SocketStream_peer = R"doc(Return a description of the remote end of the connection)doc";
+
+static const char *__doc_mitsuba_SocketStream_read =
+R"doc(Reads a specified amount of data from the connection. Throws an
+exception when the connection was closed prematurely.)doc";
+
+static const char *__doc_mitsuba_SocketStream_received = R"doc(Return the number of bytes that have been received so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_seek = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_SocketStream_sent = R"doc(Return the number of bytes that have been sent so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_size = R"doc(Returns the number of bytes that have been sent so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_tell = R"doc(Returns the number of bytes that have been received so far)doc";
+
+static const char *__doc_mitsuba_SocketStream_to_string = R"doc(Returns a string representation)doc";
+
+static const char *__doc_mitsuba_SocketStream_truncate = R"doc(Unsupported. Always throws.)doc";
+
+static const char *__doc_mitsuba_SocketStream_write =
+R"doc(Writes a specified amount of data to the connection. Throws an
+exception when the connection was closed.)doc";
+
 static const char *__doc_mitsuba_Spectrum =
 R"doc(//! @{ \name Data types for spectral quantities with sampled
 wavelengths)doc";
@@ -5393,6 +5686,67 @@ static const char *__doc_mitsuba_Spiral_set_passes =
 R"doc(Sets the number of time the spiral should automatically reset. Not
 affected by a call to reset.)doc";
 
+static const char *__doc_mitsuba_Statistics =
+R"doc(Statistics subsystem
+
+Every thread increments its own set of counters (see StatsData), which
+avoids contention on shared cache lines in the rendering hot paths.
+The per-thread values are merged on demand by Statistics::data(),
+which is done by the integrators once rendering has finished. The
+counters can be disabled at compile time by turning off the
+``MTS_ENABLE_STATISTICS`` CMake option, in which case all increments
+turn into no-ops.)doc";
+
+static const char *__doc_mitsuba_Statistics_Statistics = R"doc()doc";
+
+static const char *__doc_mitsuba_Statistics_add = R"doc(Increment a counter of the calling thread)doc";
+
+static const char *__doc_mitsuba_Statistics_add_path_length = R"doc(Record ``amount`` paths that were terminated after ``depth`` bounces)doc";
+
+static const char *__doc_mitsuba_Statistics_class = R"doc()doc";
+
+static const char *__doc_mitsuba_Statistics_data = R"doc(Merge the counters of all threads and return the result)doc";
+
+static const char *__doc_mitsuba_Statistics_reset = R"doc(Reset the counters of all threads)doc";
+
+static const char *__doc_mitsuba_Statistics_summary =
+R"doc(Return a human-readable summary of the current counters
+
+Parameter ``render_time``:
+    Elapsed render time in seconds. When positive, ray throughput
+    (rays/sec) is also included in the summary.)doc";
+
+static const char *__doc_mitsuba_StatsCounter = R"doc(List of event counters that are tracked by the statistics subsystem)doc";
+
+static const char *__doc_mitsuba_StatsCounter_InvalidSamples = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_KDNodesVisited = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_KDPrimitivesVisited = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_PathSplits = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_RaysTraced = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_RussianRouletteTerminations = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_ShadowRaysTraced = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsCounter_StatsCounterCount = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsData = R"doc(Storage for the counters of a single thread (or the merged result))doc";
+
+static const char *__doc_mitsuba_StatsData_counters = R"doc()doc";
+
+static const char *__doc_mitsuba_StatsData_operator_array = R"doc(Return the value of a specific counter)doc";
+
+static const char *__doc_mitsuba_StatsData_operator_iadd = R"doc(Accumulate the counters of another instance into this one)doc";
+
+static const char *__doc_mitsuba_StatsData_path_length =
+R"doc(Histogram of path lengths. Entry ``i`` counts paths that were
+terminated after ``i`` bounces, the last entry also accumulates all
+longer paths.)doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -5904,6 +6258,13 @@ static const char *__doc_mitsuba_SurfaceInteraction_emitter =
 R"doc(Return the emitter associated with the intersection (if any) \note
 Defined in scene.h)doc";
 
+static const char *__doc_mitsuba_SurfaceInteraction_footprint =
+R"doc(Return the extent of the ray footprint in UV space
+
+This is the larger of the lengths of the UV partials, which textures
+can use to select a suitably filtered (e.g. coarser) representation.
+The result is zero when no partials were computed.)doc";
+
 static const char *__doc_mitsuba_SurfaceInteraction_has_uv_partials = R"doc()doc";
 
 static const char *__doc_mitsuba_SurfaceInteraction_instance = R"doc(Stores a pointer to the parent instance (if applicable))doc";
@@ -6388,6 +6749,17 @@ static const char *__doc_mitsuba_TShapeKDTree_class = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_clip_primitives = R"doc(Return whether primitive clipping is used during tree construction)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_compact = R"doc(Return whether the memory-optimized representation is used)doc";
+
+static const char *__doc_mitsuba_TShapeKDTree_compact_indices =
+R"doc(Convert the index list into the compact representation (see
+set_compact())
+
+The primitive offsets of the leaves in ``m_nodes`` refer to the
+(uncompressed) index list ``source``. Single-primitive leaves store
+their primitive index directly, and the remaining lists are packed
+into a new ``m_indices`` array.)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_compute_statistics = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_cost_model = R"doc(Return the cost model used by the tree construction algorithm)doc";
@@ -6401,6 +6773,12 @@ R"doc(Return the number of primitives, at which the builder will switch from
 (approximate) Min-Max binning to the accurate O(n log n) optimization
 method.)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_leaf_primitive =
+R"doc(Return the ``i``-th primitive referenced by a leaf node
+
+In compact mode, the index of the primitive referenced by a
+single-primitive leaf is stored within the node itself.)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_log_level = R"doc(Return the log level of kd-tree status messages)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_m_bbox = R"doc()doc";
@@ -6439,12 +6817,27 @@ static const char *__doc_mitsuba_TShapeKDTree_max_depth = R"doc(Return the maxim
 
 static const char *__doc_mitsuba_TShapeKDTree_min_max_bins = R"doc(Return the number of bins used for Min-Max binning)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_peak_build_memory =
+R"doc(Return an upper bound of the memory (in bytes) that was needed while
+the tree was built)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_ready = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_retract_bad_splits = R"doc(Return whether or not bad splits can be "retracted".)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_set_clip_primitives = R"doc(Set whether primitive clipping is used during tree construction)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_set_compact =
+R"doc(Specify whether the memory-optimized representation should be used
+(must be called before build())
+
+In this mode, leaves referencing a single primitive store its index
+within the node instead of the index list, and the O(n log n) builder
+only keeps per-thread bookkeeping for the primitives of the subtree it
+is currently working on. This reduces the peak memory usage of the
+build on scenes with very many primitives, at the cost of a slightly
+more expensive leaf lookup during traversal.)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_set_exact_primitive_threshold =
 R"doc(Specify the number of primitives, at which the builder will switch
 from (approximate) Min-Max binning to the accurate O(n log n)
@@ -6575,6 +6968,13 @@ default implementation throws an exception.
 Even if the operation is provided, it may only return an
 approximation.)doc";
 
+static const char *__doc_mitsuba_Texture_needs_differentials =
+R"doc(Does the texture filter its lookups based on the ray footprint?
+
+Such textures rely on the UV partials of the surface interaction (see
+SurfaceInteraction::footprint()), hence BSDFs using them should
+request differentials via BSDFFlags::NeedsDifferentials.)doc";
+
 static const char *__doc_mitsuba_Texture_pdf =
 R"doc(Evaluate the density function of the sample() method as a probability
 per unit wavelength (in units of 1/nm).
@@ -6822,6 +7222,57 @@ static const char *__doc_mitsuba_Thread_unregister_external_thread = R"doc(Unreg
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TiledEXRWriter =
+R"doc(Incrementally writes a tiled OpenEXR file
+
+This makes it possible to store images that are too large to be held
+in memory as a whole. The file is created by the constructor, after
+which the tiles can be written in arbitrary order (and from several
+threads) using write_tile(). The file is complete once every tile has
+been written and the writer was closed.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_TiledEXRWriter =
+R"doc(Create a tiled OpenEXR file
+
+Parameter ``filename``:
+    Path of the output file
+
+Parameter ``layout``:
+    Bitmap, whose pixel format, component format, channel names and
+    metadata are used for the file (its size is irrelevant)
+
+Parameter ``size``:
+    Resolution of the complete image
+
+Parameter ``tile_size``:
+    Edge length of the (square) tiles)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_TiledEXRWriterPrivate = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_close = R"doc(Finish writing the file. This function is idempotent.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_d = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_tile_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_size = R"doc(Return the resolution of the complete image)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tile_size = R"doc(Return the edge length of the tiles)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_to_string = R"doc(Return a human-readable summary of this writer)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_write_tile =
+R"doc(Write a tile of the image
+
+The offset must be a multiple of the tile size, and the bitmap must
+have the layout that was specified to the constructor. Its size must
+match the tile size, except for tiles at the right and bottom edges of
+the image.)doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -7067,6 +7518,13 @@ static const char *__doc_mitsuba_Volume_m_world_to_local = R"doc(Used to bring p
 
 static const char *__doc_mitsuba_Volume_max = R"doc(Returns the maximum value of the texture over all dimensions.)doc";
 
+static const char *__doc_mitsuba_Volume_min =
+R"doc(Returns a lower bound on the values of the texture over all
+dimensions.
+
+The default implementation returns zero, which is a valid bound for
+all non-negative textures.)doc";
+
 static const char *__doc_mitsuba_Volume_resolution = R"doc(Returns the resolution of the texture, defaults to "1")doc";
 
 static const char *__doc_mitsuba_Volume_to_string = R"doc(Returns a human-reable summary)doc";
@@ -89,9 +89,16 @@ enum class BSDFFlags : uint32_t {
     /// Supports interactions on the back-facing side
     BackSide             = 0x10000,
 
-    /// Does the implementation require access to texture-space differentials
+    /**
+     * Does the implementation require access to texture-space differentials
+     * (e.g. because it evaluates filtered textures that depend on the
+     * footprint of the incident ray, see \ref Texture::needs_differentials())
+     */
     NeedsDifferentials   = 0x20000,
 
+    /// Transparency is resolved during ray traversal (see \ref BSDF::alpha_test())
+    AlphaTest            = 0x40000,
+
     // =============================================================
     //!                 Compound lobe attributes
     // =============================================================
@@ -408,6 +415,23 @@ public:
     virtual Spectrum eval_null_transmission(const SurfaceInteraction3f &si,
                              Mask active = true) const;
 
+    /**
+     * \brief Decide whether a surface intersection should be treated as opaque
+     *
+     * BSDFs that set \ref BSDFFlags::AlphaTest are queried by the kd-tree
+     * while it is being traversed. Intersections for which this function
+     * returns \c false are skipped, and the traversal continues as if the
+     * surface was not there. This applies to both regular and shadow rays,
+     * and it avoids having to spawn a new ray for every transparent hit.
+     *
+     * The surface interaction provided to this function only contains the
+     * geometric information of the intersection (position, UV coordinates,
+     * frames, and incident direction). The default implementation returns
+     * \c true.
+     */
+    virtual Mask alpha_test(const SurfaceInteraction3f &si,
+                            Mask active = true) const;
+
     // -----------------------------------------------------------------------
     //! @{ \name BSDF property accessors (components, flags, etc)
     // -----------------------------------------------------------------------
@@ -426,6 +450,21 @@ public:
         return has_flag(m_flags, BSDFFlags::NeedsDifferentials);
     }
 
+    /// Does the implementation resolve transparency during ray traversal?
+    bool has_alpha_test(Mask /*active*/ = true) const {
+        return has_flag(m_flags, BSDFFlags::AlphaTest);
+    }
+
+    /**
+     * \brief Resolve transparency while shading instead of during traversal
+     *
+     * The kd-tree only evaluates the alpha test of the BSDF that is attached
+     * to a shape. BSDFs that wrap other BSDFs (e.g. \c blendbsdf) call this
+     * function on their children, which clears \ref BSDFFlags::AlphaTest
+     * and makes them fall back to their regular treatment of transparency.
+     */
+    void disable_alpha_test() { m_flags = m_flags & ~BSDFFlags::AlphaTest; }
+
     /// Number of components this BSDF is comprised of.
     size_t component_count(Mask /*active*/ = true) const {
         return m_components.size();
@@ -219,6 +219,14 @@ public:
     /// Return a string identifier
     std::string id() const override;
 
+    /**
+     * \brief Expose the local space to world space transformation as the
+     * parameter \c to_world (only if it is not animated)
+     */
+    void traverse(TraversalCallback *callback) override;
+
+    void parameters_changed() override;
+
     //! @}
     // =============================================================
 
@@ -232,6 +240,8 @@ protected:
 
 protected:
     ref<const AnimatedTransform> m_world_transform;
+    /// Editable copy of a non-animated \ref m_world_transform, see \ref traverse()
+    ScalarTransform4f m_to_world;
     ref<Medium> m_medium;
     Shape *m_shape = nullptr;
     bool m_needs_sample_2 = true;
@@ -28,6 +28,17 @@ public:
     /// Merge an image block into the film
     virtual void put(const ImageBlock *block) = 0;
 
+    /**
+     * \brief Announce how many times every pixel of the crop window will be
+     * covered by the image blocks passed to \ref put()
+     *
+     * Integrators that render in several passes call this function before
+     * \ref prepare(). Films that write their output incrementally use it to
+     * determine when a region has received all of its samples. The default
+     * implementation does nothing.
+     */
+    virtual void set_pass_count(size_t /* pass_count */) { }
+
     /// Develop the film and write the result to the previously specified filename
     virtual void develop() = 0;
 
@@ -46,9 +57,54 @@ public:
         const ScalarPoint2i  &target_offset,
         Bitmap *target) const = 0;
 
+    /**
+     * \brief Incrementally develop a subregion of the film
+     *
+     * Behaves like \ref develop(offset, size, target_offset, target), except
+     * that films which track modified regions may skip parts that have not
+     * received new samples since the previous call of this function. The
+     * target bitmap is therefore expected to hold the result of that previous
+     * call, which makes this function suitable for polling live previews of
+     * a rendering in progress. The default implementation develops the
+     * entire region.
+     *
+     * \param regions
+     *    When specified, the offset and size (in the coordinates of \c
+     *    target) of every rectangle that was developed is appended to this
+     *    list, so that callers only need to process these parts of the
+     *    target bitmap.
+     *
+     * \return \c true upon success
+     */
+    virtual bool develop_incremental(
+        const ScalarPoint2i  &offset,
+        const ScalarVector2i &size,
+        const ScalarPoint2i  &target_offset,
+        Bitmap *target,
+        std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> *regions = nullptr) const {
+        if (!develop(offset, size, target_offset, target))
+            return false;
+        if (regions)
+            regions->emplace_back(target_offset, size);
+        return true;
+    }
+
     /// Return a bitmap object storing the developed contents of the film
     virtual ref<Bitmap> bitmap(bool raw = false) = 0;
 
+    /**
+     * \brief Return a persistent bitmap storing the developed contents of the
+     * film
+     *
+     * In contrast to \ref bitmap(), the returned bitmap is owned by the film
+     * and reused by subsequent calls, which only develop regions that have
+     * received new samples in the meantime (see \ref develop_incremental()).
+     * Views of its pixel data (e.g. NumPy arrays) hence remain valid and can
+     * be refreshed without allocating and converting the entire image again.
+     * The default implementation returns the result of \ref bitmap().
+     */
+    virtual ref<Bitmap> developed_bitmap() { return bitmap(false); }
+
     /// Set the target filename (with or without extension)
     virtual void set_destination_file(const fs::path &filename) = 0;
 
@@ -4,6 +4,7 @@
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/sstream.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/vector.h>
@@ -142,6 +143,43 @@ public:
     //! @}
     // =========================================================================
 
+    // =========================================================================
+    //! @{ \name Distributed rendering
+    // =========================================================================
+
+    /**
+     * \brief Additionally distribute image blocks to remote worker processes
+     *
+     * When a socket is specified, \ref render() accepts connections from
+     * workers (see \ref render_worker()) while it runs. Workers and local
+     * threads then pull blocks from the same queue, and the blocks rendered
+     * by the workers are merged into the film of this process. Blocks of
+     * workers that disconnect prematurely are rendered again. Pass \c
+     * nullptr to render locally only.
+     */
+    void set_coordinator_socket(ServerSocket *socket) { m_coordinator_socket = socket; }
+
+    /// Return the socket used to communicate with remote workers (if any)
+    ServerSocket *coordinator_socket() const { return m_coordinator_socket.get(); }
+
+    /**
+     * \brief Render image blocks on behalf of a remote coordinator
+     *
+     * Opens \c connections connections to the process running \ref render()
+     * at the given host and port (one per local thread when \c connections
+     * is zero). Each of them repeatedly receives the description of a block,
+     * renders it and sends the resulting pixel data back, until the
+     * coordinator has no blocks left. The scene and sensor must match those
+     * used by the coordinator.
+     *
+     * \return \c true upon success
+     */
+    bool render_worker(Scene *scene, Sensor *sensor, const std::string &host,
+                       uint16_t port, size_t connections = 0);
+
+    //! @}
+    // =========================================================================
+
     MTS_DECLARE_CLASS()
 protected:
     SamplingIntegrator(const Properties &props);
@@ -163,6 +201,29 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /**
+     * \brief Generate the camera ray of a sample at the given pixel position
+     *
+     * \return A tuple containing the ray, its importance weight and the
+     *    position of the sample on the film
+     */
+    std::tuple<RayDifferential3f, Spectrum, Vector2f>
+    sample_sensor_ray(const Sensor *sensor, Sampler *sampler,
+                      const Vector2f &pos, ScalarFloat diff_scale_factor,
+                      Mask active = true) const;
+
+    /**
+     * \brief Convert the (weighted) radiance estimate of a sample to XYZ and
+     * accumulate it into the image block
+     *
+     * \param valid
+     *    Specifies whether a surface or medium interaction was sampled (see
+     *    \ref sample()); used for the alpha channel.
+     */
+    void put_sample(ImageBlock *block, const Vector2f &position_sample,
+                    const Wavelength &wavelengths, const Spectrum &value,
+                    const Mask &valid, Float *aovs, Mask active = true) const;
+
 protected:
     /// Integrators should stop all work when this flag is set to true.
     bool m_stop;
@@ -187,6 +248,9 @@ protected:
 
     /// Timer used to enforce the timeout.
     Timer m_render_timer;
+
+    /// Socket on which remote workers connect during \ref render() (optional)
+    ref<ServerSocket> m_coordinator_socket;
 };
 
 /*
@@ -198,6 +262,7 @@ template <typename Float, typename Spectrum>
 class MTS_EXPORT_RENDER MonteCarloIntegrator : public SamplingIntegrator<Float, Spectrum> {
 public:
     MTS_IMPORT_BASE(SamplingIntegrator)
+    MTS_IMPORT_TYPES()
 
 protected:
     /// Create an integrator
@@ -206,6 +271,42 @@ protected:
     /// Virtual destructor
     virtual ~MonteCarloIntegrator();
 
+    /**
+     * \brief Initialize the footprint of a path from the differentials of its
+     * first ray (see \ref propagate_cone())
+     *
+     * Returns \c false and a cone of size zero when the ray does not carry
+     * differentials, in which case the footprint should not be tracked.
+     */
+    bool init_cone(const RayDifferential3f &ray, Float &width, Float &spread) const {
+        width = spread = 0.f;
+        if (!ray.has_differentials)
+            return false;
+        width  = max(norm(ray.o_x - ray.o), norm(ray.o_y - ray.o));
+        spread = max(norm(ray.d_x - ray.d), norm(ray.d_y - ray.d));
+        return true;
+    }
+
+    /**
+     * \brief Propagate the footprint of a path through a scattering event
+     *
+     * The footprint is approximated by a cone with radius \c width at the
+     * origin of the current ray, whose radius increases by \c spread per
+     * unit distance. This function moves the cone to the next vertex at
+     * distance \c dist and accounts for the direction that was sampled there
+     * with density \c pdf. Delta interactions keep the spread angle (ignoring
+     * surface curvature), while other interactions widen the cone to the
+     * solid angle associated with the density, so that e.g. diffuse bounces
+     * access strongly filtered textures. See \ref RayDifferential::set_cone().
+     */
+    void propagate_cone(Float &width, Float &spread, const Float &dist,
+                        const Float &pdf, const Mask &delta,
+                        const Mask &active = true) const {
+        masked(width, active) = fmadd(spread, dist, width);
+        masked(spread, active && !delta && pdf > 0.f) =
+            max(spread, rsqrt(math::Pi<Float> * pdf));
+    }
+
     MTS_DECLARE_CLASS()
 protected:
     int m_max_depth;
@@ -337,6 +337,17 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
         return any_nested(neq(duv_dx, 0.f) || neq(duv_dy, 0.f));
     }
 
+    /**
+     * \brief Return the extent of the ray footprint in UV space
+     *
+     * This is the larger of the lengths of the UV partials, which textures
+     * can use to select a suitably filtered (e.g. coarser) representation.
+     * The result is zero when no partials were computed.
+     */
+    Float footprint() const {
+        return max(norm(duv_dx), norm(duv_dy));
+    }
+
     //! @}
     // =============================================================
 
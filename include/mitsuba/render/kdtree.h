@@ -7,10 +7,12 @@
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/ray.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/tls.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
+#include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/shape.h>
@@ -23,9 +25,18 @@
 /// OrderedChunkAllocator: don't create chunks smaller than 5MiB
 #define MTS_KD_MIN_ALLOC 5*1024u*1024u
 
+/// OrderedChunkAllocator: minimum chunk size of memory-optimized builds (512KiB)
+#define MTS_KD_MIN_ALLOC_COMPACT 512*1024u
+
 /// Grain size for TBB parallelization
 #define MTS_KD_GRAIN_SIZE 10240u
 
+/// O(N log N) builder: minimum number of primitives per side to recurse in parallel
+#define MTS_KD_NLOGN_GRAIN_SIZE 4096u
+
+/// Maximum number of triangles tested at once by the leaf kernel of scalar variants
+#define MTS_KD_LEAF_PACKET_SIZE 8
+
 /**
  * Temporary scratch space that is used to cache intersection information
  * (# of floats)
@@ -183,6 +194,28 @@ public:
         m_exact_prim_threshold = value;
     }
 
+    /// Return whether the memory-optimized representation is used
+    bool compact() const { return m_compact; }
+
+    /**
+     * \brief Specify whether the memory-optimized representation should be
+     * used (must be called before \ref build())
+     *
+     * In this mode, leaves referencing a single primitive store its index
+     * within the node instead of the index list, and the O(n log n) builder
+     * only keeps per-thread bookkeeping for the primitives of the subtree it
+     * is currently working on. This reduces the peak memory usage of the
+     * build on scenes with very many primitives, at the cost of a slightly
+     * more expensive leaf lookup during traversal.
+     */
+    void set_compact(bool value) { m_compact = value; }
+
+    /**
+     * \brief Return an upper bound of the memory (in bytes) that was needed
+     * while the tree was built
+     */
+    size_t peak_build_memory() const { return m_peak_build_memory; }
+
     /// Return the log level of kd-tree status messages
     LogLevel log_level() const { return m_log_level; }
 
@@ -330,6 +363,18 @@ protected:
     static_assert(sizeof(KDNode) == sizeof(Size) + sizeof(Scalar),
                   "kd-tree node has unexpected size. Padding issue?");
 
+    /**
+     * \brief Return the <tt>i</tt>-th primitive referenced by a leaf node
+     *
+     * In compact mode, the index of the primitive referenced by a
+     * single-primitive leaf is stored within the node itself.
+     */
+    MTS_INLINE Index leaf_primitive(const KDNode *node, Index i) const {
+        if (m_compact && node->primitive_count() == 1)
+            return node->primitive_offset();
+        return m_indices[node->primitive_offset() + i];
+    }
+
 protected:
     /// Enumeration representing the state of a classified primitive in the O(N log N) builder
     enum class PrimClassification : uint8_t {
@@ -374,6 +419,9 @@ protected:
             return PrimClassification((*ptr >> shift) & 3);
         }
 
+        /// Return the number of entries
+        Size count() const { return m_count; }
+
         /// Return the size (in bytes)
         size_t size() const { return (m_count + 3) / 4; }
 
@@ -382,6 +430,8 @@ protected:
         Size m_count = 0;
     };
 
+    struct BuildContext;
+
     /**
      * During kd-tree construction, large amounts of memory are required to
      * temporarily hold index and edge event lists. When not implemented
@@ -405,6 +455,15 @@ protected:
             m_chunks.clear();
         }
 
+        /**
+         * \brief Set the minimum size of new chunks and the build context that
+         * is notified about their allocation (see \ref BuildContext::track_alloc())
+         */
+        void configure(size_t min_allocation, BuildContext *ctx) {
+            m_min_allocation = min_allocation;
+            m_ctx = ctx;
+        }
+
         /**
          * \brief Request a block of memory from the allocator
          *
@@ -428,6 +487,8 @@ protected:
             std::unique_ptr<uint8_t[]> data(new uint8_t[alloc_size]);
             uint8_t *start = data.get(), *cur = start + size;
             m_chunks.emplace_back(std::move(data), cur, alloc_size);
+            if (m_ctx)
+                m_ctx->track_alloc(alloc_size);
 
             return reinterpret_cast<T *>(start);
         }
@@ -529,14 +590,13 @@ protected:
 
         size_t m_min_allocation;
         std::vector<Chunk> m_chunks;
+        BuildContext *m_ctx = nullptr;
     };
 
     /* ==================================================================== */
     /*                    Build-related data structures                     */
     /* ==================================================================== */
 
-    struct BuildContext;
-
     /// Helper data structure used during tree construction (used by a single thread)
     struct LocalBuildContext {
         ClassificationStorage classification_storage;
@@ -567,15 +627,29 @@ protected:
         std::atomic<size_t> pruned {0};
         std::atomic<size_t> temp_storage {0};
         std::atomic<size_t> work_units {0};
+        std::atomic<size_t> memory_usage {0};
+        std::atomic<size_t> memory_peak {0};
         double exp_traversal_steps = 0;
         double exp_leaves_visited = 0;
         double exp_primitives_queried = 0;
         Size max_prims_in_leaf = 0;
         Size nonempty_leaf_count = 0;
+        Size prim_refs = 0;
         Size max_depth = 0;
         Size prim_buckets[16] { };
 
         BuildContext(const Derived &derived) : derived(derived) { }
+
+        /// Account for a temporary allocation (in bytes) and update the peak usage
+        void track_alloc(size_t size) {
+            size_t usage = memory_usage += size,
+                   peak  = memory_peak.load();
+            while (usage > peak && !memory_peak.compare_exchange_weak(peak, usage))
+                ;
+        }
+
+        /// Account for the release of a temporary allocation (in bytes)
+        void track_free(size_t size) { memory_usage -= size; }
     };
 
     /// Data type for split candidates suggested by the tree cost model
@@ -950,9 +1024,10 @@ protected:
      *
      * At the top of the tree, it uses min-max-binning and parallel reductions
      * to create sufficient parallelism. When the number of elements is
-     * sufficiently small, it switches to a more accurate O(N log N) builder
-     * which uses normal recursion on the stack (i.e. it does not spawn further
-     * parallel pieces of work).
+     * sufficiently small, it switches to a more accurate O(N log N) builder.
+     * The upper levels of the latter sort edge events, sweep the three axes
+     * and build both subtrees in parallel; below \ref MTS_KD_NLOGN_GRAIN_SIZE
+     * primitives per side, it uses normal recursion on the stack.
      */
     class BuildTask : public tbb::task {
     public:
@@ -962,9 +1037,6 @@ protected:
         /// Context with build-specific variables (shared by all threads/tasks)
         BuildContext &m_ctx;
 
-        /// Local context with thread local variables
-        LocalBuildContext *m_local = nullptr;
-
         /// Node to be initialized by this task
         NodeIterator m_node;
 
@@ -994,6 +1066,160 @@ protected:
               m_bbox(bbox), m_tight_bbox(tight_bbox), m_depth(depth),
               m_bad_refines(bad_refines), m_cost(cost) {
             Assert(m_bbox.contains(tight_bbox));
+            m_ctx.track_alloc(m_indices.size() * sizeof(Index));
+        }
+
+        /// Release the index list of this task
+        void release_indices() {
+            m_ctx.track_free(m_indices.size() * sizeof(Index));
+            IndexVector().swap(m_indices);
+        }
+
+        /**
+         * \brief Map the primitive index of an edge event to the global one
+         *
+         * In compact mode, the events of the O(n log n) builder refer to the
+         * index list of the task, which keeps the size of the per-thread
+         * classification storage proportional to the size of the subtree.
+         */
+        Index global_index(Index index) const {
+            return m_ctx.derived.compact() ? m_indices[index] : index;
+        }
+
+        /// Specifies who owns the edge event list passed to \ref build_nlogn()
+        enum class EventOwner {
+            /// Owned by the left allocator of the calling thread (reused in place)
+            Left,
+
+            /// Owned by the right allocator of the calling thread (reused in place)
+            Right,
+
+            /// Owned by another thread (read-only, both sides are allocated anew)
+            External
+        };
+
+        /**
+         * \brief Return the thread local build context of the calling thread
+         *
+         * Configures the chunk allocators upon first use and grows the
+         * classification storage so that it can be indexed by the edge events
+         * of this task.
+         */
+        LocalBuildContext &local_context() {
+            const Derived &derived = m_ctx.derived;
+            bool compact = derived.compact();
+            LocalBuildContext &local = (LocalBuildContext &) m_ctx.local;
+
+            if (!local.ctx) {
+                local.ctx = &m_ctx;
+                local.left_alloc.configure(
+                    compact ? MTS_KD_MIN_ALLOC_COMPACT : MTS_KD_MIN_ALLOC, &m_ctx);
+                local.right_alloc.configure(
+                    compact ? MTS_KD_MIN_ALLOC_COMPACT : MTS_KD_MIN_ALLOC, &m_ctx);
+            }
+
+            /* The classification storage only grows in compact mode */
+            auto &classification = local.classification_storage;
+            size_t classification_size = classification.size();
+            if (!compact)
+                classification.resize(derived.primitive_count());
+            else if (classification.count() < m_indices.size())
+                classification.resize(Size(m_indices.size()));
+            if (classification.size() > classification_size)
+                m_ctx.track_alloc(classification.size() - classification_size);
+
+            return local;
+        }
+
+        /**
+         * \brief Sweep over the sorted edge events of a single axis and
+         * return the best split candidate along it
+         */
+        SplitCandidate sweep(const CostModel &model, const BoundingBox &bbox,
+                             Size prim_count, const EdgeEvent *events_start,
+                             const EdgeEvent *events_end) const {
+            const Derived &derived = m_ctx.derived;
+            SplitCandidate best;
+
+            /* Initially, the split plane is placed left of the scene
+               and thus all geometry is on its right side */
+            Size left_count = 0, right_count = prim_count;
+
+            for (auto event = events_start; event != events_end; ) {
+                /* Record the current position and count the number
+                   and type of remaining events that are also here. */
+                Size num_start = 0, num_end = 0, num_planar = 0;
+                int axis = event->axis;
+                Scalar pos = event->pos;
+
+                while (event < events_end && event->pos == pos) {
+                    switch (event->type) {
+                        case EdgeEvent::Type::EdgeStart:  ++num_start;  break;
+                        case EdgeEvent::Type::EdgePlanar: ++num_planar; break;
+                        case EdgeEvent::Type::EdgeEnd:    ++num_end;    break;
+                    }
+                    ++event;
+                }
+
+                /* The split plane can now be moved onto 't'. Accordingly, all planar
+                   and ending primitives are removed from the right side */
+                right_count -= num_planar + num_end;
+
+                /* Check if the edge event is out of bounds -- when primitive
+                   clipping is active, this should never happen! */
+                Assert(!(derived.clip_primitives() &&
+                         (pos < bbox.min[axis] || pos > bbox.max[axis])));
+
+                /* Calculate a score using the tree construction heuristic */
+                if (likely(pos > bbox.min[axis] && pos < bbox.max[axis])) {
+                    Size num_left = left_count + num_planar,
+                         num_right = right_count;
+
+                    Scalar cost = model.inner_cost(
+                        axis, pos, model.leaf_cost(num_left),
+                        model.leaf_cost(num_right));
+
+                    if (cost < best.cost) {
+                        best.cost = cost;
+                        best.split = pos;
+                        best.axis = axis;
+                        best.left_count = num_left;
+                        best.right_count = num_right;
+                        best.planar_left = true;
+                    }
+
+                    if (num_planar != 0) {
+                        /* There are planar events here -- also consider
+                           placing them on the right side */
+                        num_left = left_count;
+                        num_right = right_count + num_planar;
+
+                        cost = model.inner_cost(
+                            axis, pos, model.leaf_cost(num_left),
+                            model.leaf_cost(num_right));
+
+                        if (cost < best.cost) {
+                            best.cost = cost;
+                            best.split = pos;
+                            best.axis = axis;
+                            best.left_count = num_left;
+                            best.right_count = num_right;
+                            best.planar_left = false;
+                        }
+                    }
+                }
+
+                /* The split plane is moved past 't'. All prims,
+                    which were planar on 't', are moved to the left
+                    side. Also, starting prims are now also left of
+                    the split plane. */
+                left_count += num_start + num_planar;
+            }
+
+            /* Sanity check. Everything should now be left of the split plane */
+            Assert(right_count == 0 && left_count == prim_count);
+
+            return best;
         }
 
         /// Run one iteration of min-max binning and spawn recursive tasks
@@ -1011,6 +1237,7 @@ protected:
             if (prim_count <= derived.stop_primitives() ||
                 m_depth >= derived.max_depth() || m_tight_bbox.collapsed()) {
                 make_leaf(std::move(m_indices));
+                release_indices();
                 return nullptr;
             }
 
@@ -1060,6 +1287,7 @@ protected:
                 if ((best.cost > 4 * leaf_cost && prim_count < 16)
                     || m_bad_refines >= derived.max_bad_refines()) {
                     make_leaf(std::move(m_indices));
+                    release_indices();
                     return nullptr;
                 }
                 ++m_bad_refines;
@@ -1072,9 +1300,6 @@ protected:
 
             auto partition = bins.partition(derived, m_indices, best);
 
-            /* Release index list */
-            IndexVector().swap(m_indices);
-
             /* ==================================================================== */
             /*                              Recursion                               */
             /* ==================================================================== */
@@ -1106,6 +1331,9 @@ protected:
                 right_bounds, partition.right_bounds, m_depth + 1,
                 m_bad_refines, &right_cost);
 
+            /* Release index list (the children now hold their own lists) */
+            release_indices();
+
             set_ref_count(3);
             spawn(left_task);
             spawn(right_task);
@@ -1132,11 +1360,19 @@ protected:
             return nullptr;
         }
 
-        /// Recursively run the O(N log N builder)
-        Scalar build_nlogn(NodeIterator node, Size prim_count,
-                           EdgeEvent *events_start, EdgeEvent *events_end,
-                           const BoundingBox &bbox, Size depth,
-                           Size bad_refines, bool left_child = true) {
+        /**
+         * \brief Recursively run the O(N log N builder)
+         *
+         * Subtrees with at least \ref MTS_KD_NLOGN_GRAIN_SIZE primitives on
+         * both sides of the split are built in parallel. The resulting child
+         * invocations may run on other threads and thus treat the event list
+         * of their parent as \ref EventOwner::External.
+         */
+        Scalar build_nlogn(LocalBuildContext &local, NodeIterator node,
+                           Size prim_count, EdgeEvent *events_start,
+                           EdgeEvent *events_end, const BoundingBox &bbox,
+                           Size depth, Size bad_refines,
+                           EventOwner owner = EventOwner::Left) {
             const Derived &derived = m_ctx.derived;
 
             /* Initialize the tree cost model */
@@ -1161,101 +1397,38 @@ protected:
                tree construction heuristic. To do this in O(n), the search is
                implemented as a sweep over the edge events */
 
-            /* Initially, the split plane is placed left of the scene
-               and thus all geometry is on its right side */
-            Size left_count[Dimension], right_count[Dimension];
-            for (size_t i = 0; i < Dimension; ++i) {
-                left_count[i] = 0;
-                right_count[i] = prim_count;
-            }
-
-            /* Keep track of where events for different axes start */
+            /* Events are sorted by axis. Find where the events of each axis start */
             EdgeEvent* events_by_dimension[Dimension + 1] { };
             events_by_dimension[0] = events_start;
             events_by_dimension[Dimension] = events_end;
+            for (size_t i = 1; i < Dimension; ++i)
+                events_by_dimension[i] = std::lower_bound(
+                    events_by_dimension[i - 1], events_end, i,
+                    [](const EdgeEvent &e, size_t axis) { return e.axis < axis; });
+
+            for (size_t i = 0; i < Dimension; ++i)
+                Assert(events_by_dimension[i] != events_by_dimension[i + 1] &&
+                       events_by_dimension[i]->axis == i);
+
+            /* Sweep the axes (in parallel for large nodes) */
+            SplitCandidate candidates[Dimension];
+            auto sweep_axis = [&](size_t axis) {
+                candidates[axis] = sweep(model, bbox, prim_count,
+                                         events_by_dimension[axis],
+                                         events_by_dimension[axis + 1]);
+            };
+
+            if (prim_count >= MTS_KD_NLOGN_GRAIN_SIZE)
+                tbb::parallel_for(size_t(0), size_t(Dimension), sweep_axis);
+            else
+                for (size_t i = 0; i < Dimension; ++i)
+                    sweep_axis(i);
 
-            /* Iterate over all events and find the best split plane */
+            /* Combine in axis order, preferring earlier axes on ties */
             SplitCandidate best;
-            for (auto event = events_start; event != events_end; ) {
-                /* Record the current position and count the number
-                   and type of remaining events that are also here. */
-                Size num_start = 0, num_end = 0, num_planar = 0;
-                int axis = event->axis;
-                Scalar pos = event->pos;
-
-                while (event < events_end && event->pos == pos && event->axis == axis) {
-                    switch (event->type) {
-                        case EdgeEvent::Type::EdgeStart:  ++num_start;  break;
-                        case EdgeEvent::Type::EdgePlanar: ++num_planar; break;
-                        case EdgeEvent::Type::EdgeEnd:    ++num_end;    break;
-                    }
-                    ++event;
-                }
-
-                /* Keep track of the beginning of each dimension */
-                if (event < events_end && event->axis != axis)
-                    events_by_dimension[event->axis] = event;
-
-                /* The split plane can now be moved onto 't'. Accordingly, all planar
-                   and ending primitives are removed from the right side */
-                right_count[axis] -= num_planar + num_end;
-
-                /* Check if the edge event is out of bounds -- when primitive
-                   clipping is active, this should never happen! */
-                Assert(!(derived.clip_primitives() &&
-                         (pos < bbox.min[axis] || pos > bbox.max[axis])));
-
-                /* Calculate a score using the tree construction heuristic */
-                if (likely(pos > bbox.min[axis] && pos < bbox.max[axis])) {
-                    Size num_left = left_count[axis] + num_planar,
-                         num_right = right_count[axis];
-
-                    Scalar cost = model.inner_cost(
-                        axis, pos, model.leaf_cost(num_left),
-                        model.leaf_cost(num_right));
-
-                    if (cost < best.cost) {
-                        best.cost = cost;
-                        best.split = pos;
-                        best.axis = axis;
-                        best.left_count = num_left;
-                        best.right_count = num_right;
-                        best.planar_left = true;
-                    }
-
-                    if (num_planar != 0) {
-                        /* There are planar events here -- also consider
-                           placing them on the right side */
-                        num_left = left_count[axis];
-                        num_right = right_count[axis] + num_planar;
-
-                        cost = model.inner_cost(
-                            axis, pos, model.leaf_cost(num_left),
-                            model.leaf_cost(num_right));
-
-                        if (cost < best.cost) {
-                            best.cost = cost;
-                            best.split = pos;
-                            best.axis = axis;
-                            best.left_count = num_left;
-                            best.right_count = num_right;
-                            best.planar_left = false;
-                        }
-                    }
-                }
-
-                /* The split plane is moved past 't'. All prims,
-                    which were planar on 't', are moved to the left
-                    side. Also, starting prims are now also left of
-                    the split plane. */
-                left_count[axis] += num_start + num_planar;
-            }
-
-            /* Sanity checks. Everything should now be left of the split plane */
             for (size_t i = 0; i < Dimension; ++i) {
-                Assert(right_count[i] == 0 && left_count[i] == prim_count);
-                Assert(events_by_dimension[i] != events_end && events_by_dimension[i]->axis == i);
-                Assert((i == 0) || ((events_by_dimension[i]-1)->axis == i - 1));
+                if (candidates[i].cost < best.cost)
+                    best = candidates[i];
             }
 
             /* Allow a few bad refines in sequence before giving up */
@@ -1274,7 +1447,7 @@ protected:
             /*                      Primitive Classification                        */
             /* ==================================================================== */
 
-            auto &classification = m_local->classification_storage;
+            auto &classification = local.classification_storage;
 
             /* Initially mark all prims as being located on both sides */
             for (auto event = events_by_dimension[best.axis];
@@ -1332,8 +1505,8 @@ protected:
 
             Size pruned_left = 0, pruned_right = 0;
 
-            auto &left_alloc = m_local->left_alloc;
-            auto &right_alloc = m_local->right_alloc;
+            auto &left_alloc = local.left_alloc;
+            auto &right_alloc = local.right_alloc;
 
             EdgeEvent *left_events_start, *right_events_start,
                       *left_events_end, *right_events_end;
@@ -1341,14 +1514,19 @@ protected:
             /* First, allocate a conservative amount of scratch space for
                the final event lists and then resize it to the actual used
                amount */
-            if (left_child) {
+            if (owner == EventOwner::Left) {
                 left_events_start = events_start;
                 right_events_start = right_alloc.template allocate<EdgeEvent>(
                     best.right_count * 2 * Dimension);
-            } else {
+            } else if (owner == EventOwner::Right) {
                 left_events_start = left_alloc.template allocate<EdgeEvent>(
                     best.left_count * 2 * Dimension);
                 right_events_start = events_start;
+            } else {
+                left_events_start = left_alloc.template allocate<EdgeEvent>(
+                    best.left_count * 2 * Dimension);
+                right_events_start = right_alloc.template allocate<EdgeEvent>(
+                    best.right_count * 2 * Dimension);
             }
             left_events_end = left_events_start;
             right_events_end = right_events_start;
@@ -1417,8 +1595,9 @@ protected:
                             break;
 
                         case PrimClassification::Both: {
-                                BoundingBox clippedLeft  = derived.bbox(event.index, left_bbox);
-                                BoundingBox clippedRight = derived.bbox(event.index, right_bbox);
+                                Index prim_index = global_index(event.index);
+                                BoundingBox clippedLeft  = derived.bbox(prim_index, left_bbox);
+                                BoundingBox clippedRight = derived.bbox(prim_index, right_bbox);
 
                                 Assert(left_bbox.contains(clippedLeft) || !clippedLeft.valid());
                                 Assert(right_bbox.contains(clippedRight) || !clippedRight.valid());
@@ -1523,21 +1702,55 @@ protected:
                       "to store overly large offset to left child node (%i)",
                       left_offset);
 
-            Scalar left_cost =
-                build_nlogn(children, best.left_count - pruned_left,
-                            left_events_start, left_events_end, left_bbox,
-                            depth + 1, bad_refines, true);
+            Size left_prim_count  = best.left_count - pruned_left,
+                 right_prim_count = best.right_count - pruned_right;
+            Scalar left_cost = 0, right_cost = 0;
 
-            Scalar right_cost =
-                build_nlogn(std::next(children), best.right_count - pruned_right,
-                            right_events_start, right_events_end, right_bbox,
-                            depth + 1, bad_refines, false);
+            if (std::min(left_prim_count, right_prim_count) >= MTS_KD_NLOGN_GRAIN_SIZE) {
+                /* Build both subtrees in parallel. Either one may be stolen by
+                   another thread, hence both read the event lists of this
+                   node in place and allocate their own outputs */
+                auto build_child = [&](NodeIterator child, Size child_prim_count,
+                                       EdgeEvent *child_events_start,
+                                       EdgeEvent *child_events_end,
+                                       const BoundingBox &child_bbox) {
+                    ScopedSetThreadEnvironment env(m_ctx.env);
+                    m_ctx.work_units++;
+                    return build_nlogn(local_context(), child, child_prim_count,
+                                       child_events_start, child_events_end,
+                                       child_bbox, depth + 1, bad_refines,
+                                       EventOwner::External);
+                };
+
+                tbb::parallel_invoke(
+                    [&] {
+                        left_cost = build_child(children, left_prim_count,
+                                                left_events_start, left_events_end,
+                                                left_bbox);
+                    },
+                    [&] {
+                        right_cost = build_child(std::next(children), right_prim_count,
+                                                 right_events_start, right_events_end,
+                                                 right_bbox);
+                    }
+                );
+            } else {
+                left_cost =
+                    build_nlogn(local, children, left_prim_count,
+                                left_events_start, left_events_end, left_bbox,
+                                depth + 1, bad_refines, EventOwner::Left);
+
+                right_cost =
+                    build_nlogn(local, std::next(children), right_prim_count,
+                                right_events_start, right_events_end, right_bbox,
+                                depth + 1, bad_refines, EventOwner::Right);
+            }
 
             /* Release the index lists not needed by the children anymore */
-            if (left_child)
-                right_alloc.release(right_events_start);
-            else
+            if (owner != EventOwner::Left)
                 left_alloc.release(left_events_start);
+            if (owner != EventOwner::Right)
+                right_alloc.release(right_events_start);
 
             /* ==================================================================== */
             /*                           Final decision                             */
@@ -1568,62 +1781,77 @@ protected:
         /// Create an initial sorted edge event list and start the O(N log N) builder
         Scalar transition_to_nlogn() {
             const auto &derived = m_ctx.derived;
-            m_local = &((LocalBuildContext &) m_ctx.local);
+            bool compact = derived.compact();
+            LocalBuildContext &local = local_context();
 
-            Size prim_count = Size(m_indices.size()), final_prim_count = prim_count;
+            Size prim_count = Size(m_indices.size());
 
             /* We don't yet know how many edge events there will be. Allocate a
                conservative amount and shrink the buffer later on. */
             Size initial_size = prim_count * 2 * Dimension;
 
             EdgeEvent *events_start =
-                m_local->left_alloc.template allocate<EdgeEvent>(initial_size),
+                local.left_alloc.template allocate<EdgeEvent>(initial_size),
                 *events_end = events_start + initial_size;
 
-            for (Size i = 0; i<prim_count; ++i) {
-                Index prim_index = m_indices[i];
-                BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
-                bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
-
-                if (unlikely(!valid)) {
-                    --final_prim_count;
-                    m_ctx.pruned++;
-                }
-
-                for (Index axis = 0; axis < Dimension; ++axis) {
-                    Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
-                    Index offset = (Index) (axis * prim_count + i) * 2;
-
-                    if (unlikely(!valid)) {
-                        events_start[offset  ].set_invalid();
-                        events_start[offset+1].set_invalid();
-                    } else if (min == max) {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, prim_index);
-                        events_start[offset+1].set_invalid();
-                    } else {
-                        events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, prim_index);
-                        events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, prim_index);
+            /* Each primitive writes to its own slots, hence the events can be
+               generated in parallel */
+            std::atomic<Size> invalid_count { 0 };
+            tbb::parallel_for(
+                tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+                [&](const tbb::blocked_range<Size> &range) {
+                    Size invalid = 0;
+                    for (Size i = range.begin(); i != range.end(); ++i) {
+                        Index prim_index = m_indices[i],
+                              event_index = compact ? (Index) i : prim_index;
+                        BoundingBox prim_bbox = derived.bbox(prim_index, m_bbox);
+                        bool valid = prim_bbox.valid() && prim_bbox.surface_area() > 0;
+
+                        if (unlikely(!valid))
+                            ++invalid;
+
+                        for (Index axis = 0; axis < Dimension; ++axis) {
+                            Scalar min = prim_bbox.min[axis], max = prim_bbox.max[axis];
+                            Index offset = (Index) (axis * prim_count + i) * 2;
+
+                            if (unlikely(!valid)) {
+                                events_start[offset  ].set_invalid();
+                                events_start[offset+1].set_invalid();
+                            } else if (min == max) {
+                                events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgePlanar, axis, min, event_index);
+                                events_start[offset+1].set_invalid();
+                            } else {
+                                events_start[offset  ] = EdgeEvent(EdgeEvent::Type::EdgeStart, axis, min, event_index);
+                                events_start[offset+1] = EdgeEvent(EdgeEvent::Type::EdgeEnd,   axis, max, event_index);
+                            }
+                        }
                     }
+                    invalid_count += invalid;
                 }
-            }
+            );
 
-            /* Release index list */
-            IndexVector().swap(m_indices);
+            Size final_prim_count = prim_count - invalid_count;
+            m_ctx.pruned += invalid_count;
+
+            /* Release index list (unless it is needed to map the events of
+               the compact representation to primitives) */
+            if (!compact)
+                release_indices();
 
             /* Sort the events list and remove invalid ones from the end */
-            std::sort(events_start, events_end);
+            tbb::parallel_sort(events_start, events_end);
             while (events_start != events_end && !(events_end-1)->valid())
                 --events_end;
 
-            m_local->left_alloc.template shrink_allocation<EdgeEvent>(
+            local.left_alloc.template shrink_allocation<EdgeEvent>(
                 events_start, events_end - events_start);
-            m_local->classification_storage.resize(derived.primitive_count());
-            m_local->ctx = &m_ctx;
 
-            Scalar cost = build_nlogn(m_node, final_prim_count, events_start,
+            Scalar cost = build_nlogn(local, m_node, final_prim_count, events_start,
                                      events_end, m_bbox, m_depth, 0);
 
-            m_local->left_alloc.release(events_start);
+            local.left_alloc.release(events_start);
+            if (compact)
+                release_indices();
 
             return cost;
         }
@@ -1656,7 +1884,7 @@ protected:
                 if (event->type == EdgeEvent::Type::EdgeStart ||
                     event->type == EdgeEvent::Type::EdgePlanar) {
                     Assert(--prim_count >= 0);
-                    *it++ = event->index;
+                    *it++ = global_index(event->index);
                 }
             }
 
@@ -1694,6 +1922,7 @@ protected:
                 ctx.max_prims_in_leaf = prim_count;
             if (prim_count > 0)
                 ctx.nonempty_leaf_count++;
+            ctx.prim_refs += prim_count;
         } else {
             ctx.exp_traversal_steps += (double) CostModel::eval(bbox);
 
@@ -1785,16 +2014,11 @@ protected:
         m_node_count = Size(ctx.node_storage.size());
         m_index_count = Size(ctx.index_storage.size());
 
-        m_indices.reset(new Index[m_index_count]);
-        tbb::parallel_for(
-            tbb::blocked_range<Size>(0u, m_index_count, MTS_KD_GRAIN_SIZE),
-            [&](const tbb::blocked_range<Size> &range) {
-                for (Size i = range.begin(); i != range.end(); ++i)
-                    m_indices[i] = ctx.index_storage[i];
-            }
-        );
-
-        tbb::concurrent_vector<Index>().swap(ctx.index_storage);
+        /* Upper bound of the memory used so far: tracked temporary index
+           lists, edge events and classification tables plus the storage */
+        size_t node_storage  = m_node_count * sizeof(KDNode),
+               index_storage = m_index_count * sizeof(Index);
+        m_peak_build_memory = ctx.memory_peak + node_storage + index_storage;
 
         m_nodes.reset(new KDNode[m_node_count]);
         tbb::parallel_for(
@@ -1806,6 +2030,26 @@ protected:
         );
         tbb::concurrent_vector<KDNode>().swap(ctx.node_storage);
 
+        if (m_compact) {
+            /* Directly convert the index storage, the full index list
+               is never allocated in compact mode */
+            compact_indices(ctx.index_storage);
+        } else {
+            m_indices.reset(new Index[m_index_count]);
+            tbb::parallel_for(
+                tbb::blocked_range<Size>(0u, m_index_count, MTS_KD_GRAIN_SIZE),
+                [&](const tbb::blocked_range<Size> &range) {
+                    for (Size i = range.begin(); i != range.end(); ++i)
+                        m_indices[i] = ctx.index_storage[i];
+                }
+            );
+        }
+        tbb::concurrent_vector<Index>().swap(ctx.index_storage);
+
+        m_peak_build_memory = std::max(m_peak_build_memory, std::max(
+            node_storage * 2 + index_storage,
+            node_storage + index_storage + m_index_count * sizeof(Index)));
+
         /* Slightly avoid the bounding box to avoid numerical issues
            involving geometry that exactly lies on the boundary */
         Vector extra = (m_bbox.extents() + 1.f) * math::Epsilon<Scalar>;
@@ -1840,6 +2084,9 @@ protected:
             Log(m_log_level, "   Temporary storage used      : %s",
                 util::mem_string(ctx.temp_storage));
 
+            Log(m_log_level, "   Peak build memory           : %s",
+                util::mem_string(m_peak_build_memory));
+
             Log(m_log_level, "   Parallel work units         : %i",
                 ctx.work_units);
 
@@ -1867,7 +2114,7 @@ protected:
             Log(m_log_level, "   Largest leaf node           : %i primitives",
                 ctx.max_prims_in_leaf);
             Log(m_log_level, "   Avg. prims/nonempty leaf    : %.2f",
-                m_index_count / (Scalar) ctx.nonempty_leaf_count);
+                ctx.prim_refs / (Scalar) ctx.nonempty_leaf_count);
             Log(m_log_level, "   Expected traversals/query   : %.2f",
                 ctx.exp_traversal_steps);
             Log(m_log_level, "   Expected leaf visits/query  : %.2f",
@@ -1880,7 +2127,343 @@ protected:
         }
     }
 
+    /**
+     * \brief Update the tree after the primitives have moved ("refit")
+     *
+     * The number of primitives must be the same as during \ref build(). The
+     * nodes of a kd-tree only store split planes, which remain a valid
+     * partition of space when the geometry moves. This function therefore
+     * keeps all existing splits, recomputes the scene bounding box, and
+     * redistributes the primitives over the existing leaves. Leaves that are
+     * now considerably more crowded than before (by more than a factor of \c
+     * rebuild_factor) are replaced by freshly built subtrees.
+     *
+     * \return The number of subtrees that were rebuilt
+     */
+    Size refit(Scalar rebuild_factor = 2) {
+        if (!ready())
+            Throw("The kd-tree must be built before it can be refit!");
+
+        Size prim_count = derived().primitive_count();
+
+        /* ==================================================================== */
+        /*                  Recompute the scene bounding box                    */
+        /* ==================================================================== */
+
+        m_bbox = tbb::parallel_reduce(
+            tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+            BoundingBox(),
+            [&](const tbb::blocked_range<Size> &range, BoundingBox bbox) {
+                for (Size i = range.begin(); i != range.end(); ++i)
+                    bbox.expand(derived().bbox(i));
+                return bbox;
+            },
+            [](BoundingBox b1, const BoundingBox &b2) {
+                b1.expand(b2);
+                return b1;
+            }
+        );
+
+        if (!m_bbox.valid()) {
+            m_bbox.min = 0.f;
+            m_bbox.max = 0.f;
+        }
+
+        Vector extra = (m_bbox.extents() + 1.f) * math::Epsilon<Scalar>;
+        m_bbox.min -= extra;
+        m_bbox.max += extra;
+
+        /* ==================================================================== */
+        /*           Collect the leaves along with their bounds and depth       */
+        /* ==================================================================== */
+
+        struct Leaf {
+            Size node, depth;
+            BoundingBox bbox;
+            Size old_count, count = 0, offset = 0;
+            bool rebuild = false;
+        };
+
+        struct StackEntry {
+            Size node, depth;
+            BoundingBox bbox;
+        };
+
+        std::vector<Leaf> leaves;
+        std::unique_ptr<Size[]> leaf_slot(new Size[m_node_count]);
+        std::vector<StackEntry> stack { StackEntry{ 0, 0, m_bbox } };
+
+        while (!stack.empty()) {
+            StackEntry entry = stack.back();
+            stack.pop_back();
+            const KDNode &node = m_nodes[entry.node];
+
+            if (node.leaf()) {
+                leaf_slot[entry.node] = Size(leaves.size());
+                leaves.push_back(Leaf{ entry.node, entry.depth, entry.bbox,
+                                       node.primitive_count() });
+                continue;
+            }
+
+            Size axis = node.axis(),
+                 left = entry.node + node.left_offset();
+            BoundingBox left_bbox(entry.bbox), right_bbox(entry.bbox);
+            left_bbox.max[axis] = std::min(left_bbox.max[axis], node.split());
+            right_bbox.min[axis] = std::max(right_bbox.min[axis], node.split());
+
+            stack.push_back(StackEntry{ left + 1, entry.depth + 1, right_bbox });
+            stack.push_back(StackEntry{ left, entry.depth + 1, left_bbox });
+        }
+
+        /* ==================================================================== */
+        /*         Redistribute the primitives over the existing leaves         */
+        /* ==================================================================== */
+
+        /// Invoke 'func' for every leaf overlapping the bounding box of a primitive
+        auto for_each_leaf = [&](const BoundingBox &bbox, auto func) {
+            const KDNode *stack[MTS_KD_MAXDEPTH + 1];
+            Size stack_index = 0;
+            const KDNode *node = m_nodes.get();
+
+            while (true) {
+                if (!node->leaf()) {
+                    Scalar split = node->split();
+                    Size axis = node->axis();
+                    bool left  = bbox.min[axis] <= split,
+                         right = bbox.max[axis] >= split;
+
+                    if (left && right)
+                        stack[stack_index++] = node->right();
+                    node = left ? node->left() : node->right();
+                    continue;
+                }
+
+                func(leaf_slot[node - m_nodes.get()]);
+                if (stack_index == 0)
+                    break;
+                node = stack[--stack_index];
+            }
+        };
+
+        std::unique_ptr<std::atomic<Size>[]> counters(
+            new std::atomic<Size>[leaves.size()]);
+        for (size_t i = 0; i < leaves.size(); ++i)
+            counters[i] = 0;
+
+        tbb::parallel_for(
+            tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+            [&](const tbb::blocked_range<Size> &range) {
+                for (Size i = range.begin(); i != range.end(); ++i) {
+                    BoundingBox bbox = derived().bbox(i);
+                    if (bbox.valid())
+                        for_each_leaf(bbox, [&](Size slot) { counters[slot]++; });
+                }
+            }
+        );
+
+        Size ref_count = 0, rebuild_count = 0;
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            Leaf &leaf = leaves[i];
+            leaf.count = counters[i];
+            leaf.offset = ref_count;
+            leaf.rebuild = leaf.count > m_stop_primitives &&
+                leaf.count > rebuild_factor * std::max(leaf.old_count, m_stop_primitives);
+            ref_count += leaf.count;
+            rebuild_count += leaf.rebuild ? 1 : 0;
+            counters[i] = leaf.offset;
+        }
+
+        IndexVector refs(ref_count);
+        tbb::parallel_for(
+            tbb::blocked_range<Size>(0u, prim_count, MTS_KD_GRAIN_SIZE),
+            [&](const tbb::blocked_range<Size> &range) {
+                for (Size i = range.begin(); i != range.end(); ++i) {
+                    BoundingBox bbox = derived().bbox(i);
+                    if (bbox.valid())
+                        for_each_leaf(bbox, [&](Size slot) { refs[counters[slot]++] = i; });
+                }
+            }
+        );
+
+        /* Restore a deterministic order within each leaf */
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0u, leaves.size()),
+            [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    std::sort(refs.begin() + leaves[i].offset,
+                              refs.begin() + leaves[i].offset + leaves[i].count);
+            }
+        );
+
+        /* ==================================================================== */
+        /*                  Rebuild the subtrees of crowded leaves              */
+        /* ==================================================================== */
+
+        struct Subtree {
+            Size leaf;
+            std::vector<KDNode> nodes;
+            std::vector<Index> indices;
+        };
+
+        std::vector<Subtree> subtrees;
+        for (size_t i = 0; i < leaves.size(); ++i) {
+            const Leaf &leaf = leaves[i];
+            if (!leaf.rebuild)
+                continue;
+
+            IndexVector indices(refs.begin() + leaf.offset,
+                                refs.begin() + leaf.offset + leaf.count);
+
+            BoundingBox tight_bbox;
+            for (Index index : indices)
+                tight_bbox.expand(derived().bbox(index));
+            tight_bbox.clip(leaf.bbox);
+
+            BuildContext ctx(derived());
+            ctx.node_storage.grow_by(1);
+
+            Scalar cost = 0;
+            if (tight_bbox.valid()) {
+                BuildTask &task = *new (tbb::task::allocate_root()) BuildTask(
+                    ctx, ctx.node_storage.begin(), std::move(indices),
+                    leaf.bbox, tight_bbox, leaf.depth, 0, &cost);
+                tbb::task::spawn_root_and_wait(task);
+            } else {
+                ctx.index_storage.grow_by(indices.begin(), indices.end());
+                ctx.node_storage[0].set_leaf_node(0, indices.size());
+            }
+
+            subtrees.push_back(Subtree{
+                Size(i),
+                std::vector<KDNode>(ctx.node_storage.begin(), ctx.node_storage.end()),
+                std::vector<Index>(ctx.index_storage.begin(), ctx.index_storage.end())
+            });
+        }
+
+        /* ==================================================================== */
+        /*        Store the node and index lists in a compact format again      */
+        /* ==================================================================== */
+
+        Size node_count = m_node_count, index_count = 0;
+        for (const Leaf &leaf : leaves)
+            index_count += leaf.rebuild ? 0 : leaf.count;
+        for (const Subtree &subtree : subtrees) {
+            node_count += Size(subtree.nodes.size()) - 1;
+            index_count += Size(subtree.indices.size());
+        }
+
+        std::unique_ptr<KDNode[]> nodes(new KDNode[node_count]);
+        std::unique_ptr<Index[]> indices(new Index[index_count]);
+        std::copy(m_nodes.get(), m_nodes.get() + m_node_count, nodes.get());
+
+        Size index_pos = 0;
+        for (const Leaf &leaf : leaves) {
+            if (leaf.rebuild)
+                continue;
+            std::copy(refs.begin() + leaf.offset,
+                      refs.begin() + leaf.offset + leaf.count,
+                      indices.get() + index_pos);
+            if (!nodes[leaf.node].set_leaf_node(index_pos, leaf.count))
+                Throw("Internal error: could not create leaf node with %i "
+                      "primitives -- too much geometry?", leaf.count);
+            index_pos += leaf.count;
+        }
+
+        /* Append the new subtrees. The root of each subtree replaces the
+           original leaf, and all other nodes are moved to the end of the
+           node list (relative child offsets remain valid) */
+        Size node_pos = m_node_count;
+        for (const Subtree &subtree : subtrees) {
+            Size leaf_node = leaves[subtree.leaf].node;
+            std::copy(subtree.indices.begin(), subtree.indices.end(),
+                      indices.get() + index_pos);
+
+            for (size_t j = 0; j < subtree.nodes.size(); ++j) {
+                KDNode node = subtree.nodes[j];
+                Size target = j == 0 ? leaf_node : node_pos + Size(j) - 1;
+                bool success = true;
+
+                if (node.leaf())
+                    success = node.set_leaf_node(node.primitive_offset() + index_pos,
+                                                 node.primitive_count());
+                else if (j == 0)
+                    success = node.set_inner_node(
+                        node.axis(), node.split(),
+                        node_pos + node.left_offset() - 1 - leaf_node);
+
+                if (!success)
+                    Throw("Internal error during kd-tree refit: unable to store "
+                          "node %i of a rebuilt subtree", j);
+                nodes[target] = node;
+            }
+
+            node_pos += Size(subtree.nodes.size()) - 1;
+            index_pos += Size(subtree.indices.size());
+        }
+
+        m_nodes = std::move(nodes);
+        m_node_count = node_count;
+        if (m_compact) {
+            compact_indices(indices);
+        } else {
+            m_indices = std::move(indices);
+            m_index_count = index_count;
+        }
+
+        Log(m_log_level, "kd-tree refit: %i leaves, %i subtrees rebuilt, "
+            "%i primitive references", leaves.size(), rebuild_count, m_index_count);
+
+        return rebuild_count;
+    }
+
 protected:
+    /**
+     * \brief Convert the index list into the compact representation (see
+     * \ref set_compact())
+     *
+     * The primitive offsets of the leaves in \c m_nodes refer to the
+     * (uncompressed) index list \c source. Single-primitive leaves store
+     * their primitive index directly, and the remaining lists are packed
+     * into a new \c m_indices array.
+     */
+    template <typename Source> void compact_indices(const Source &source) {
+        Size index_count = 0, ref_count = 0;
+        for (Size i = 0; i < m_node_count; ++i) {
+            const KDNode &node = m_nodes[i];
+            if (!node.leaf())
+                continue;
+            ref_count += node.primitive_count();
+            if (node.primitive_count() > 1)
+                index_count += node.primitive_count();
+        }
+
+        std::unique_ptr<Index[]> indices(new Index[index_count]);
+        Size index_pos = 0;
+        for (Size i = 0; i < m_node_count; ++i) {
+            KDNode &node = m_nodes[i];
+            if (!node.leaf())
+                continue;
+
+            Size offset = node.primitive_offset(),
+                 count  = node.primitive_count();
+
+            if (count == 1) {
+                node.set_leaf_node(source[offset], 1);
+            } else {
+                for (Size j = 0; j < count; ++j)
+                    indices[index_pos + j] = source[offset + j];
+                node.set_leaf_node(index_pos, count);
+                index_pos += count;
+            }
+        }
+
+        Log(m_log_level, "Compact index list: %i of %i references remain (%s)",
+            index_count, ref_count, util::mem_string(index_count * sizeof(Index)));
+
+        m_indices = std::move(indices);
+        m_index_count = index_count;
+    }
+
     std::unique_ptr<KDNode[]> m_nodes;
     std::unique_ptr<Index[]> m_indices;
     Size m_node_count = 0;
@@ -1894,6 +2477,8 @@ protected:
     Size m_max_bad_refines = 0;
     Size m_exact_prim_threshold = 65536;
     Size m_min_max_bins = 128;
+    bool m_compact = false;
+    size_t m_peak_build_memory = 0;
     LogLevel m_log_level = Debug;
     BoundingBox m_bbox;
 };
@@ -2010,7 +2595,7 @@ class MTS_EXPORT_RENDER ShapeKDTree : public TShapeKDTree<BoundingBox<Point<scal
                                                           SurfaceAreaHeuristic3<scalar_t<Float>>,
                                                           ShapeKDTree<Float, Spectrum>> {
 public:
-    MTS_IMPORT_TYPES(Shape, Mesh)
+    MTS_IMPORT_TYPES(Shape, Mesh, BSDF)
 
     using SurfaceAreaHeuristic3f = SurfaceAreaHeuristic3<ScalarFloat>;
     using Size                   = uint32_t;
@@ -2019,7 +2604,9 @@ public:
     using Base = TShapeKDTree<ScalarBoundingBox3f, uint32_t, SurfaceAreaHeuristic3f, ShapeKDTree>;
     using typename Base::KDNode;
     using Base::ready;
+    using Base::compact;
     using Base::set_clip_primitives;
+    using Base::set_compact;
     using Base::set_exact_primitive_threshold;
     using Base::set_max_depth;
     using Base::set_min_max_bins;
@@ -2031,6 +2618,16 @@ public:
     using Base::m_indices;
     using Base::m_index_count;
     using Base::m_node_count;
+    using Base::leaf_primitive;
+    using Base::peak_build_memory;
+
+    /// Number of triangles tested at once by the leaf kernel of scalar variants
+    static constexpr size_t LeafPacketSize =
+        std::min(Packet<ScalarFloat>::Size, size_t(MTS_KD_LEAF_PACKET_SIZE));
+
+    using LeafPacketFloat   = Packet<ScalarFloat, LeafPacketSize>;
+    using LeafPacketVector3 = Vector<LeafPacketFloat, 3>;
+    using LeafPacketMask    = mask_t<LeafPacketFloat>;
 
     /// Create an empty kd-tree and take build-related parameters from \c props.
     ShapeKDTree(const Properties &props);
@@ -2041,6 +2638,37 @@ public:
     /// Build the kd-tree
     void build();
 
+    /**
+     * \brief (Re-)compute the intersection-optimized copy of the triangle
+     * data used by the traversal code
+     *
+     * This is called by \ref build(), and it must be called again whenever
+     * the vertex positions of a registered mesh change.
+     */
+    void build_triangle_cache();
+
+    /**
+     * \brief (Re-)compute the SIMD-friendly copy of the triangles stored in
+     * the leaves of the tree
+     *
+     * Scalar variants test the triangles of leaf nodes in packets of \ref
+     * LeafPacketSize, which requires the triangle cache (see \ref
+     * build_triangle_cache()). Leaves with a single primitive or containing
+     * non-mesh or alpha-tested shapes keep using the per-primitive code path.
+     * This function does nothing in packet variants.
+     */
+    void build_leaf_packets();
+
+    /**
+     * \brief Bring the tree up to date after the geometry of registered
+     * meshes changed (see \ref Mesh::dirty())
+     *
+     * When the primitive counts of all shapes are unchanged, the existing
+     * tree is refit (see \ref TShapeKDTree::refit()). Otherwise, it is
+     * rebuilt from scratch. Does nothing if no mesh is marked as dirty.
+     */
+    void update();
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2094,6 +2722,10 @@ public:
         // True if an intersection has been found
         bool hit = false;
 
+        // Traversal statistics, committed when leaving this function
+        ScopedStatsCounter nodes_visited(StatsCounter::KDNodesVisited),
+                           prims_visited(StatsCounter::KDPrimitivesVisited);
+
         // Intersect against the scene bounding box
         auto bbox_result = m_bbox.ray_intersect(ray);
 
@@ -2102,6 +2734,7 @@ public:
 
         const KDNode *node = m_nodes.get();
         while (mint <= maxt) {
+            ++nodes_visited;
             if (likely(!node->leaf())) { // Inner node
                 const Float split   = node->split();
                 const uint32_t axis = node->axis();
@@ -2139,15 +2772,17 @@ public:
                 maxt = t_plane;
                 continue;
             } else if (node->primitive_count() > 0) { // Arrived at a leaf node
-                Index prim_start = node->primitive_offset();
-                Index prim_end = prim_start + node->primitive_count();
-                for (Index i = prim_start; i < prim_end; i++) {
-                    Index prim_index = m_indices[i];
+                Index prim_count = node->primitive_count();
+                prims_visited += prim_count;
 
+                Index packet_offset = m_leaf_packets
+                    ? m_leaf_packets[node - m_nodes.get()] : InvalidPacket;
+
+                if (packet_offset != InvalidPacket) {
                     bool prim_hit;
                     Float prim_t;
-                    std::tie(prim_hit, prim_t) =
-                        intersect_prim<ShadowRay>(prim_index, ray, cache, true);
+                    std::tie(prim_hit, prim_t) = intersect_leaf_packets<ShadowRay>(
+                        packet_offset, prim_count, ray, cache);
 
                     if (unlikely(prim_hit)) {
                         if (ShadowRay)
@@ -2157,6 +2792,24 @@ public:
                         ray.maxt = prim_t;
                         hit = true;
                     }
+                } else {
+                    for (Index i = 0; i < prim_count; i++) {
+                        Index prim_index = leaf_primitive(node, i);
+
+                        bool prim_hit;
+                        Float prim_t;
+                        std::tie(prim_hit, prim_t) =
+                            intersect_prim<ShadowRay>(prim_index, ray, cache, true);
+
+                        if (unlikely(prim_hit)) {
+                            if (ShadowRay)
+                                return { true, prim_t };
+
+                            Assert(prim_t >= ray.mint && prim_t <= ray.maxt);
+                            ray.maxt = prim_t;
+                            hit = true;
+                        }
+                    }
                 }
             }
 
@@ -2173,6 +2826,79 @@ public:
         return { hit, hit ? ray.maxt : math::Infinity<Float> };
     }
 
+    /**
+     * \brief Intersect a ray against the triangle packets of a leaf node
+     * (scalar variants only)
+     *
+     * Tests \ref LeafPacketSize triangles per step and returns the closest
+     * intersection among them (or any intersection in the case of shadow
+     * rays). The intersection cache is filled in the same way as by \ref
+     * intersect_prim().
+     */
+    template <bool ShadowRay>
+    MTS_INLINE std::pair<bool, Float>
+    intersect_leaf_packets(Index packet_offset, Index prim_count,
+                           const Ray3f &ray, Float *cache) const {
+        static_assert(!is_array_v<Float>, "Only supported in scalar variants!");
+        using UInt = uint_array_t<Float>;
+
+        LeafPacketVector3 o(ray.o.x(), ray.o.y(), ray.o.z()),
+                          d(ray.d.x(), ray.d.y(), ray.d.z());
+
+        const TrianglePacket *packet = m_triangle_packets.get() + packet_offset,
+                             *end = packet + (prim_count + LeafPacketSize - 1) / LeafPacketSize;
+
+        bool hit = false;
+        Float maxt = ray.maxt, u_hit = 0.f, v_hit = 0.f;
+        Index prim_hit = 0;
+
+        for (; packet != end; ++packet) {
+            LeafPacketVector3 pvec = cross(d, packet->e2);
+            LeafPacketFloat inv_det = rcp(dot(packet->e1, pvec));
+
+            LeafPacketVector3 tvec = o - packet->p0;
+            LeafPacketFloat u = dot(tvec, pvec) * inv_det;
+
+            LeafPacketVector3 qvec = cross(tvec, packet->e1);
+            LeafPacketFloat v = dot(d, qvec) * inv_det;
+            LeafPacketFloat t = dot(packet->e2, qvec) * inv_det;
+
+            LeafPacketMask active = u >= 0.f && u <= 1.f && v >= 0.f &&
+                                    u + v <= 1.f && t >= ray.mint && t <= maxt;
+
+            if (likely(none(active)))
+                continue;
+
+            t = select(active, t, math::Infinity<Float>);
+            Float t_min = hmin(t);
+
+            if constexpr (ShadowRay)
+                return { true, t_min };
+
+            /* Find the lane of the closest hit (padding lanes duplicate the
+               last triangle of the leaf, hence ties are harmless) */
+            size_t lane = 0;
+            while (t.coeff(lane) != t_min)
+                ++lane;
+
+            hit = true;
+            maxt = t_min;
+            u_hit = u.coeff(lane);
+            v_hit = v.coeff(lane);
+            prim_hit = packet->prim_index[lane];
+        }
+
+        if (!ShadowRay && hit) {
+            const TriangleRecord &tri = m_triangles[prim_hit];
+            cache[0] = reinterpret_array<Float>(UInt(tri.shape_index));
+            cache[1] = reinterpret_array<Float>(UInt(tri.prim_index));
+            cache[2] = u_hit;
+            cache[3] = v_hit;
+        }
+
+        return { hit, maxt };
+    }
+
     template <bool ShadowRay>
     MTS_INLINE std::pair<Mask, Float> ray_intersect_packet(Ray3f ray,
                                                            Float *cache,
@@ -2194,6 +2920,10 @@ public:
         // True if an intersection has been found
         Mask hit = false;
 
+        // Traversal statistics (counted per active SIMD lane)
+        ScopedStatsCounter nodes_visited(StatsCounter::KDNodesVisited),
+                           prims_visited(StatsCounter::KDPrimitivesVisited);
+
         const KDNode *node = m_nodes.get();
 
         /* Intersect against the scene bounding box */
@@ -2207,6 +2937,8 @@ public:
                 active = active && !hit;
 
             if (likely(any(active))) {
+                size_t active_lanes = count(active);
+                nodes_visited += active_lanes;
                 if (likely(!node->leaf())) { // Inner node
                     const scalar_t<Float> split = node->split();
                     const uint32_t axis = node->axis();
@@ -2265,10 +2997,10 @@ public:
                     node = n_cur;
                     continue;
                 } else if (node->primitive_count() > 0) { // Arrived at a leaf node
-                    Index prim_start = node->primitive_offset();
-                    Index prim_end = prim_start + node->primitive_count();
-                    for (Index i = prim_start; i < prim_end; i++) {
-                        Index prim_index = m_indices[i];
+                    Index prim_count = node->primitive_count();
+                    prims_visited += active_lanes * prim_count;
+                    for (Index i = 0; i < prim_count; i++) {
+                        Index prim_index = leaf_primitive(node, i);
 
                         Mask prim_hit;
                         Float prim_t;
@@ -2414,20 +3146,52 @@ protected:
                "Standard rays (i.e. non-shadow rays) must provide a `cache`"
                " pointer to store intersection data.");
 
-        Index shape_index  = find_shape(prim_index);
+        Index shape_index;
+        const TriangleRecord *tri = nullptr;
+
+        if (m_triangles) {
+            // Avoid the binary search and the face/vertex buffer indirection
+            tri = &m_triangles[prim_index];
+            shape_index = tri->shape_index;
+            prim_index = tri->prim_index;
+        } else {
+            shape_index = find_shape(prim_index);
+        }
+
         const Shape *shape = this->shape(shape_index);
-        bool is_mesh = shape->is_mesh();
+        const BSDF *bsdf = shape->bsdf();
+        bool is_mesh = shape->is_mesh(),
+             alpha_tested = bsdf != nullptr && bsdf->has_alpha_test();
+
+        /* Intersection data of alpha-tested shapes is kept in local storage
+           until the hit has been accepted, since it must not overwrite the
+           data of a previously found intersection */
+        Float alpha_cache[MTS_KD_INTERSECTION_CACHE_SIZE - 2];
 
         Mask hit;
         Float u = 0.f, v = 0.f, t = 0.f;
 
-        if (is_mesh)
+        if (tri && is_mesh)
+            std::tie(hit, u, v, t) = Mesh::ray_intersect_triangle_edges(
+                Point3f(tri->p0[0], tri->p0[1], tri->p0[2]),
+                Vector3f(tri->e1[0], tri->e1[1], tri->e1[2]),
+                Vector3f(tri->e2[0], tri->e2[1], tri->e2[2]), ray, active);
+        else if (is_mesh)
             std::tie(hit, u, v, t) = ((const Mesh *) shape)
                     ->ray_intersect_triangle(prim_index, ray, active);
-        else if (ShadowRay)
+        else if (ShadowRay && !alpha_tested)
             hit = shape->ray_test(ray, active);
         else
-            std::tie(hit, t) = shape->ray_intersect(ray, cache + 2, active);
+            std::tie(hit, t) = shape->ray_intersect(
+                ray, alpha_tested ? alpha_cache : cache + 2, active);
+
+        if (alpha_tested && any(hit)) {
+            if (is_mesh) {
+                alpha_cache[0] = u;
+                alpha_cache[1] = v;
+            }
+            hit &= alpha_test(shape, prim_index, ray, t, alpha_cache, hit);
+        }
 
         if (!ShadowRay && any(hit)) {
             Float shape_index_v = reinterpret_array<Float>(UInt(shape_index));
@@ -2449,15 +3213,87 @@ protected:
                     masked(cache[2], hit) = u;
                     masked(cache[3], hit) = v;
                 }
+            } else if (alpha_tested) {
+                for (size_t i = 0; i < MTS_KD_INTERSECTION_CACHE_SIZE - 2; ++i) {
+                    if constexpr (!is_array_v<Float>)
+                        cache[i + 2] = alpha_cache[i];
+                    else
+                        masked(cache[i + 2], hit) = alpha_cache[i];
+                }
             }
         }
 
         return { hit, t };
     }
 
+    /**
+     * \brief Evaluate the alpha test of a shape's BSDF for a tentative
+     * intersection found during traversal
+     *
+     * Only the geometric part of the surface interaction is reconstructed
+     * (see \ref BSDF::alpha_test()).
+     */
+    MTS_INLINE Mask alpha_test(const Shape *shape, Index prim_index, const Ray3f &ray,
+                               Float t, const Float *cache, Mask active) const {
+        SurfaceInteraction3f si = zero<SurfaceInteraction3f>(slices(active));
+        si.t = t;
+        si.time = ray.time;
+        si.wavelengths = ray.wavelengths;
+        si.shape = shape;
+        si.prim_index = prim_index;
+        si.instance = nullptr;
+        si.duv_dx = si.duv_dy = zero<Point2f>();
+
+        shape->fill_surface_interaction(ray, cache, si, active);
+
+        si.sh_frame.s = normalize(
+            fnmadd(si.sh_frame.n, dot(si.sh_frame.n, si.dp_du), si.dp_du));
+        si.sh_frame.t = cross(si.sh_frame.n, si.sh_frame.s);
+        si.wi = select(active, si.to_local(-ray.d), -ray.d);
+
+        return active && shape->bsdf()->alpha_test(si, active);
+    }
+
 protected:
+    /**
+     * \brief Intersection-optimized copy of a primitive, indexed by the
+     * kd-tree's global primitive index
+     *
+     * Stores the first vertex and the two edge vectors of mesh triangles, so
+     * that leaf intersection tests read a single contiguous record instead of
+     * gathering three vertices through the face buffer. For other shapes,
+     * only the shape and primitive indices are valid.
+     */
+    struct alignas(16) TriangleRecord {
+        ScalarFloat p0[3], e1[3], e2[3];
+        /// Index of the shape and of the primitive within that shape
+        Index shape_index, prim_index;
+    };
+
+    /**
+     * \brief Triangles of a leaf node in structure-of-arrays layout, which
+     * lets the scalar traversal code test them in a single SIMD operation
+     *
+     * Unused lanes of the last packet of a leaf duplicate its last triangle.
+     */
+    struct TrianglePacket {
+        LeafPacketVector3 p0, e1, e2;
+        /// Global primitive index of each lane (see \ref m_triangles)
+        Index prim_index[LeafPacketSize];
+    };
+
+    /// Marks leaf nodes that don't have any triangle packets
+    static constexpr Index InvalidPacket = (Index) -1;
+
     std::vector<ref<Shape>> m_shapes;
     std::vector<Size> m_primitive_map;
+    std::unique_ptr<TriangleRecord[]> m_triangles;
+    /// Offset of the first triangle packet of each node (or \ref InvalidPacket)
+    std::unique_ptr<Index[]> m_leaf_packets;
+    std::unique_ptr<TrianglePacket[]> m_triangle_packets;
+    Size m_triangle_packet_count = 0;
+    bool m_triangle_cache = true;
+    bool m_use_leaf_packets = true;
 };
 
 MTS_EXTERN_CLASS_RENDER(ShapeKDTree)
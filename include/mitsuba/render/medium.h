@@ -68,6 +68,27 @@ public:
     eval_tr_and_pdf(const MediumInteraction3f &mi,
                     const SurfaceInteraction3f &si, Mask active) const;
 
+    /**
+     * \brief Estimate the transmittance along a ray segment
+     *
+     * This function returns an unbiased estimate of the transmittance
+     * between <tt>ray.mint</tt> and <tt>ray.maxt</tt>, which is e.g. needed
+     * to evaluate shadow rays towards emitters. In contrast to repeatedly
+     * calling \ref sample_interaction(), no intersections with the scene are
+     * required, and the estimate is smooth instead of binary.
+     *
+     * The default implementation performs ratio tracking with respect to the
+     * medium's majorant. Subclasses can provide better estimators, e.g. the
+     * closed-form solution for homogeneous media.
+     *
+     * \param ray      Ray segment along which the transmittance is estimated
+     * \param sampler  Source of random numbers (not used by deterministic
+     *                 implementations)
+     */
+    virtual UnpolarizedSpectrum eval_transmittance(const Ray3f &ray,
+                                                   Sampler *sampler,
+                                                   Mask active = true) const;
+
     /// Return the phase function of this medium
     MTS_INLINE const PhaseFunction *phase_function() const {
         return m_phase_function.get();
@@ -97,6 +118,20 @@ protected:
     Medium(const Properties &props);
     virtual ~Medium();
 
+    /**
+     * \brief Residual ratio tracking transmittance estimator
+     *
+     * Splits the extinction into a constant control component \c control,
+     * whose transmittance is evaluated in closed form, and a residual
+     * component that is estimated using ratio tracking with the residual
+     * majorant <tt>majorant - control</tt>. When \c control is zero, this is
+     * standard ratio tracking. Both values must bound the medium's extinction
+     * from below and above, respectively.
+     */
+    UnpolarizedSpectrum eval_transmittance_residual(const Ray3f &ray, Sampler *sampler,
+                                                    Float control, Float majorant,
+                                                    Mask active) const;
+
 protected:
     ref<PhaseFunction> m_phase_function;
     bool m_sample_emitters, m_is_homogeneous, m_has_spectral_extinction;
@@ -122,6 +157,7 @@ ENOKI_CALL_SUPPORT_TEMPLATE_BEGIN(mitsuba::Medium)
     ENOKI_CALL_SUPPORT_METHOD(intersect_aabb)
     ENOKI_CALL_SUPPORT_METHOD(sample_interaction)
     ENOKI_CALL_SUPPORT_METHOD(eval_tr_and_pdf)
+    ENOKI_CALL_SUPPORT_METHOD(eval_transmittance)
     ENOKI_CALL_SUPPORT_METHOD(get_scattering_coefficients)
 ENOKI_CALL_SUPPORT_TEMPLATE_END(mitsuba::Medium)
 
@@ -195,6 +195,28 @@ public:
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /**
+     * \brief Has the geometry changed since the last call to \ref clear_dirty()?
+     *
+     * This flag is set by \ref parameters_changed() when the vertex positions
+     * or faces were modified, and it is used by the scene to determine
+     * whether its acceleration data structure must be updated.
+     */
+    bool dirty() const { return m_dirty; }
+
+    /// Clear the flag returned by \ref dirty()
+    void clear_dirty() { m_dirty = false; }
+
+    /**
+     * \brief Release the flat copies of the geometry that \ref traverse()
+     * exports in CPU variants
+     *
+     * The copies are otherwise kept until \ref parameters_changed() is
+     * called. Callers that traversed the mesh without modifying its geometry
+     * can use this function to avoid keeping a second copy of it.
+     */
+    void release_buffers();
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -249,8 +271,27 @@ public:
                 p1 = vertex_position(fi[1]),
                 p2 = vertex_position(fi[2]);
 
-        Vector3f e1 = p1 - p0, e2 = p2 - p0;
+        return ray_intersect_triangle_edges(p0, p1 - p0, p2 - p0, ray, active);
+    }
 
+    /** \brief Ray-triangle intersection test based on a vertex position and
+     * two precomputed edge vectors
+     *
+     * This is the kernel used by \ref ray_intersect_triangle(). It is also
+     * called directly by acceleration data structures that cache the
+     * triangle data in an intersection-friendly layout.
+     *
+     * \param p0
+     *    Position of the first vertex
+     * \param e1
+     *    Edge vector from the first to the second vertex
+     * \param e2
+     *    Edge vector from the first to the third vertex
+     */
+    static MTS_INLINE std::tuple<Mask, Float, Float, Float>
+    ray_intersect_triangle_edges(const Point3f &p0, const Vector3f &e1,
+                                 const Vector3f &e2, const Ray3f &ray,
+                                 identity_t<Mask> active = true) {
         Vector3f pvec = cross(ray.d, e2);
         Float inv_det = rcp(dot(e1, pvec));
 
@@ -268,6 +309,14 @@ public:
         return { active, u, v, t };
     }
 
+    /**
+     * \brief Expose the parameters of the mesh
+     *
+     * On CPU variants, this creates flat copies of the face indices and
+     * vertex attributes (\c faces_buf, \c vertex_positions_buf, ...). They
+     * are written back and released by \ref parameters_changed(), hence the
+     * mesh must be traversed again to access the geometry after an update.
+     */
     void traverse(TraversalCallback *callback) override;
 
     void parameters_changed() override;
@@ -308,6 +357,15 @@ protected:
             const_cast<Mesh *>(this)->area_distr_build();
     }
 
+    /// Copy the vertex and face data into the flat buffers exposed by \ref traverse() (CPU)
+    void buffers_export();
+
+    /// Write the (possibly modified) flat buffers back into the mesh (CPU)
+    void buffers_import();
+
+    /// Expose the flat buffers to a \ref TraversalCallback (CPU)
+    void traverse_cpu(TraversalCallback *callback);
+
     MTS_DECLARE_CLASS()
 protected:
     VertexHolder m_vertices;
@@ -352,6 +410,18 @@ protected:
     std::unique_ptr<OptixData> m_optix;
 #endif
 
+    /* Flat copies of the vertex and face data that are exposed via \ref
+       traverse() on CPU variants, and which are written back into the
+       interleaved buffers above by \ref parameters_changed(). They only
+       exist between these two calls. */
+    DynamicBuffer<Float> m_vertex_positions_buf;
+    DynamicBuffer<Float> m_vertex_normals_buf;
+    DynamicBuffer<Float> m_vertex_texcoords_buf;
+    DynamicBuffer<UInt32> m_faces_buf;
+
+    /// Set when the geometry was modified, see \ref dirty()
+    bool m_dirty = false;
+
     /// Flag that can be set by the user to disable loading/computation of vertex normals
     bool m_disable_vertex_normals = false;
 
@@ -43,6 +43,9 @@ public:
     /// Return the number of samples per pixel
     size_t sample_count() const { return m_sample_count; }
 
+    /// Set the number of samples per pixel
+    virtual void set_sample_count(size_t sample_count) { m_sample_count = sample_count; }
+
     /// Return the size of the wavefront (or 0, if not seeded)
     virtual size_t wavefront_size() const = 0;
 
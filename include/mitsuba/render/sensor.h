@@ -113,6 +113,7 @@ public:
     // =============================================================
 
     void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
         callback->put_parameter("shutter_open", m_shutter_open);
         callback->put_parameter("shutter_open_time", m_shutter_open_time);
         callback->put_object("film", m_film.get());
@@ -120,6 +121,7 @@ public:
     }
 
     void parameters_changed() override {
+        Base::parameters_changed();
         m_aspect = m_film->size().x() / (ScalarFloat) m_film->size().y();
         m_resolution = ScalarVector2f(m_film->crop_size());
     }
@@ -136,6 +136,15 @@ public:
      */
     virtual ScalarFloat mean() const;
 
+    /**
+     * \brief Does the texture filter its lookups based on the ray footprint?
+     *
+     * Such textures rely on the UV partials of the surface interaction (see
+     * \ref SurfaceInteraction::footprint()), hence BSDFs using them should
+     * request differentials via \ref BSDFFlags::NeedsDifferentials.
+     */
+    virtual bool needs_differentials() const { return false; }
+
     //! @}
     // ======================================================================
 
@@ -185,6 +194,15 @@ public:
     /// Returns the maximum value of the texture over all dimensions.
     virtual ScalarFloat max() const;
 
+    /**
+     * \brief Returns a lower bound on the values of the texture over all
+     * dimensions.
+     *
+     * The default implementation returns zero, which is a valid bound for
+     * all non-negative textures.
+     */
+    virtual ScalarFloat min() const;
+
     /// Returns the bounding box of the 3d texture
     ScalarBoundingBox3f bbox() const { return m_bbox; }
 
@@ -22,6 +22,7 @@ struct VolumeMetadata {
     Transform4f transform;
 
     double mean = 0.;
+    float min;
     float max;
 };
 
@@ -75,12 +75,19 @@ public:
     }
 
     void parameters_changed() override {
+        /* The kd-tree only evaluates the alpha test of the outermost BSDF.
+           Nested BSDFs must account for their transparency while shading,
+           weighted by the blend factor like the rest of their response. */
         m_components.clear();
-        for (size_t i = 0; i < 2; ++i)
+        for (size_t i = 0; i < 2; ++i) {
+            m_nested_bsdf[i]->disable_alpha_test();
             for (size_t j = 0; j < m_nested_bsdf[i]->component_count(); ++j)
                 m_components.push_back(m_nested_bsdf[i]->flags(j));
+        }
 
         m_flags = m_nested_bsdf[0]->flags() | m_nested_bsdf[1]->flags();
+        if (m_weight->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -212,6 +212,10 @@ public:
         } else {
             std::tie(m_eta, m_k) = complex_ior_from_file<Spectrum, Texture>(props.string("material", "Cu"));
         }
+
+        if (m_specular_reflectance->needs_differentials() ||
+            m_eta->needs_differentials() || m_k->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -73,6 +73,9 @@ public:
         m_reflectance = props.texture<Texture>("reflectance", .5f);
         m_flags = BSDFFlags::DiffuseReflection | BSDFFlags::FrontSide;
         m_components.push_back(m_flags);
+
+        if (m_reflectance->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
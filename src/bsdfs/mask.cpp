@@ -1,4 +1,5 @@
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/render/bsdf.h>
@@ -20,6 +21,16 @@ Opacity mask (:monosp:`mask`)
  * - (Nested plugin)
    - |bsdf|
    - A base BSDF model that represents the non-transparent portion of the scattering
+ * - alpha_test
+   - |string|
+   - Specifies how transparency is resolved. The options are :monosp:`none` (null scattering
+     events that are handled by the integrator), :monosp:`threshold` (deterministic test during
+     ray traversal), and :monosp:`stochastic` (randomized test during ray traversal).
+     (Default: :monosp:`none`)
+ * - alpha_threshold
+   - |float|
+   - Opacity below which surfaces are considered to be transparent when
+     :monosp:`alpha_test=threshold`. (Default: 0.5)
 
 .. subfigstart::
 .. subfigure:: ../../resources/data/docs/images/render/bsdf_mask_before.jpg
@@ -37,6 +48,20 @@ Note that the standard :ref:`path tracer <integrator-path>` does not have a good
 but the (:ref:`volumetric path tracer <integrator-volpath>`) does. It may thus be preferable when rendering
 scenes that contain the :ref:`mask <bsdf-mask>` plugin, even if there is nothing *volumetric* in the scene.
 
+Scenes with large amounts of alpha-masked geometry (e.g. foliage) render considerably faster
+when the :monosp:`alpha_test` parameter is specified. The opacity is then already evaluated
+while the kd-tree is traversed, and transparent hits are skipped without terminating the
+traversal. This also applies to shadow rays, which otherwise treat masked surfaces as
+opaque. With :monosp:`alpha_test=threshold`, surfaces are either fully opaque or fully
+transparent depending on whether the opacity exceeds :monosp:`alpha_threshold`. With
+:monosp:`alpha_test=stochastic`, intersections are accepted with a probability equal to
+the opacity, which converges to the same result as the default mode. In both cases, the
+surviving intersections are shaded using the nested BSDF alone. Alpha testing requires the
+kd-tree of the CPU variants and falls back to the default mode otherwise. It also falls
+back to the default mode when the mask is nested within another BSDF (e.g. a
+:ref:`blended material <bsdf-blendbsdf>`), since only the BSDF that is directly attached
+to a shape is queried during traversal.
+
 The following XML snippet describes a material configuration for a transparent leaf:
 
 .. code-block:: xml
@@ -62,7 +87,7 @@ The following XML snippet describes a material configuration for a transparent l
 template <typename Float, typename Spectrum>
 class MaskBSDF final : public BSDF<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(BSDF, component_count, m_components, m_flags)
+    MTS_IMPORT_BASE(BSDF, component_count, has_alpha_test, m_components, m_flags)
     MTS_IMPORT_TYPES(Texture)
 
     MaskBSDF(const Properties &props) : Base(props) {
@@ -80,10 +105,36 @@ public:
         if (!m_nested_bsdf)
            Throw("Child BSDF not specified");
 
+        std::string alpha_test = string::to_lower(props.string("alpha_test", "none"));
+        if (alpha_test == "none")
+            m_alpha_mode = AlphaMode::None;
+        else if (alpha_test == "threshold")
+            m_alpha_mode = AlphaMode::Threshold;
+        else if (alpha_test == "stochastic")
+            m_alpha_mode = AlphaMode::Stochastic;
+        else
+            Throw("The \"alpha_test\" parameter must be equal to either \"none\", "
+                  "\"threshold\", or \"stochastic\"!");
+        m_alpha_threshold = props.float_("alpha_threshold", 0.5f);
+
+#if defined(MTS_ENABLE_EMBREE)
+        bool kdtree_available = false;
+#else
+        bool kdtree_available = !is_cuda_array_v<Float>;
+#endif
+        if (m_alpha_mode != AlphaMode::None && !kdtree_available) {
+            Log(Warn, "Alpha testing requires the kd-tree ray tracing backend, "
+                      "falling back to null scattering.");
+            m_alpha_mode = AlphaMode::None;
+        }
+
         parameters_changed();
     }
 
     void parameters_changed() override {
+        // Only the alpha test of the outermost BSDF is evaluated by the kd-tree
+        m_nested_bsdf->disable_alpha_test();
+
         m_components.clear();
         for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
             m_components.push_back(m_nested_bsdf->flags(i));
@@ -91,6 +142,10 @@ public:
         // The "transmission" BSDF component is at the last index.
         m_components.push_back(BSDFFlags::Null | BSDFFlags::FrontSide | BSDFFlags::BackSide);
         m_flags = m_nested_bsdf->flags() | m_components.back();
+        if (m_opacity->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
+        if (m_alpha_mode != AlphaMode::None)
+            m_flags = m_flags | BSDFFlags::AlphaTest;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -158,10 +213,41 @@ public:
         return result;
     }
 
+    Mask alpha_test(const SurfaceInteraction3f &si, Mask active) const override {
+        Float opacity = clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
+
+        if (m_alpha_mode == AlphaMode::Threshold)
+            return opacity >= m_alpha_threshold;
+        else if (m_alpha_mode == AlphaMode::Stochastic)
+            return alpha_sample(si) < opacity;
+        else
+            return true;
+    }
+
     MTS_INLINE Float eval_opacity(const SurfaceInteraction3f &si, Mask active) const {
+        // Transparent hits were already skipped during ray traversal
+        if (has_alpha_test())
+            return 1.f;
         return clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
     }
 
+    /**
+     * Uniform variate for the stochastic alpha test. The traversal has no
+     * access to a sampler, hence the variate is obtained by hashing the
+     * position and direction of the ray, which decorrelates the decisions
+     * made for different rays passing through the same point.
+     */
+    MTS_INLINE Float alpha_sample(const SurfaceInteraction3f &si) const {
+        auto bits = [](const Float &value) {
+            return UInt32(reinterpret_array<uint_array_t<Float>>(value));
+        };
+
+        Vector3f d = si.to_world(si.wi);
+        UInt32 h = sample_tea_32(bits(si.p.x()), bits(d.x()));
+        h = sample_tea_32(h ^ bits(si.p.y()), bits(d.y()));
+        return Float(sample_tea_float32(h ^ bits(si.p.z()), bits(d.z())));
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("opacity", m_opacity.get());
         callback->put_object("nested_bsdf", m_nested_bsdf.get());
@@ -171,15 +257,29 @@ public:
         std::ostringstream oss;
         oss << "Mask[" << std::endl
             << "  opacity = " << m_opacity << "," << std::endl
+            << "  alpha_test = " << alpha_mode_name() << "," << std::endl
             << "  nested_bsdf = " << string::indent(m_nested_bsdf->to_string()) << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
+private:
+    enum class AlphaMode { None, Threshold, Stochastic };
+
+    const char *alpha_mode_name() const {
+        switch (m_alpha_mode) {
+            case AlphaMode::Threshold:  return "threshold";
+            case AlphaMode::Stochastic: return "stochastic";
+            default:                    return "none";
+        }
+    }
+
 private:
     ref<Texture> m_opacity;
     ref<Base> m_nested_bsdf;
+    AlphaMode m_alpha_mode;
+    ScalarFloat m_alpha_threshold;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(MaskBSDF, BSDF)
@@ -157,6 +157,10 @@ public:
         m_components.push_back(BSDFFlags::DiffuseReflection | BSDFFlags::FrontSide);
         m_flags = m_components[0] | m_components[1];
 
+        if (m_diffuse_reflectance->needs_differentials() ||
+            (m_specular_reflectance && m_specular_reflectance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
+
         parameters_changed();
     }
 
@@ -70,6 +70,9 @@ public:
 
         m_flags = BSDFFlags::FrontSide | BSDFFlags::BackSide | BSDFFlags::Null;
         m_components.push_back(m_flags);
+
+        if (m_theta->needs_differentials() || m_transmittance->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
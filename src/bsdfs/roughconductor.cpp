@@ -195,6 +195,11 @@ public:
 
         m_components.clear();
         m_components.push_back(m_flags);
+
+        if (m_alpha_u->needs_differentials() || m_alpha_v->needs_differentials() ||
+            m_eta->needs_differentials() || m_k->needs_differentials() ||
+            (m_specular_reflectance && m_specular_reflectance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
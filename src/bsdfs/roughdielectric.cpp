@@ -193,6 +193,11 @@ public:
                                BSDFFlags::BackSide | BSDFFlags::NonSymmetric | extra);
         m_flags = m_components[0] | m_components[1];
 
+        if (m_alpha_u->needs_differentials() || m_alpha_v->needs_differentials() ||
+            (m_specular_reflectance && m_specular_reflectance->needs_differentials()) ||
+            (m_specular_transmittance && m_specular_transmittance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
+
         parameters_changed();
     }
 
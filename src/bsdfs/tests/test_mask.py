@@ -0,0 +1,151 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def test01_create(variant_scalar_rgb):
+    from mitsuba.render import BSDFFlags, has_flag
+    from mitsuba.core.xml import load_string
+
+    bsdf = load_string("""<bsdf version="2.0.0" type="mask">
+        <bsdf type="diffuse"/>
+    </bsdf>""")
+    assert bsdf is not None
+    assert bsdf.component_count() == 2
+    assert not bsdf.has_alpha_test()
+
+    bsdf = load_string("""<bsdf version="2.0.0" type="mask">
+        <string name="alpha_test" value="threshold"/>
+        <bsdf type="diffuse"/>
+    </bsdf>""")
+    assert bsdf.has_alpha_test()
+    assert has_flag(bsdf.flags(), BSDFFlags.AlphaTest)
+
+    with pytest.raises(Exception) as e:
+        load_string("""<bsdf version="2.0.0" type="mask">
+            <string name="alpha_test" value="invalid"/>
+            <bsdf type="diffuse"/>
+        </bsdf>""")
+    e.match('"alpha_test" parameter')
+
+
+@pytest.mark.parametrize("opacity", [0.2, 0.8])
+def test02_alpha_test_traversal(variant_scalar_rgb, opacity):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # A masked rectangle in front of an opaque one
+    scene = load_string("""<scene version="2.0.0">
+        <shape type="rectangle">
+            <bsdf type="mask">
+                <string name="alpha_test" value="threshold"/>
+                <float name="opacity" value="{}"/>
+                <bsdf type="diffuse"/>
+            </bsdf>
+        </shape>
+        <shape type="rectangle">
+            <transform name="to_world">
+                <translate z="-1"/>
+            </transform>
+        </shape>
+    </scene>""".format(opacity))
+
+    ray = Ray3f([0, 0, 1], [0, 0, -1], 0.0, [])
+    si = scene.ray_intersect(ray)
+    assert si.is_valid()
+    assert ek.allclose(si.t, 1.0 if opacity > 0.5 else 2.0)
+    assert scene.ray_test(ray)
+
+    # Without the opaque rectangle, shadow rays only see the masked one
+    ray.maxt = 1.5
+    assert scene.ray_test(ray) == (opacity > 0.5)
+
+
+@pytest.mark.parametrize("alpha_test", ["threshold", "stochastic"])
+def test03_nested_alpha_test(variant_scalar_rgb, alpha_test):
+    from mitsuba.core import Frame3f, Ray3f
+    from mitsuba.core.math import InvPi
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import BSDFContext, SurfaceInteraction3f
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    bsdf_xml = """<bsdf type="blendbsdf">
+        <float name="weight" value="0.5"/>
+        <bsdf type="diffuse">
+            <spectrum name="reflectance" value="0.0"/>
+        </bsdf>
+        <bsdf type="mask">
+            <string name="alpha_test" value="{}"/>
+            <float name="opacity" value="0.2"/>
+            <bsdf type="diffuse">
+                <spectrum name="reflectance" value="1.0"/>
+            </bsdf>
+        </bsdf>
+    </bsdf>""".format(alpha_test)
+
+    # Only the outermost BSDF is alpha tested: the mask falls back to
+    # null scattering and keeps its transparency
+    bsdf = load_string(bsdf_xml.replace('<bsdf type="blendbsdf">',
+                                        '<bsdf version="2.0.0" type="blendbsdf">'))
+    assert not bsdf.has_alpha_test()
+
+    si = SurfaceInteraction3f()
+    si.t = 0.1
+    si.p = [0, 0, 0]
+    si.n = [0, 0, 1]
+    si.sh_frame = Frame3f(si.n)
+    si.wi = [0, 0, 1]
+
+    value = bsdf.eval(BSDFContext(), si, [0, 0, 1])
+    assert ek.allclose(value, 0.5 * 0.2 * InvPi)
+
+    # The blended surface is never skipped during traversal
+    scene = load_string("""<scene version="2.0.0">
+        <shape type="rectangle">
+            {}
+        </shape>
+    </scene>""".format(bsdf_xml))
+
+    for i in range(16):
+        ray = Ray3f([-0.9 + i * 0.12, 0.3, 1], [0, 0, -1], 0.0, [])
+        si = scene.ray_intersect(ray)
+        assert si.is_valid() and ek.allclose(si.t, 1.0)
+        assert scene.ray_test(ray)
+
+
+def test04_stochastic_alpha_test(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    opacity = 0.3
+    scene = load_string("""<scene version="2.0.0">
+        <shape type="rectangle">
+            <bsdf type="mask">
+                <string name="alpha_test" value="stochastic"/>
+                <float name="opacity" value="{}"/>
+                <bsdf type="diffuse"/>
+            </bsdf>
+        </shape>
+    </scene>""".format(opacity))
+
+    # The fraction of accepted intersections matches the opacity, and shadow
+    # rays make the same decision as regular rays
+    n = 64
+    hits = 0
+    for i in range(n):
+        for j in range(n):
+            o = [-0.95 + 1.9 * (i + 0.5) / n, -0.95 + 1.9 * (j + 0.5) / n, 1]
+            ray = Ray3f(o, [0, 0, -1], 0.0, [])
+            hit = scene.ray_intersect(ray).is_valid()
+            assert scene.ray_test(ray) == hit
+            hits += int(hit)
+
+    assert abs(hits / (n * n) - opacity) < 0.03
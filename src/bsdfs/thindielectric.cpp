@@ -97,6 +97,10 @@ public:
                                BSDFFlags::BackSide);
         m_components.push_back(BSDFFlags::Null | BSDFFlags::FrontSide | BSDFFlags::BackSide);
         m_flags = m_components[0] | m_components[1];
+
+        if ((m_specular_reflectance && m_specular_reflectance->needs_differentials()) ||
+            (m_specular_transmittance && m_specular_transmittance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
@@ -74,6 +74,8 @@ public:
         if (!m_brdf[1])
             m_brdf[1] = m_brdf[0];
 
+        parameters_changed();
+
         // Add all nested components, overwriting any front / back side flag.
         for (size_t i = 0; i < m_brdf[0]->component_count(); ++i) {
             auto c = (m_brdf[0]->flags(i) & ~BSDFFlags::BackSide);
@@ -89,6 +91,10 @@ public:
 
         if (has_flag(m_flags, BSDFFlags::Transmission))
             Throw("Only materials without a transmission component can be nested!");
+
+        // Differentials are a property of the nested BSDFs, not of their components
+        if (m_brdf[0]->needs_differentials() || m_brdf[1]->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
     }
 
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx_,
@@ -180,6 +186,12 @@ public:
         return result;
     }
 
+    void parameters_changed() override {
+        // Only the alpha test of the outermost BSDF is evaluated by the kd-tree
+        m_brdf[0]->disable_alpha_test();
+        m_brdf[1]->disable_alpha_test();
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("brdf_0", m_brdf[0].get());
         callback->put_object("brdf_1", m_brdf[1].get());
@@ -5,6 +5,7 @@
 #include <mitsuba/core/distr_2d.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/scene.h>
+#include <mitsuba/render/shape.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
 
@@ -28,6 +29,15 @@ Environment emitter (:monosp:`envmap`)
  * - to_world
    - |transform|
    - Specifies an optional emitter-to-world transformation.  (Default: none, i.e. emitter space = world space)
+ * - (Nested plugin)
+   - |shape|
+   - Optional portals (e.g. :monosp:`rectangle` shapes covering the windows of an interior)
+     through which the environment is visible. Direction sampling is then concentrated on
+     directions passing through these openings.
+ * - portal_fraction
+   - |Float|
+   - Fraction of the samples that are generated through the portals when any are specified.
+     The remaining samples follow the luminance of the environment map. (Default: 0.9)
 
 This plugin provides a HDRI (high dynamic range imaging) environment map,
 which is a type of light source that is well-suited for representing "natural"
@@ -54,6 +64,30 @@ High quality free light probes are available on
 `Paul Debevec's <http://gl.ict.usc.edu/Data/HighResProbes>`_ and
 `Bernhard Vogl's <http://dativ.at/lightprobes/>`_ websites.
 
+In interior scenes that are only lit through a few openings (windows, doors),
+most directions sampled from the luminance of the environment map are occluded.
+In this case, the openings can be marked as *portals* by nesting shapes (usually
+rectangles) into the emitter. Portals are not part of the scene geometry and
+only serve to guide the sampling of the emitter: a fraction of the samples picks
+a uniformly distributed point on one of the portals (chosen proportional to its
+surface area), while the remaining samples follow the luminance of the
+environment map, which keeps small and bright features (e.g. the sun) that are
+visible through the openings well-sampled. Portals must cover all openings
+through which the environment can be seen from the shaded points of the scene,
+and the shapes must support ray intersection queries.
+
+.. code-block:: xml
+
+    <emitter type="envmap">
+        <string name="filename" value="sky.exr"/>
+        <shape type="rectangle">
+            <transform name="to_world">
+                <scale x="0.8" y="1.2"/>
+                <translate x="2" y="1.5" z="-3"/>
+            </transform>
+        </shape>
+    </emitter>
+
  */
 
 template <typename Float, typename Spectrum>
@@ -119,11 +153,38 @@ public:
 
         m_scale = props.float_("scale", 1.f);
         m_warp = Warp(luminance.get(), m_resolution);
+
+        // Nested shapes act as portals
+        ScalarFloat portal_area = 0.f;
+        m_portal_cdf.push_back(0.f);
+        for (auto &kv : props.objects()) {
+            Shape *shape = dynamic_cast<Shape *>(kv.second.get());
+            if (!shape)
+                continue;
+            m_portals.push_back(shape);
+            portal_area += shape->surface_area();
+            m_portal_cdf.push_back(portal_area);
+        }
+
+        m_portal_fraction = props.float_("portal_fraction", .9f);
+        if (m_portal_fraction < 0.f || m_portal_fraction > 1.f)
+            Throw("\"portal_fraction\" must be in the range [0, 1]!");
+
+        if (!m_portals.empty()) {
+            if (!(portal_area > 0.f))
+                Throw("The portals of an environment map must have a nonzero surface area!");
+            for (ScalarFloat &value : m_portal_cdf)
+                value /= portal_area;
+            m_portal_cdf.back() = 1.f;
+        } else {
+            m_portal_fraction = 0.f;
+        }
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
     }
 
     void parameters_changed() override {
+        Base::parameters_changed();
         m_data.managed();
 
         std::unique_ptr<ScalarFloat[]> luminance(new ScalarFloat[hprod(m_resolution)]);
@@ -186,10 +247,18 @@ public:
     }
 
     std::pair<DirectionSample3f, Spectrum>
-    sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
+    sample_direction(const Interaction3f &it, const Point2f &sample_, Mask active) const override {
         MTS_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
 
-        auto [uv, pdf] = m_warp.sample(sample);
+        Transform4f trafo = m_world_transform->eval(it.time, active);
+
+        // Decide between sampling through a portal and following the luminance
+        Point2f sample = sample_;
+        Mask portal = active && sample.x() < m_portal_fraction;
+        masked(sample.x(), portal)  = sample.x() / m_portal_fraction;
+        masked(sample.x(), !portal) = (sample.x() - m_portal_fraction) / (1.f - m_portal_fraction);
+
+        auto [uv, pdf] = m_warp.sample(sample, nullptr, active && !portal);
 
         Float theta = uv.y() * math::Pi<Float>,
               phi = uv.x() * (2.f * math::Pi<Float>);
@@ -201,15 +270,27 @@ public:
 
         Float inv_sin_theta =
             safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
+        pdf = select(pdf > 0.f, pdf * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>))), 0.f);
+
+        d = trafo.transform_affine(d);
 
-        d = m_world_transform->eval(it.time, active).transform_affine(d);
+        if (!m_portals.empty()) {
+            if (any_or<true>(portal)) {
+                masked(d, portal) = sample_portal(it, sample, portal);
+                Vector3f local = trafo.inverse().transform_affine(d);
+                masked(uv, portal)  = direction_to_uv(local);
+                masked(pdf, portal) = luminance_pdf(local, portal);
+            }
+            pdf = fmadd(m_portal_fraction, portal_pdf(it, d, active),
+                        (1.f - m_portal_fraction) * pdf);
+        }
 
         DirectionSample3f ds;
         ds.p      = it.p + d * dist;
         ds.n      = -d;
         ds.uv     = uv;
         ds.time   = it.time;
-        ds.pdf = select(pdf > 0.f, pdf * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>))), 0.f);
+        ds.pdf    = pdf;
         ds.delta  = false;
         ds.object = this;
         ds.d      = d;
@@ -229,14 +310,11 @@ public:
                          .inverse()
                          .transform_affine(ds.d);
 
-        /* Convert to latitude-longitude texture coordinates */
-        Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
-                             safe_acos(d.y()) * math::InvPi<Float>);
-        uv -= floor(uv);
-
-        Float inv_sin_theta =
-            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
-        return m_warp.eval(uv) * inv_sin_theta * (1.f / (2.f * sqr(math::Pi<Float>)));
+        Float pdf = luminance_pdf(d, active);
+        if (!m_portals.empty())
+            pdf = fmadd(m_portal_fraction, portal_pdf(it, ds.d, active),
+                        (1.f - m_portal_fraction) * pdf);
+        return pdf;
     }
 
     ScalarBoundingBox3f bbox() const override {
@@ -246,6 +324,7 @@ public:
     }
 
     void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
         callback->put_parameter("scale", m_scale);
         callback->put_parameter("data", m_data);
         callback->put_parameter("resolution", m_resolution);
@@ -256,12 +335,61 @@ public:
         oss << "EnvironmentMapEmitter[" << std::endl
             << "  filename = \"" << m_filename << "\"," << std::endl
             << "  resolution = \"" << m_resolution << "\"," << std::endl
-            << "  bsphere = " << m_bsphere << std::endl
+            << "  bsphere = " << m_bsphere << "," << std::endl
+            << "  portals = " << m_portals.size() << "," << std::endl
+            << "  portal_fraction = " << m_portal_fraction << std::endl
             << "]";
         return oss.str();
     }
 
 protected:
+    /// Convert a direction in emitter space to latitude-longitude texture coordinates
+    Point2f direction_to_uv(const Vector3f &d) const {
+        Point2f uv = Point2f(atan2(d.x(), -d.z()) * math::InvTwoPi<Float>,
+                             safe_acos(d.y()) * math::InvPi<Float>);
+        return uv - floor(uv);
+    }
+
+    /// Solid angle density of luminance-based sampling for a direction in emitter space
+    Float luminance_pdf(const Vector3f &d, Mask active) const {
+        Float inv_sin_theta =
+            safe_rsqrt(max(sqr(d.x()) + sqr(d.z()), sqr(math::Epsilon<Float>)));
+        return m_warp.eval(direction_to_uv(d), nullptr, active) * inv_sin_theta *
+               (1.f / (2.f * sqr(math::Pi<Float>)));
+    }
+
+    /// Sample a (world space) direction towards a point on one of the portals
+    Vector3f sample_portal(const Interaction3f &it, const Point2f &sample, Mask active) const {
+        Point3f p = zero<Point3f>();
+        for (size_t i = 0; i < m_portals.size(); ++i) {
+            ScalarFloat cdf_0 = m_portal_cdf[i], cdf_1 = m_portal_cdf[i + 1];
+            Mask selected = active && sample.x() >= cdf_0 &&
+                            (sample.x() < cdf_1 || i + 1 == m_portals.size());
+            if (cdf_1 == cdf_0 || none_or<false>(selected))
+                continue;
+            Point2f sample_i((sample.x() - cdf_0) / (cdf_1 - cdf_0), sample.y());
+            masked(p, selected) = m_portals[i]->sample_position(it.time, sample_i, selected).p;
+        }
+        return normalize(p - it.p);
+    }
+
+    /// Solid angle density of sampling the (world space) direction \c d through the portals
+    Float portal_pdf(const Interaction3f &it, const Vector3f &d, Mask active) const {
+        Ray3f ray(it.p, d, it.time, it.wavelengths);
+        Float pdf = 0.f;
+        for (size_t i = 0; i < m_portals.size(); ++i) {
+            SurfaceInteraction3f si = m_portals[i]->ray_intersect(ray, active);
+            Mask hit = active && si.is_valid();
+            if (none_or<false>(hit))
+                continue;
+            Float dp = abs_dot(d, si.n);
+            Float pdf_area = (m_portal_cdf[i + 1] - m_portal_cdf[i]) *
+                             m_portals[i]->pdf_position(PositionSample3f(si), hit);
+            masked(pdf, hit && neq(dp, 0.f)) += pdf_area * sqr(si.t) / dp;
+        }
+        return pdf;
+    }
+
     UnpolarizedSpectrum eval_spectrum(Point2f uv, const Wavelength &wavelengths, Mask active) const {
         uv *= Vector2f(m_resolution - 1u);
 
@@ -323,6 +451,10 @@ protected:
     Warp m_warp;
     ref<Texture> m_d65;
     ScalarFloat m_scale;
+    std::vector<ref<Shape>> m_portals;
+    /// Discrete CDF for choosing a portal proportional to its surface area
+    std::vector<ScalarFloat> m_portal_cdf;
+    ScalarFloat m_portal_fraction;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(EnvironmentMapEmitter, Emitter)
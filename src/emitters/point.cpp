@@ -36,7 +36,7 @@ uniformly radiates illumination into all directions.
 template <typename Float, typename Spectrum>
 class PointLight final : public Emitter<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Emitter, m_flags, m_medium, m_needs_sample_3, m_world_transform)
+    MTS_IMPORT_BASE(Emitter, m_flags, m_medium, m_needs_sample_3, m_world_transform, m_to_world)
     MTS_IMPORT_TYPES(Scene, Shape, Texture)
 
     PointLight(const Properties &props) : Base(props) {
@@ -45,8 +45,8 @@ public:
                 Throw("Only one of the parameters 'position' and 'to_world' "
                       "can be specified at the same time!'");
 
-            m_world_transform = new AnimatedTransform(
-                ScalarTransform4f::translate(ScalarVector3f(props.point3f("position"))));
+            m_to_world = ScalarTransform4f::translate(ScalarVector3f(props.point3f("position")));
+            m_world_transform = new AnimatedTransform(m_to_world);
         }
 
         m_intensity = props.texture<Texture>("intensity", Texture::D65(1.f));
@@ -108,9 +108,14 @@ public:
     }
 
     void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
         callback->put_object("intensity", m_intensity.get());
     }
 
+    void parameters_changed() override {
+        Base::parameters_changed();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "PointLight[" << std::endl
@@ -0,0 +1,57 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def create_envmap(tmpdir, portal_fraction):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+
+    np.random.seed(1234)
+    filename = str(tmpdir.join('envmap.exr'))
+    Bitmap(np.random.uniform(size=(16, 32, 3)).astype(np.float32)).write(filename)
+
+    # A 1x1 window in the plane z=2
+    return load_string("""<emitter version="2.0.0" type="envmap">
+            <string name="filename" value="{}"/>
+            <float name="portal_fraction" value="{}"/>
+            <shape type="rectangle">
+                <transform name="to_world">
+                    <scale value="0.5"/>
+                    <translate z="2"/>
+                </transform>
+            </shape>
+        </emitter>""".format(filename, portal_fraction))
+
+
+def test01_portal_sampling(variant_scalar_rgb, tmpdir):
+    from mitsuba.render import SurfaceInteraction3f
+
+    emitter = create_envmap(tmpdir, 1.0)
+    it = SurfaceInteraction3f.zero()
+
+    for sample in np.random.uniform(size=(50, 2)):
+        ds, weight = emitter.sample_direction(it, sample)
+        assert ds.pdf > 0
+
+        # All directions pass through the portal
+        p = ds.d * (2 / ds.d.z)
+        assert ds.d.z > 0 and abs(p.x) <= 0.5 + 1e-4 and abs(p.y) <= 0.5 + 1e-4
+
+        # Uniform area sampling: pdf = dist^2 / (cos * area)
+        dist = ek.norm(p)
+        assert ek.allclose(ds.pdf, dist**2 / ds.d.z, rtol=1e-4)
+        assert ek.allclose(emitter.pdf_direction(it, ds), ds.pdf, rtol=1e-4)
+
+
+def test02_mixture_pdf(variant_scalar_rgb, tmpdir):
+    from mitsuba.render import SurfaceInteraction3f
+
+    emitter = create_envmap(tmpdir, 0.5)
+    it = SurfaceInteraction3f.zero()
+
+    for sample in np.random.uniform(size=(50, 2)):
+        ds, weight = emitter.sample_direction(it, sample)
+        assert ds.pdf > 0
+        assert ek.allclose(emitter.pdf_direction(it, ds), ds.pdf, rtol=1e-3)
@@ -1,11 +1,14 @@
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
+#include <atomic>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -45,6 +48,16 @@ High dynamic range film (:monosp:`hdrfilm`)
    - If set to |true|, regions slightly outside of the film plane will also be sampled. This may
      improve the image quality at the edges, especially when using very large reconstruction
      filters. In general, this is not needed though. (Default: |false|, i.e. disabled)
+ * - streaming
+   - |bool|
+   - If set to |true|, the film never stores the complete image in memory. Instead, it writes
+     tiles to a tiled OpenEXR file as soon as they have received all of their samples, which
+     enables gigapixel renderings. Only supported by the OpenEXR file format and CPU variants.
+     (Default: |false|)
+ * - tile_size
+   - |int|
+   - Edge length (in pixels) of the tiles of the OpenEXR file written in streaming mode.
+     (Default: 256)
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -77,6 +90,11 @@ When RGB(A) output is selected, the measured spectral power distributions are
 converted to linear RGB based on the CIE 1931 XYZ color matching curves and
 the ITU-R Rec. BT.709-3 primaries with a D65 white point.
 
+In streaming mode, the film only keeps the tiles in memory that are currently receiving samples.
+The rendering progresses in a spiral pattern, hence this is a narrow band of tiles around the
+region being rendered. In this mode, the film cannot be developed into bitmaps while rendering
+(e.g. for previews), and the file is finalized when the rendering has finished.
+
 The following XML snippet discribes a film that writes a full-HD RGBA OpenEXR file:
 
 .. code-block:: xml
@@ -104,6 +122,11 @@ public:
             props.string("component_format", "float16"));
 
         m_dest_file = props.string("filename", "");
+        m_streaming = props.bool_("streaming", false);
+        int tile_size = props.int_("tile_size", 256);
+        if (tile_size <= 0)
+            Throw("The \"tile_size\" parameter must be positive!");
+        m_streaming_tile_size = (uint32_t) tile_size;
 
         if (file_format == "openexr" || file_format == "exr")
             m_file_format = Bitmap::FileFormat::OpenEXR;
@@ -177,12 +200,23 @@ public:
                 m_component_format = Struct::Type::Float32;
             }
         }
+
+        if (m_streaming) {
+            if (m_file_format != Bitmap::FileFormat::OpenEXR)
+                Throw("Streaming output is only supported by the OpenEXR file format!");
+            if constexpr (is_cuda_array_v<Float>)
+                Throw("Streaming output is not supported by GPU variants!");
+        }
     }
 
     void set_destination_file(const fs::path &dest_file) override {
         m_dest_file = dest_file;
     }
 
+    void set_pass_count(size_t pass_count) override {
+        m_pass_count = std::max(pass_count, (size_t) 1);
+    }
+
     void prepare(const std::vector<std::string> &channels) override {
         std::vector<std::string> channels_sorted = channels;
         channels_sorted.push_back("R");
@@ -194,145 +228,126 @@ public:
                 Throw("Film::prepare(): duplicate channel name \"%s\"", channels[i]);
         }
 
+        m_channels = channels;
+
+        if (m_streaming) {
+            prepare_streaming();
+            return;
+        }
+
         m_storage = new ImageBlock(m_crop_size, channels.size());
         m_storage->set_offset(m_crop_offset);
         m_storage->clear();
-        m_channels = channels;
+
+        // The storage was cleared, hence all tiles must be developed again
+        m_tile_count = (m_crop_size + DirtyTileSize - 1) / DirtyTileSize;
+        size_t tile_count = (size_t) hprod(m_tile_count);
+        m_dirty.reset(new std::atomic<bool>[tile_count]);
+        m_developed_dirty.reset(new std::atomic<bool>[tile_count]);
+        for (size_t i = 0; i < tile_count; ++i)
+            m_dirty[i] = m_developed_dirty[i] = true;
+        m_developed = nullptr;
     }
 
     void put(const ImageBlock *block) override {
+        if (m_streaming) {
+            put_streaming(block);
+            return;
+        }
+
         Assert(m_storage != nullptr);
         m_storage->put(block);
+
+        // Flag the tiles touched by this block (including its border)
+        ScalarPoint2i p0 = block->offset() - block->border_size() - m_crop_offset,
+                      p1 = p0 + block->size() + 2 * block->border_size();
+        p0 = max(p0, 0) / DirtyTileSize;
+        p1 = min((p1 + DirtyTileSize - 1) / DirtyTileSize, m_tile_count);
+
+        for (int y = p0.y(); y < p1.y(); ++y) {
+            for (int x = p0.x(); x < p1.x(); ++x) {
+                size_t index = x + y * m_tile_count.x();
+                m_dirty[index] = m_developed_dirty[index] = true;
+            }
+        }
     }
 
     bool develop(const ScalarPoint2i  &source_offset,
                  const ScalarVector2i &size,
                  const ScalarPoint2i  &target_offset,
                  Bitmap *target) const override {
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
+        if (m_streaming)
+            return false;
         Assert(m_storage != nullptr);
-        (void) source_offset;
-        (void) size;
-        (void) target_offset;
-        (void) target;
-
-#if 0
-        const Bitmap *source = m_storage->bitmap();
-
-        StructConverter cvt(source->struct_(), target->struct_());
-
-        size_t source_bpp = source->bytes_per_pixel();
-        size_t target_bpp = target->bytes_per_pixel();
-
-        const uint8_t *source_data = source->uint8_data()
-            + (source_offset.x() + source_offset.y() * source->width()) * source_bpp;
-        uint8_t *target_data = target->uint8_data()
-            + (target_offset.x() + target_offset.y() * target->width()) * target_bpp;
-
-        if (size.x() == m_crop_size.x() && target->width() == m_storage->width()) {
-            // Develop a connected part of the underlying buffer
-            cvt.convert(size.x() * size.y(), source_data, target_data);
-        } else {
-            // Develop a rectangular subregion
-            for (int i = 0; i < size.y(); ++i) {
-                cvt.convert(size.x(), source_data, target_data);
-                source_data += source->width() * source_bpp;
-                target_data += target->width() * target_bpp;
-            }
-        }
-#endif
-        return true;
-    }
 
-    ref<Bitmap> bitmap(bool raw = false) override {
-        if constexpr (is_cuda_array_v<Float>) {
-            cuda_eval();
-            cuda_sync();
-        }
+        ref<Bitmap> source = storage_bitmap(false),
+                    view   = target_view(target);
 
-        ref<Bitmap> source = new Bitmap(m_channels.size() != 5 ? Bitmap::PixelFormat::MultiChannel
-                                                               : Bitmap::PixelFormat::XYZAW,
-                          struct_type_v<ScalarFloat>, m_storage->size(), m_storage->channel_count(),
-                          (uint8_t *) m_storage->data().managed().data());
+        source->convert(view, source_offset, target_offset, size);
+        return true;
+    }
 
-        if (raw)
-            return source;
+    bool develop_incremental(const ScalarPoint2i  &source_offset,
+                             const ScalarVector2i &size,
+                             const ScalarPoint2i  &target_offset,
+                             Bitmap *target,
+                             std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> *regions =
+                                 nullptr) const override {
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
+        if (m_streaming)
+            return false;
+        Assert(m_storage != nullptr);
 
-        bool has_aovs = m_channels.size() != 5;
+        ref<Bitmap> source = storage_bitmap(false),
+                    view   = target_view(target);
 
-        ref<Bitmap> target = new Bitmap(
-            has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            m_component_format, m_storage->size(),
-            has_aovs ? (m_storage->channel_count() - 1) : 0);
+        develop_dirty(source, view, source_offset, size, target_offset,
+                      m_dirty.get(), regions);
+        return true;
+    }
 
-        if (has_aovs) {
-            for (size_t i = 0, j = 0; i < m_channels.size(); ++i, ++j) {
-                Struct::Field &source_field = source->struct_()->operator[](i),
-                              &dest_field   = target->struct_()->operator[](j);
-
-                switch (i) {
-                    case 0:
-                        dest_field.name = "R";
-                        dest_field.blend = {
-                            {  3.240479f, "X" },
-                            { -1.537150f, "Y" },
-                            { -0.498535f, "Z" }
-                        };
-                        break;
-
-                    case 1:
-                        dest_field.name = "G";
-                        dest_field.blend = {
-                            { -0.969256, "X" },
-                            {  1.875991, "Y" },
-                            {  0.041556, "Z" }
-                        };
-                        break;
-
-                    case 2:
-                        dest_field.name = "B";
-                        dest_field.blend = {
-                            {  0.055648, "X" },
-                            { -0.204043, "Y" },
-                            {  1.057311, "Z" }
-                        };
-                        break;
-
-                    case 4:
-                        source_field.flags |= +Struct::Flags::Weight;
-                        j--;
-                        break;
-
-                    default:
-                        dest_field.name = m_channels[i];
-                        break;
-                }
+    ref<Bitmap> bitmap(bool raw = false) override {
+        if (m_streaming)
+            Throw("HDRFilm::bitmap(): not available in streaming mode, the "
+                  "image is only stored in the output file!");
 
-                source_field.name = m_channels[i];
-            }
-        }
+        ref<Bitmap> source = storage_bitmap(raw);
+        if (raw)
+            return source;
 
+        ref<Bitmap> target = target_bitmap(m_storage->size());
         source->convert(target);
 
         return target;
      };
 
-    void develop() override {
-        if (m_dest_file.empty())
-            Throw("Destination file not specified, cannot develop.");
+    ref<Bitmap> developed_bitmap() override {
+        if (m_streaming)
+            Throw("HDRFilm::developed_bitmap(): not available in streaming mode, "
+                  "the image is only stored in the output file!");
+        Assert(m_storage != nullptr);
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
 
-        fs::path filename = m_dest_file;
-        std::string proper_extension;
-        if (m_file_format == Bitmap::FileFormat::OpenEXR)
-            proper_extension = ".exr";
-        else if (m_file_format == Bitmap::FileFormat::RGBE)
-            proper_extension = ".rgbe";
-        else
-            proper_extension = ".pfm";
+        /* The target already describes how to compute RGB from XYZ for
+           films with AOVs, hence it can be converted into directly */
+        if (!m_developed)
+            m_developed = target_bitmap(m_storage->size());
 
-        std::string extension = string::to_lower(filename.extension().string());
-        if (extension != proper_extension)
-            filename.replace_extension(proper_extension);
+        develop_dirty(storage_bitmap(false), m_developed, ScalarPoint2i(0),
+                      m_crop_size, ScalarPoint2i(0), m_developed_dirty.get());
+
+        return m_developed;
+    }
 
+    void develop() override {
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
+        if (m_streaming) {
+            develop_streaming();
+            return;
+        }
+
+        fs::path filename = destination_path();
         Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
 
         bitmap()->write(filename, m_file_format);
@@ -367,19 +382,397 @@ public:
             << "  file_format = " << m_file_format << "," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
             << "  component_format = " << m_component_format << "," << std::endl
-            << "  dest_file = \"" << m_dest_file << "\"" << std::endl
+            << "  streaming = " << m_streaming << "," << std::endl;
+        if (m_streaming)
+            oss << "  tile_size = " << m_streaming_tile_size << "," << std::endl
+                << "  tiles_written = " << m_stream_tiles_written.load() << "/"
+                << hprod(m_stream_tile_count) << "," << std::endl;
+        oss << "  dest_file = \"" << m_dest_file << "\"" << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 protected:
+    /**
+     * \brief Wrap the film storage into a bitmap (without copying it)
+     *
+     * Unless \c raw is set, the channels of films with AOVs are named and
+     * the weight channel is flagged, so that the result can be converted.
+     */
+    ref<Bitmap> storage_bitmap(bool raw) const {
+        return block_bitmap(m_storage.get(), raw);
+    }
+
+    /// Wrap the contents of an arbitrary image block into a bitmap (see \ref storage_bitmap())
+    ref<Bitmap> block_bitmap(const ImageBlock *block, bool raw) const {
+        if constexpr (is_cuda_array_v<Float>) {
+            cuda_eval();
+            cuda_sync();
+        }
+
+        bool has_aovs = m_channels.size() != 5;
+        uint8_t *data = (uint8_t *) const_cast<ImageBlock *>(block)
+                            ->data().managed().data();
+
+        ref<Bitmap> source = new Bitmap(
+            has_aovs ? Bitmap::PixelFormat::MultiChannel : Bitmap::PixelFormat::XYZAW,
+            struct_type_v<ScalarFloat>, block->size(), block->channel_count(), data);
+
+        if (has_aovs && !raw) {
+            Struct *source_struct = source->struct_();
+            for (size_t i = 0; i < m_channels.size(); ++i) {
+                Struct::Field &field = (*source_struct)[i];
+                field.name = m_channels[i];
+                if (i == 4)
+                    field.flags |= +Struct::Flags::Weight;
+            }
+        }
+
+        return source;
+    }
+
+    /**
+     * \brief Convert the tiles of a region whose entry in \c dirty is set
+     *
+     * Only tiles that are fully covered by the region are marked as clean
+     * afterwards. Horizontally adjacent dirty tiles are converted at once,
+     * and the converted rectangles are appended to \c regions (if given).
+     */
+    void develop_dirty(const Bitmap *source, Bitmap *target,
+                       const ScalarPoint2i  &source_offset,
+                       const ScalarVector2i &size,
+                       const ScalarPoint2i  &target_offset,
+                       std::atomic<bool> *dirty,
+                       std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> *regions =
+                           nullptr) const {
+        ScalarPoint2i region_end = source_offset + size,
+                      t0 = max(source_offset, 0) / DirtyTileSize,
+                      t1 = min((region_end + DirtyTileSize - 1) / DirtyTileSize, m_tile_count);
+
+        auto take_dirty = [&](int x, int y) {
+            std::atomic<bool> &flag = dirty[x + y * m_tile_count.x()];
+            ScalarPoint2i p0 = ScalarPoint2i(x, y) * DirtyTileSize,
+                          p1 = min(p0 + DirtyTileSize, m_crop_size);
+            if (all(p0 >= source_offset && p1 <= region_end))
+                return flag.exchange(false);
+            else
+                return flag.load();
+        };
+
+        for (int y = t0.y(); y < t1.y(); ++y) {
+            int x = t0.x();
+            while (x < t1.x()) {
+                if (!take_dirty(x, y)) {
+                    ++x;
+                    continue;
+                }
+
+                // Merge horizontally adjacent dirty tiles into a single span
+                int x_end = x + 1;
+                while (x_end < t1.x() && take_dirty(x_end, y))
+                    ++x_end;
+
+                ScalarPoint2i p0 = max(ScalarPoint2i(x, y) * DirtyTileSize, source_offset),
+                              p1 = min(ScalarPoint2i(x_end, y + 1) * DirtyTileSize, region_end);
+
+                source->convert(target, p0, target_offset + (p0 - source_offset), p1 - p0);
+                if (regions)
+                    regions->emplace_back(target_offset + (p0 - source_offset), p1 - p0);
+                x = x_end;
+            }
+        }
+    }
+
+    /// Allocate a bitmap of the given size using the output pixel and component format
+    ref<Bitmap> target_bitmap(const ScalarVector2i &size) const {
+        bool has_aovs = m_channels.size() != 5;
+
+        ref<Bitmap> target = new Bitmap(
+            has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
+            m_component_format, size,
+            has_aovs ? (m_channels.size() - 1) : 0);
+
+        if (has_aovs) {
+            Struct *target_struct = target->struct_();
+            for (size_t i = 0, j = 0; i < m_channels.size(); ++i, ++j) {
+                if (i == 4) {
+                    j--;
+                    continue;
+                }
+                (*target_struct)[j].name = i < 3 ? std::string(1, "RGB"[i]) : m_channels[i];
+            }
+            set_rgb_blend(target_struct);
+        }
+
+        return target;
+    }
+
+    /// Return the destination filename with the extension of the file format
+    fs::path destination_path() const {
+        if (m_dest_file.empty())
+            Throw("Destination file not specified, cannot develop.");
+
+        fs::path filename = m_dest_file;
+        std::string proper_extension;
+        if (m_file_format == Bitmap::FileFormat::OpenEXR)
+            proper_extension = ".exr";
+        else if (m_file_format == Bitmap::FileFormat::RGBE)
+            proper_extension = ".rgbe";
+        else
+            proper_extension = ".pfm";
+
+        std::string extension = string::to_lower(filename.extension().string());
+        if (extension != proper_extension)
+            filename.replace_extension(proper_extension);
+
+        return filename;
+    }
+
+    /// Streaming output: a tile of the file which has not been written yet
+    struct StreamingTile {
+        std::mutex mutex;
+        /// Accumulated samples, allocated when the first block arrives
+        ref<ImageBlock> block;
+        /// Area of the merged block interiors that influence this tile
+        size_t coverage = 0;
+        /// Value of \c coverage at which the tile is complete
+        size_t expected = 0;
+        bool written = false;
+    };
+
+    // =============================================================
+    //! @{ \name Streaming output
+    // =============================================================
+
+    /**
+     * \brief Create the output file and the bookkeeping for its tiles
+     *
+     * A pixel receives contributions from all image blocks whose interior
+     * lies within the filter radius. Since the interiors of the blocks
+     * rendered in a pass partition the crop window, a tile has received all
+     * of its samples once the interiors of the blocks merged into it add up
+     * to its area (extended by the filter border and clipped to the crop
+     * window) times the number of passes.
+     */
+    void prepare_streaming() {
+        fs::path filename = destination_path();
+        int ts = (int) m_streaming_tile_size,
+            border = m_filter->border_size();
+
+        m_stream_tile_count = (m_crop_size + ts - 1) / ts;
+        size_t tile_count = (size_t) hprod(m_stream_tile_count);
+        m_stream_tiles.reset(new StreamingTile[tile_count]);
+        m_stream_tiles_written = 0;
+
+        for (int y = 0; y < m_stream_tile_count.y(); ++y) {
+            for (int x = 0; x < m_stream_tile_count.x(); ++x) {
+                ScalarPoint2i p0 = ScalarPoint2i(x, y) * ts,
+                              p1 = min(p0 + ts, m_crop_size);
+                ScalarVector2i extent = min(p1 + border, m_crop_size) -
+                                        max(p0 - border, 0);
+                m_stream_tiles[x + y * m_stream_tile_count.x()].expected =
+                    (size_t) hprod(extent) * m_pass_count;
+            }
+        }
+
+        m_storage = nullptr;
+        m_developed = nullptr;
+        m_dirty.reset();
+        m_developed_dirty.reset();
+
+        Log(Info, "Streaming %ix%i tiles to \"%s\" ..", ts, ts, filename.string());
+        m_writer = new TiledEXRWriter(filename, target_bitmap(ScalarVector2i(1)),
+                                      ScalarVector2u(m_crop_size),
+                                      m_streaming_tile_size);
+    }
+
+    void put_streaming(const ImageBlock *block) {
+        if (!m_writer)
+            Throw("HDRFilm::put(): the film was not prepared, or was already developed!");
+
+        int ts = (int) m_streaming_tile_size,
+            border = m_filter->border_size();
+
+        // Interior and extended region of the block, relative to the crop window
+        ScalarPoint2i i0 = block->offset() - m_crop_offset,
+                      i1 = i0 + block->size(),
+                      e0 = max(i0 - block->border_size(), 0),
+                      e1 = min(i1 + block->border_size(), m_crop_size);
+        i0 = max(i0, 0);
+        i1 = min(i1, m_crop_size);
+
+        if (any(e1 <= e0))
+            return;
+
+        ScalarPoint2i t0 = e0 / ts,
+                      t1 = min((e1 + ts - 1) / ts, m_stream_tile_count);
+
+        for (int y = t0.y(); y < t1.y(); ++y) {
+            for (int x = t0.x(); x < t1.x(); ++x) {
+                StreamingTile &tile = m_stream_tiles[x + y * m_stream_tile_count.x()];
+                ScalarPoint2i p0 = ScalarPoint2i(x, y) * ts,
+                              p1 = min(p0 + ts, m_crop_size);
+
+                // Area of the block's interior that influences this tile
+                ScalarVector2i overlap = max(min(i1, min(p1 + border, m_crop_size)) -
+                                             max(i0, max(p0 - border, 0)), 0);
+
+                std::lock_guard<std::mutex> guard(tile.mutex);
+                if (tile.written) {
+                    Log(Warn, "HDRFilm::put(): tile at %s was already written to "
+                              "disk, ignoring the block!", p0);
+                    continue;
+                }
+
+                if (!tile.block)
+                    tile.block = allocate_tile(p0, p1);
+                tile.block->put(block);
+
+                tile.coverage += (size_t) hprod(overlap);
+                if (tile.coverage >= tile.expected)
+                    write_tile(tile, p0);
+            }
+        }
+    }
+
+    /// Write the remaining (possibly incomplete) tiles and finalize the file
+    void develop_streaming() {
+        if (!m_writer)
+            Throw("HDRFilm::develop(): the film was not prepared, or was already developed!");
+
+        int ts = (int) m_streaming_tile_size;
+        size_t incomplete = 0;
+
+        for (int y = 0; y < m_stream_tile_count.y(); ++y) {
+            for (int x = 0; x < m_stream_tile_count.x(); ++x) {
+                StreamingTile &tile = m_stream_tiles[x + y * m_stream_tile_count.x()];
+                ScalarPoint2i p0 = ScalarPoint2i(x, y) * ts,
+                              p1 = min(p0 + ts, m_crop_size);
+
+                std::lock_guard<std::mutex> guard(tile.mutex);
+                if (tile.written)
+                    continue;
+                if (!tile.block)
+                    tile.block = allocate_tile(p0, p1);
+                write_tile(tile, p0);
+                incomplete++;
+            }
+        }
+
+        if (incomplete > 0)
+            Log(Warn, "HDRFilm::develop(): %i tile%s did not receive all of their samples.",
+                incomplete, incomplete > 1 ? "s" : "");
+
+        Log(Info, "\U00002714  Finished writing \"%s\"", destination_path().string());
+        m_writer->close();
+        m_writer = nullptr;
+        m_stream_tiles.reset();
+    }
+
+    /// Allocate the accumulation buffer of the tile spanning <tt>[p0, p1)</tt>
+    ref<ImageBlock> allocate_tile(const ScalarPoint2i &p0, const ScalarPoint2i &p1) const {
+        ref<ImageBlock> block = new ImageBlock(p1 - p0, m_channels.size(), nullptr,
+                                               true, true, false);
+        block->set_offset(m_crop_offset + p0);
+        block->clear();
+        return block;
+    }
+
+    /// Convert a tile into the output format, write it, and release its memory
+    void write_tile(StreamingTile &tile, const ScalarPoint2i &p0) {
+        ScopedPhase sp(ProfilerPhase::FilmDevelop);
+        ref<Bitmap> target = target_bitmap(tile.block->size());
+        block_bitmap(tile.block.get(), false)->convert(target);
+        m_writer->write_tile(ScalarPoint2u(p0), target);
+        tile.block = nullptr;
+        tile.written = true;
+        m_stream_tiles_written++;
+    }
+
+    //! @}
+    // =============================================================
+
+    /**
+     * \brief Return a bitmap sharing the storage of \c target, whose R, G and
+     * B channels are computed from the XYZ channels of films with AOVs
+     *
+     * The caller's bitmap (and its channel description) is left unchanged.
+     */
+    ref<Bitmap> target_view(Bitmap *target) const {
+        if (m_channels.size() == 5)
+            return target;
+
+        ref<Bitmap> view = new Bitmap(
+            target->pixel_format(), target->component_format(), target->size(),
+            target->pixel_format() == Bitmap::PixelFormat::MultiChannel
+                ? target->channel_count() : 0,
+            target->uint8_data());
+
+        Struct *view_struct = view->struct_();
+        for (size_t i = 0; i < target->channel_count(); ++i)
+            (*view_struct)[i] = (*target->struct_())[i];
+        set_rgb_blend(view_struct);
+
+        return view;
+    }
+
+    /// Compute the R, G and B fields of \c target from the X, Y and Z channels
+    static void set_rgb_blend(Struct *target) {
+        for (auto &field : *target) {
+            if (!field.blend.empty())
+                continue;
+
+            if (field.name == "R")
+                field.blend = {
+                    {  3.240479f, "X" },
+                    { -1.537150f, "Y" },
+                    { -0.498535f, "Z" }
+                };
+            else if (field.name == "G")
+                field.blend = {
+                    { -0.969256, "X" },
+                    {  1.875991, "Y" },
+                    {  0.041556, "Z" }
+                };
+            else if (field.name == "B")
+                field.blend = {
+                    {  0.055648, "X" },
+                    { -0.204043, "Y" },
+                    {  1.057311, "Z" }
+                };
+        }
+    }
+
+protected:
+    /// Edge length (in pixels) of the tiles used to track modified regions
+    static constexpr int DirtyTileSize = 64;
+
     Bitmap::FileFormat m_file_format;
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
     fs::path m_dest_file;
     ref<ImageBlock> m_storage;
     std::vector<std::string> m_channels;
+
+    /// Number of tiles along each dimension and their "modified" flags
+    ScalarVector2i m_tile_count;
+    std::unique_ptr<std::atomic<bool>[]> m_dirty;
+
+    /// Developed image returned by \ref developed_bitmap() and its own "modified" flags
+    ref<Bitmap> m_developed;
+    std::unique_ptr<std::atomic<bool>[]> m_developed_dirty;
+
+    /// Number of times each pixel is covered by the blocks (see \ref set_pass_count())
+    size_t m_pass_count = 1;
+
+    bool m_streaming;
+    uint32_t m_streaming_tile_size;
+    ref<TiledEXRWriter> m_writer;
+    ScalarVector2i m_stream_tile_count = 0;
+    std::unique_ptr<StreamingTile[]> m_stream_tiles;
+    /// Number of tiles written so far (including those written by \ref develop())
+    std::atomic<size_t> m_stream_tiles_written { 0 };
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
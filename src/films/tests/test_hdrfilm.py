@@ -142,3 +142,174 @@ def test03_develop(variant_scalar_rgb, file_format, tmpdir):
             assert ek.allclose(img[:, :, :3], contents[:, :, :3], atol=1e-5)
         # Alpha channel was ignored, alpha and weights should default to 1.0.
         assert ek.allclose(img[:, :, 3:5], 1.0, atol=1e-6)
+
+
+def test04_develop_region(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="100"/>
+            <integer name="height" value="70"/>
+            <rfilter type="box"/>
+        </film>""")
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    np.random.seed(1234)
+    contents = np.random.uniform(size=(70, 100, 5))
+    contents[:, :, 4] = 1.0
+
+    block = ImageBlock(film.size(), 5, film.reconstruction_filter())
+    block.clear()
+    for y in range(70):
+        for x in range(100):
+            block.put([x + 0.5, y + 0.5], contents[y, x, :])
+    film.put(block)
+
+    # Develop a subregion into an offset position of the target
+    target = Bitmap(Bitmap.PixelFormat.XYZA, Struct.Type.Float32, [40, 30])
+    target_np = np.array(target, copy=False)
+    target_np[:] = -1
+    assert film.develop([50, 20], [30, 25], [5, 3], target)
+
+    ref = -np.ones((30, 40, 4))
+    ref[3:28, 5:35, :] = contents[20:45, 50:80, :4]
+    assert np.allclose(target_np, ref, atol=1e-5)
+
+    # The first incremental develop converts the entire film
+    preview = Bitmap(Bitmap.PixelFormat.XYZA, Struct.Type.Float32, [100, 70])
+    preview_np = np.array(preview, copy=False)
+    assert film.develop_incremental([0, 0], [100, 70], [0, 0], preview)
+    assert np.allclose(preview_np, contents[:, :, :4], atol=1e-5)
+
+    # Afterwards, only tiles that received new samples are developed again
+    preview_np[:] = -1
+    assert film.develop_incremental([0, 0], [100, 70], [0, 0], preview)
+    assert np.all(preview_np == -1)
+
+    small = ImageBlock([8, 8], 5, film.reconstruction_filter())
+    small.clear()
+    small.set_offset([70, 10])
+    film.put(small)
+
+    assert film.develop_incremental([0, 0], [100, 70], [0, 0], preview)
+    assert np.allclose(preview_np[0:64, 64:100], contents[0:64, 64:100, :4], atol=1e-5)
+    preview_np[0:64, 64:100] = -1
+    assert np.all(preview_np == -1)
+
+
+def test05_streaming(variant_scalar_rgb, tmpdir):
+    from mitsuba.core.xml import load_string
+    from mitsuba.core import Bitmap, Struct
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    """Render the same blocks into a regular and a streaming film (whose tiles
+    do not align with the blocks) and check that the outputs match."""
+    film_xml = """<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="100"/>
+            <integer name="height" value="70"/>
+            <string name="component_format" value="float32"/>
+            <boolean name="streaming" value="{}"/>
+            <integer name="tile_size" value="32"/>
+            <rfilter type="gaussian"/>
+        </film>"""
+
+    films = [load_string(film_xml.format(v)) for v in ['false', 'true']]
+    filenames = [str(tmpdir.join('reference.exr')), str(tmpdir.join('streaming.exr'))]
+    for film, filename in zip(films, filenames):
+        film.set_destination_file(filename)
+        film.set_pass_count(2)
+        film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    # Streaming films are only available in OpenEXR format
+    with pytest.raises(RuntimeError):
+        load_string(film_xml.format('true').replace(
+            '<rfilter', '<string name="file_format" value="pfm"/><rfilter'))
+
+    def tiles_written(film):
+        return [l.strip() for l in str(film).splitlines() if 'tiles_written' in l][0]
+
+    # 100x70 pixels are covered by 4x3 tiles of size 32
+    assert tiles_written(films[1]) == 'tiles_written = 0/12,'
+
+    np.random.seed(1234)
+    rfilter = films[0].reconstruction_filter()
+    for i in range(2):
+        for y in range(0, 70, 24):
+            for x in range(0, 100, 24):
+                size = [min(24, 100 - x), min(24, 70 - y)]
+                block = ImageBlock(size, 5, rfilter)
+                block.clear()
+                block.set_offset([x, y])
+                for yi in range(size[1]):
+                    for xi in range(size[0]):
+                        value = np.random.uniform(size=5)
+                        value[4] = 1.0
+                        block.put([x + xi + 0.5, y + yi + 0.5], value)
+                for film in films:
+                    film.put(block)
+
+        # Tiles are complete once they received the samples of both passes,
+        # at which point they must be flushed without waiting for develop()
+        assert tiles_written(films[1]) == \
+            'tiles_written = {}/12,'.format(0 if i == 0 else 12)
+
+    # The film contents are only stored in the file in streaming mode
+    with pytest.raises(RuntimeError):
+        films[1].bitmap()
+
+    for film in films:
+        film.develop()
+
+    images = [np.array(Bitmap(f).convert(Bitmap.PixelFormat.RGBA, Struct.Type.Float32,
+                                         srgb_gamma=False), copy=False)
+              for f in filenames]
+    assert images[1].shape == (70, 100, 4)
+    assert np.allclose(images[0], images[1], atol=1e-5)
+
+
+def test06_developed_bitmap(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+    import numpy as np
+
+    film = load_string("""<film version="2.0.0" type="hdrfilm">
+            <integer name="width" value="100"/>
+            <integer name="height" value="70"/>
+            <string name="pixel_format" value="xyza"/>
+            <rfilter type="box"/>
+        </film>""")
+    film.prepare(['X', 'Y', 'Z', 'A', 'W'])
+
+    np.random.seed(1234)
+    contents = np.random.uniform(size=(70, 100, 5))
+    contents[:, :, 4] = 2.0
+
+    block = ImageBlock(film.size(), 5, film.reconstruction_filter())
+    block.clear()
+    for y in range(70):
+        for x in range(100):
+            block.put([x + 0.5, y + 0.5], contents[y, x, :])
+    film.put(block)
+
+    # The developed image is shared with NumPy and normalized by the weight
+    bitmap = film.developed_bitmap()
+    bitmap_np = np.array(bitmap, copy=False)
+    assert np.allclose(bitmap_np, contents[:, :, :4] / 2, atol=1e-5)
+
+    # Subsequent calls reuse the bitmap and only develop modified tiles
+    bitmap_np[:] = -1
+    assert film.developed_bitmap() is bitmap
+    assert np.all(bitmap_np == -1)
+
+    # .. independently of the regions developed by develop_incremental()
+    block.clear()
+    block.set_offset([70, 10])
+    film.put(block)
+    assert film.develop_incremental([0, 0], [100, 70], [0, 0], film.bitmap())
+    film.developed_bitmap()
+    assert np.all(bitmap_np[:, 0:64] == -1)
+    assert np.allclose(bitmap_np[:, 64:100], contents[:, 64:100, :4] / 2, atol=1e-5)
@@ -1,11 +1,18 @@
 #include <random>
+#include <algorithm>
+#include <enoki/morton.h>
 #include <enoki/stl.h>
 #include <mitsuba/core/ray.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/imageblock.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/sensor.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -30,6 +37,11 @@ Path tracer (:monosp:`path`)
  * - hide_emitters
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - shadow_batch_size
+   - |int|
+   - Packet variants only: number of samples whose shadow rays are queued, sorted by
+     emitter and direction, and then traced together in coherent packets. A value of 0
+     traces every shadow ray immediately. (Default: 0)
 
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
@@ -85,6 +97,14 @@ both direct and indirect illumination.
    are poorly tesselated, this latter option may cause them to lose a significant amount of the
    incident radiation (or, in other words, they will look dark).
 
+In the packet variants, shadow rays are normally traced as soon as they are
+generated, using the same (typically incoherent) lane layout as the paths. When
+:paramtype:`shadow_batch_size` is set, emitter sampling instead queues the
+shadow rays of a batch of samples, which are subsequently sorted by emitter and
+direction and traced in coherent packets. The samples are only accumulated into
+the image block once all of their shadow rays have been resolved, which does
+not change the result (up to the order of floating point additions).
+
 .. note:: This integrator does not handle participating media
 
  */
@@ -92,16 +112,76 @@ both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth)
-    MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr)
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_block_size,
+                    init_cone, propagate_cone, should_stop, sample_sensor_ray, put_sample)
+    MTS_IMPORT_TYPES(Scene, Sampler, Sensor, ImageBlock, Emitter, EmitterPtr, BSDF, BSDFPtr)
+
+    using ObjectPtr = typename DirectionSample3f::ObjectPtr;
+
+    /// Shadow rays whose tracing is deferred until a batch of samples is complete
+    struct ShadowQueue {
+        std::vector<Ray3f> rays;
+        /// Contribution of each shadow ray, if unoccluded
+        std::vector<Spectrum> values;
+        std::vector<ObjectPtr> emitters;
+        std::vector<Mask> active;
+        /// Index of the sample packet each shadow ray belongs to
+        std::vector<uint32_t> slots;
+
+        void push(const Ray3f &ray, const Spectrum &value, const ObjectPtr &emitter,
+                  uint32_t slot, const Mask &active_) {
+            rays.push_back(ray);
+            values.push_back(value);
+            emitters.push_back(emitter);
+            active.push_back(active_);
+            slots.push_back(slot);
+        }
 
-    PathIntegrator(const Properties &props) : Base(props) { }
+        size_t size() const { return rays.size(); }
+
+        void clear() {
+            rays.clear();
+            values.clear();
+            emitters.clear();
+            active.clear();
+            slots.clear();
+        }
+    };
+
+    /// Camera sample whose contribution is accumulated once its shadow rays are resolved
+    struct DeferredSample {
+        Vector2f position;
+        Wavelength wavelengths;
+        Spectrum weight, value;
+        Mask valid, active;
+    };
+
+    PathIntegrator(const Properties &props) : Base(props) {
+        m_shadow_batch_size = props.size_("shadow_batch_size", 0);
+    }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
-                                     const RayDifferential3f &ray_,
+                                     const RayDifferential3f &ray,
                                      Float * /* aovs */,
                                      Mask active) const override {
+        return sample_path(scene, sampler, ray, nullptr, 0, active);
+    }
+
+    /**
+     * \brief Trace a path and return its radiance estimate
+     *
+     * When \c queue is specified, the shadow rays of emitter sampling are
+     * not traced. Their contributions are instead appended to the queue
+     * (tagged with \c slot) and must be added to the returned estimate once
+     * the visibility of the rays is known (see \ref trace_shadow_rays()).
+     */
+    std::pair<Spectrum, Mask> sample_path(const Scene *scene,
+                                          Sampler *sampler,
+                                          const RayDifferential3f &ray_,
+                                          ShadowQueue *queue,
+                                          uint32_t slot,
+                                          Mask active) const {
         MTS_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
         RayDifferential3f ray = ray_;
@@ -114,6 +194,10 @@ public:
 
         Spectrum throughput(1.f), result(0.f);
 
+        // Footprint of the path (see MonteCarloIntegrator::propagate_cone())
+        Float cone_width, cone_spread;
+        bool track_cone = init_cone(ray_, cone_width, cone_spread);
+
         // ---------------------- First intersection ----------------------
 
         SurfaceInteraction3f si = scene->ray_intersect(ray, active);
@@ -121,6 +205,8 @@ public:
         EmitterPtr emitter = si.emitter(scene);
 
         for (int depth = 1;; ++depth) {
+            // Lanes that are still tracing a path at this depth (for statistics)
+            Mask active_depth = active;
 
             // ---------------- Intersection with emitters ----------------
 
@@ -135,7 +221,11 @@ public:
                getting stuck (e.g. due to total internal reflection) */
             if (depth > m_rr_depth) {
                 Float q = min(hmax(depolarize(throughput)) * sqr(eta), .95f);
-                active &= sampler->next_1d(active) < q;
+                Mask rr_continue = sampler->next_1d(active) < q;
+                if constexpr (!is_cuda_array_v<Float>)
+                    Statistics::add(StatsCounter::RussianRouletteTerminations,
+                                    count(active && !rr_continue));
+                active &= rr_continue;
                 throughput *= rcp(q);
             }
 
@@ -144,8 +234,10 @@ public:
             // in GPU mode when the number of requested bounces infinite
             // since it causes a costly synchronization.
             if ((uint32_t) depth >= (uint32_t) m_max_depth ||
-                ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active)))
+                ((!is_cuda_array_v<Float> || m_max_depth < 0) && none(active))) {
+                record_path_length(depth, active_depth);
                 break;
+            }
 
             // --------------------- Emitter sampling ---------------------
 
@@ -155,7 +247,7 @@ public:
 
             if (likely(any_or<true>(active_e))) {
                 auto [ds, emitter_val] = scene->sample_emitter_direction(
-                    si, sampler->next_2d(active_e), true, active_e);
+                    si, sampler->next_2d(active_e), queue == nullptr, active_e);
                 active_e &= neq(ds.pdf, 0.f);
 
                 // Query the BSDF for that emitter-sampled direction
@@ -167,7 +259,18 @@ public:
                 Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
 
                 Float mis = select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
-                result[active_e] += mis * throughput * bsdf_val * emitter_val;
+                Spectrum contrib = mis * throughput * bsdf_val * emitter_val;
+
+                if (queue) {
+                    // Same shadow ray as Scene::sample_emitter_direction()
+                    Ray3f ray_e(si.p, ds.d,
+                                math::RayEpsilon<Float> * (1.f + hmax(abs(si.p))),
+                                ds.dist * (1.f - math::ShadowEpsilon<Float>),
+                                si.time, si.wavelengths);
+                    queue->push(ray_e, contrib, ds.object, slot, active_e);
+                } else {
+                    result[active_e] += contrib;
+                }
             }
 
             // ----------------------- BSDF sampling ----------------------
@@ -179,13 +282,20 @@ public:
 
             throughput = throughput * bsdf_val;
             active &= any(neq(depolarize(throughput), 0.f));
-            if (none_or<false>(active))
+            if (none_or<false>(active)) {
+                record_path_length(depth, active_depth);
                 break;
+            }
 
             eta *= bs.eta;
 
             // Intersect the BSDF ray against the scene geometry
             ray = si.spawn_ray(si.to_world(bs.wo));
+            if (track_cone) {
+                propagate_cone(cone_width, cone_spread, si.t, bs.pdf,
+                               has_flag(bs.sampled_type, BSDFFlags::Delta));
+                ray.set_cone(cone_width, cone_spread);
+            }
             SurfaceInteraction3f si_bsdf = scene->ray_intersect(ray, active);
 
             /* Determine probability of having sampled that same
@@ -203,6 +313,7 @@ public:
                 emission_weight = mis_weight(bs.pdf, emitter_pdf);
             }
 
+            record_path_length(depth, active_depth && !active);
             si = std::move(si_bsdf);
         }
 
@@ -212,11 +323,186 @@ public:
     //! @}
     // =============================================================
 
+    void render_block(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                      ImageBlock *block, Float *aovs,
+                      size_t sample_count_) const override {
+        if constexpr (is_array_v<Float> && !is_cuda_array_v<Float>) {
+            if (m_shadow_batch_size > 0) {
+                render_block_deferred(scene, sensor, sampler, block, aovs,
+                                      sample_count_);
+                return;
+            }
+        }
+
+        Base::render_block(scene, sensor, sampler, block, aovs, sample_count_);
+    }
+
+    /// Variant of \ref render_block() that defers shadow rays (CPU packet variants only)
+    void render_block_deferred(const Scene *scene, const Sensor *sensor,
+                               Sampler *sampler, ImageBlock *block, Float *aovs,
+                               size_t sample_count_) const {
+        if constexpr (is_array_v<Float> && !is_cuda_array_v<Float>) {
+            ScopedPhase sp(ProfilerPhase::RenderBlock);
+            block->clear();
+            uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
+                     sample_count = (uint32_t)(sample_count_ == (size_t) -1
+                                                   ? sampler->sample_count()
+                                                   : sample_count_);
+
+            ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
+            size_t batch_packets =
+                std::max(m_shadow_batch_size / array_size_v<Float>, (size_t) 1);
+
+            std::vector<DeferredSample> samples;
+            samples.reserve(batch_packets);
+            ShadowQueue queue;
+
+            for (auto [index, active] : range<UInt32>(pixel_count * sample_count)) {
+                if (should_stop())
+                    break;
+                Point2u pos = enoki::morton_decode<Point2u>(index / UInt32(sample_count));
+                active &= !any(pos >= block->size());
+                pos += block->offset();
+
+                auto [ray, ray_weight, position_sample] =
+                    sample_sensor_ray(sensor, sampler, pos, diff_scale_factor, active);
+
+                auto [value, valid] = sample_path(scene, sampler, ray, &queue,
+                                                  (uint32_t) samples.size(), active);
+
+                samples.push_back({ position_sample, ray.wavelengths, ray_weight,
+                                    value, valid, active });
+
+                if (samples.size() == batch_packets)
+                    flush_samples(scene, block, aovs, queue, samples);
+            }
+
+            flush_samples(scene, block, aovs, queue, samples);
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(sensor);
+            ENOKI_MARK_USED(sampler);
+            ENOKI_MARK_USED(block);
+            ENOKI_MARK_USED(aovs);
+            ENOKI_MARK_USED(sample_count_);
+            Throw("Deferred shadow rays are only supported by the CPU packet variants.");
+        }
+    }
+
+    /// Resolve the queued shadow rays and accumulate the samples into the image block
+    void flush_samples(const Scene *scene, ImageBlock *block, Float *aovs,
+                       ShadowQueue &queue, std::vector<DeferredSample> &samples) const {
+        trace_shadow_rays(scene, queue, samples);
+
+        for (const DeferredSample &s : samples)
+            put_sample(block, s.position, s.wavelengths, s.weight * s.value,
+                       s.valid, aovs, s.active);
+
+        samples.clear();
+        queue.clear();
+    }
+
+    /**
+     * \brief Trace the queued shadow rays and add the contributions of the
+     * unoccluded ones to their samples
+     *
+     * The active lanes of all queued rays are sorted by emitter and by
+     * (quantized) direction, and then regrouped into new packets, so that the
+     * rays traced together are much more coherent than the paths that
+     * generated them. The order of accumulation into the samples is the
+     * order of the queue, irrespective of the sorting.
+     */
+    void trace_shadow_rays(const Scene *scene, ShadowQueue &queue,
+                           std::vector<DeferredSample> &samples) const {
+        if constexpr (is_array_v<Float> && !is_cuda_array_v<Float>) {
+            constexpr size_t N = array_size_v<Float>;
+
+            struct Entry {
+                uintptr_t emitter;
+                uint32_t direction;
+                uint32_t index;
+
+                bool operator<(const Entry &e) const {
+                    return std::tie(emitter, direction, index) <
+                           std::tie(e.emitter, e.direction, e.index);
+                }
+            };
+
+            std::vector<Entry> entries;
+            entries.reserve(queue.size() * N);
+            for (size_t r = 0; r < queue.size(); ++r) {
+                UInt32 active = select(queue.active[r], UInt32(1), UInt32(0));
+                const Vector3f &d = queue.rays[r].d;
+                for (size_t lane = 0; lane < N; ++lane) {
+                    if (!active.coeff(lane))
+                        continue;
+                    ScalarVector3f dl(d.x().coeff(lane), d.y().coeff(lane),
+                                      d.z().coeff(lane));
+                    entries.push_back({ (uintptr_t) queue.emitters[r].coeff(lane),
+                                        direction_key(dl), (uint32_t) (r * N + lane) });
+                }
+            }
+
+            std::sort(entries.begin(), entries.end());
+
+            std::vector<UInt32> visible(queue.size(), UInt32(0));
+            for (size_t i = 0; i < entries.size(); i += N) {
+                uint32_t count = (uint32_t) std::min(N, entries.size() - i);
+
+                /* Gather a coherent packet (unused lanes repeat the last ray) */
+                Ray3f ray;
+                for (size_t lane = 0; lane < N; ++lane) {
+                    const Entry &e = entries[i + std::min(lane, (size_t) count - 1)];
+                    slice(ray, lane) = slice(queue.rays[e.index / N], e.index % N);
+                }
+
+                Mask active = arange<UInt32>() < count;
+                UInt32 occluded = select(scene->ray_test(ray, active), UInt32(1), UInt32(0));
+
+                for (uint32_t lane = 0; lane < count; ++lane) {
+                    const Entry &e = entries[i + lane];
+                    if (!occluded.coeff(lane))
+                        visible[e.index / N].coeff(e.index % N) = 1;
+                }
+            }
+
+            for (size_t r = 0; r < queue.size(); ++r) {
+                Mask active = neq(visible[r], 0u);
+                samples[queue.slots[r]].value[active] += queue.values[r];
+            }
+        } else {
+            ENOKI_MARK_USED(scene);
+            ENOKI_MARK_USED(queue);
+            ENOKI_MARK_USED(samples);
+        }
+    }
+
+    /// Quantize a direction (octahedral mapping + Morton order) to sort shadow rays
+    static uint32_t direction_key(const ScalarVector3f &d) {
+        ScalarVector3f n = d / (abs(d.x()) + abs(d.y()) + abs(d.z()));
+        ScalarVector2f p(n.x(), n.y());
+        if (n.z() < 0.f)
+            p = ScalarVector2f(std::copysign(1.f - std::abs(n.y()), n.x()),
+                               std::copysign(1.f - std::abs(n.x()), n.y()));
+
+        ScalarPoint2u q(clamp((p + 1.f) * 512.f, 0.f, 1023.f));
+        return enoki::morton_encode(q);
+    }
+
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %i,\n"
-            "  rr_depth = %i\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %i,\n"
+            "  shadow_batch_size = %i\n"
+            "]", m_max_depth, m_rr_depth, m_shadow_batch_size);
+    }
+
+    /// Record the lanes in \c terminated as paths with <tt>depth - 1</tt> bounces
+    void record_path_length(int depth, const Mask &terminated) const {
+        if constexpr (!is_cuda_array_v<Float>)
+            Statistics::add_path_length((size_t) depth - 1, count(terminated));
+        else
+            ENOKI_MARK_USED(terminated);
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -226,6 +512,8 @@ public:
     }
 
     MTS_DECLARE_CLASS()
+private:
+    size_t m_shadow_batch_size;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(PathIntegrator, MonteCarloIntegrator)
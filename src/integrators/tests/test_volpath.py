@@ -0,0 +1,90 @@
+import mitsuba
+import pytest
+import numpy as np
+
+
+def render_medium(integrator_xml, spp=64):
+    from mitsuba.core.xml import load_string
+
+    scene = load_string("""<scene version="2.0.0">
+        <integrator type="volpath">
+            <integer name="max_depth" value="64"/>
+            {}
+        </integrator>
+        <sensor type="perspective">
+            <float name="fov" value="30"/>
+            <transform name="to_world">
+                <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+            </transform>
+            <sampler type="independent">
+                <integer name="sample_count" value="{}"/>
+            </sampler>
+            <film type="hdrfilm">
+                <integer name="width" value="16"/>
+                <integer name="height" value="16"/>
+                <rfilter type="box"/>
+            </film>
+        </sensor>
+        <emitter type="constant"/>
+        <shape type="sphere">
+            <bsdf type="null"/>
+            <medium name="interior" type="homogeneous">
+                <rgb name="albedo" value="0.9"/>
+                <rgb name="sigma_t" value="4.0"/>
+            </medium>
+        </shape>
+    </scene>""".format(integrator_xml, spp))
+
+    sensor = scene.sensors()[0]
+    assert scene.integrator().render(scene, sensor)
+    film_size = sensor.film().crop_size()
+    image = np.array(sensor.film().bitmap(), copy=True)[:, :, :3]
+    return image, film_size[0] * film_size[1] * spp
+
+
+def test01_splitting_and_rr_unbiased(variant_scalar_rgb):
+    # Reference without Russian roulette and splitting
+    reference, _ = render_medium("""
+        <integer name="rr_depth" value="1000"/>""")
+
+    image, _ = render_medium("""
+        <integer name="rr_depth" value="2"/>
+        <float name="split_factor" value="4"/>
+        <integer name="split_depth" value="3"/>
+        <integer name="max_split" value="4"/>""")
+
+    assert np.all(np.isfinite(image))
+
+    # Both estimators converge to the same result: compare the averages
+    # over blocks of 4x4 pixels
+    def block_mean(x):
+        return x.reshape(4, 4, 4, 4, 3).mean(axis=(1, 3))
+
+    assert np.allclose(block_mean(image), block_mean(reference), rtol=0.1, atol=0.01)
+    assert np.isclose(np.mean(image), np.mean(reference), rtol=0.03)
+
+
+@pytest.mark.parametrize("max_split", [2, 3])
+def test02_max_split_bounds_splitting(variant_scalar_rgb, max_split):
+    from mitsuba.core import Statistics, StatsCounter
+
+    if not mitsuba.core.MTS_ENABLE_STATISTICS:
+        pytest.skip("Render statistics are disabled in this build.")
+
+    split_depth = 2
+    Statistics.reset()
+
+    # With a huge split factor, every scattering event below 'split_depth'
+    # creates exactly 'max_split' continuations
+    image, sample_count = render_medium("""
+        <float name="split_factor" value="1e6"/>
+        <integer name="split_depth" value="{}"/>
+        <integer name="max_split" value="{}"/>""".format(split_depth, max_split), spp=4)
+
+    assert np.all(np.isfinite(image))
+
+    # Every camera path turns into a tree with at most max_split^split_depth leaves
+    splits = Statistics.data()[StatsCounter.PathSplits]
+    assert splits > 0
+    assert splits <= sample_count * (max_split ** split_depth - 1)
+    assert splits % (max_split - 1) == 0
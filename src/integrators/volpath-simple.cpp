@@ -16,7 +16,8 @@ template <typename Float, typename Spectrum>
 class VolumetricNullSimplePathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                    init_cone, propagate_cone)
     MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
                      Medium, MediumPtr, PhaseFunctionContext)
 
@@ -46,9 +47,12 @@ public:
         // Otherwise, it will depend on whether a valid interaction is sampled
         Mask valid_ray = !m_hide_emitters && neq(scene->environment(), nullptr);
 
-        // For now, don't use ray differentials
         Ray3f ray = ray_;
 
+        // Footprint of the path (see MonteCarloIntegrator::propagate_cone())
+        Float cone_width, cone_spread;
+        bool track_cone = init_cone(ray_, cone_width, cone_spread);
+
         // Tracks radiance scaling due to index of refraction changes
         Float eta(1.f);
 
@@ -139,6 +143,8 @@ public:
             if (any_or<true>(act_null_scatter)) {
                 masked(ray.o, act_null_scatter) = mi.p;
                 masked(ray.mint, act_null_scatter) = 0.f;
+                if (track_cone)
+                    masked(cone_width, act_null_scatter) = fmadd(cone_spread, mi.t, cone_width);
                 masked(si.t, act_null_scatter) = si.t - mi.t;
             }
 
@@ -166,7 +172,7 @@ public:
                         Ray3f nee_ray = mi.spawn_ray(ds.d);
                         nee_ray.mint = 0.f;
                         auto emitted = evaluate_direct_light(mi, scene, sampler, medium, nee_ray, true, si,
-                                                             ds.dist, channel, active_e).first;
+                                                             ds.dist, active_e).first;
                         Float phase_val = phase->eval(phase_ctx, mi, ds.d, active_e);
                         masked(result, active_e) += throughput * phase_val * emitted / ds.pdf;
                     }
@@ -179,6 +185,9 @@ public:
                 new_ray.mint = 0.0f;
                 masked(ray, act_medium_scatter) = new_ray;
                 needs_intersection |= act_medium_scatter;
+                if (track_cone)
+                    propagate_cone(cone_width, cone_spread, mi.t, phase_pdf, false,
+                                   act_medium_scatter);
             }
 
             // --------------------- Surface Interactions ---------------------
@@ -200,7 +209,10 @@ public:
             if (any_or<true>(active_surface)) {
                 // --------------------- Emitter sampling ---------------------
                 BSDFContext ctx;
-                BSDFPtr bsdf  = si.bsdf(ray);
+                RayDifferential3f ray_cone(ray);
+                if (track_cone)
+                    ray_cone.set_cone(cone_width, cone_spread);
+                BSDFPtr bsdf  = si.bsdf(ray_cone);
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
 
                 if (likely(any_or<true>(active_e))) {
@@ -211,7 +223,7 @@ public:
 
                         // TODO: This has to be zero if its not reaching the same point
                         auto emitted = evaluate_direct_light(si, scene, sampler, medium, nee_ray, true, si,
-                                                             ds.dist, channel, active_e).first;
+                                                             ds.dist, active_e).first;
 
                         // Query the BSDF for that emitter-sampled direction
                         Vector3f wo       = si.to_local(ds.d);
@@ -236,6 +248,9 @@ public:
                 Ray bsdf_ray                = si.spawn_ray(si.to_world(bs.wo));
                 masked(ray, active_surface) = bsdf_ray;
                 needs_intersection |= active_surface;
+                if (track_cone)
+                    propagate_cone(cone_width, cone_spread, si.t, bs.pdf,
+                                   has_flag(bs.sampled_type, BSDFFlags::Delta), active_surface);
 
                 Mask non_null_bsdf = active_surface && !has_flag(bs.sampled_type, BSDFFlags::Null);
                 masked(depth, non_null_bsdf) += 1;
@@ -278,7 +293,7 @@ public:
     evaluate_direct_light(const Interaction3f &ref_interaction, const Scene *scene,
                           Sampler *sampler, MediumPtr medium, Ray3f ray,
                           Mask needs_intersection, const SurfaceInteraction3f &si_ray,
-                          Float dist, UInt32 channel, Mask active) const {
+                          Float dist, Mask active) const {
 
         using EmitterPtr = replace_scalar_t<Float, const Emitter *>;
         Spectrum emitter_val(0.0f);
@@ -292,39 +307,21 @@ public:
             Mask escaped_medium = false;
             Mask active_medium  = active && neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
-            SurfaceInteraction3f si_medium;
             if (any_or<true>(active_medium)) {
-                auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
+                // Find the end of the medium segment
                 Mask intersect = needs_intersection && active_medium;
                 if (any_or<true>(intersect))
                     masked(si, intersect) = scene->ray_intersect(ray, intersect);
-
-                masked(mi.t, active_medium && (si.t < mi.t)) = math::Infinity<Float>;
-
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
-                Mask not_spectral = !is_spectral && active_medium;
-                if (any_or<true>(is_spectral)) {
-                    auto [tr, free_flight_pdf] = medium->eval_tr_and_pdf(mi, si, is_spectral);
-                    Float tr_pdf = index_spectrum(free_flight_pdf, channel);
-                    masked(transmittance, is_spectral) *= select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
-                }
-
                 needs_intersection &= !active_medium;
-                escaped_medium = active_medium && !mi.is_valid();
-                active_medium &= mi.is_valid();
-                masked(total_dist, active_medium) += mi.t;
 
-                if (any_or<true>(active_medium)) {
-                    masked(ray.o, active_medium)    = mi.p;
-                    masked(ray.mint, active_medium) = 0.f;
-                    masked(si.t, active_medium) = si.t - mi.t;
+                // Estimate the transmittance of the entire segment at once
+                Ray3f segment = ray;
+                segment.maxt  = si.t;
+                masked(transmittance, active_medium) *=
+                    medium->eval_transmittance(segment, sampler, active_medium);
 
-                    if (any_or<true>(is_spectral))
-                        masked(transmittance, is_spectral && active_medium) *= mi.sigma_n;
-                    if (any_or<true>(not_spectral))
-                        masked(transmittance, not_spectral && active_medium) *= mi.sigma_n / mi.combined_extinction;
-                }
+                escaped_medium = active_medium;
+                active_medium  = false;
             }
 
             // Handle interactions with surfaces
@@ -2,6 +2,7 @@
 #include <enoki/stl.h>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
 #include <mitsuba/render/integrator.h>
@@ -24,7 +25,47 @@ class VolumetricNullPathIntegratorImpl;
 Volumetric path tracer with null scattering (:monosp:`volpath`)
 ---------------------------------------------------------------
 
-.. todo:: Not documented yet.
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+ * - use_spectral_mis
+   - |bool|
+   - Combine the sampling strategies of all wavelengths using spectral MIS. (Default: |true|)
+ * - split_factor
+   - |float|
+   - Expected number of continuations of a path with unit throughput at depths below
+     :monosp:`split_depth`. Values larger than one enable throughput-based splitting.
+     (Default: 1, i.e. no splitting)
+ * - split_depth
+   - |int|
+   - Paths are only split at medium scattering events with a depth smaller than this value.
+     (Default: 3)
+ * - max_split
+   - |int|
+   - Maximum number of continuations created at a single scattering event. (Default: 8)
+
+Russian roulette and splitting are driven by the MIS-weighted throughput of the
+path (i.e. the inverse of its :math:`p/f` ratios), so that they remain consistent
+with the spectral and null-scattering MIS weights. Both only consider real
+scattering events: null collisions in heterogeneous media neither count towards
+:monosp:`rr_depth` nor trigger splitting.
+
+Splitting trades additional work per camera ray for a lower variance of the
+indirect illumination in dense, high-albedo media (e.g. clouds), where the
+first few scattering events dominate the appearance. Every continuation samples
+its own direction from the phase function. Splitting is currently only supported
+by the scalar variants and is ignored (with a warning) otherwise.
 */
 template <typename Float, typename Spectrum>
 class VolumetricNullPathIntegrator final : public MonteCarloIntegrator<Float, Spectrum> {
@@ -36,6 +77,9 @@ public:
 
     VolumetricNullPathIntegrator(const Properties &props) : Base(props) {
         m_use_spectral_mis = props.bool_("use_spectral_mis", true);
+        // These are consumed by the specialized implementation created in expand()
+        for (const char *name : { "split_factor", "split_depth", "max_split" })
+            props.mark_queried(name);
         m_props = props;
     }
 
@@ -61,7 +105,8 @@ template <typename Float, typename Spectrum, bool SpectralMis>
 class VolumetricNullPathIntegratorImpl final : public MonteCarloIntegrator<Float, Spectrum> {
 
 public:
-    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MTS_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                    init_cone, propagate_cone)
     MTS_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
                      Medium, MediumPtr, PhaseFunctionContext)
 
@@ -69,7 +114,37 @@ public:
         std::conditional_t<SpectralMis, Matrix<Float, array_size_v<UnpolarizedSpectrum>>,
                            UnpolarizedSpectrum>;
 
-    VolumetricNullPathIntegratorImpl(const Properties &props) : Base(props) {}
+    /// Path state that is saved when a path is split and resumed later on
+    struct SplitState {
+        Ray3f ray;
+        SurfaceInteraction3f si;
+        Mask needs_intersection;
+        MediumPtr medium;
+        WeightMatrix p_over_f;
+        WeightMatrix p_over_f_nee;
+        UInt32 depth;
+        UInt32 rr_depth;
+        Mask specular_chain;
+        Float eta;
+        Float cone_width;
+        Float cone_spread;
+    };
+
+    VolumetricNullPathIntegratorImpl(const Properties &props) : Base(props) {
+        m_split_factor = props.float_("split_factor", 1.f);
+        m_split_depth  = props.int_("split_depth", 3);
+        m_max_split    = props.int_("max_split", 8);
+        if (m_split_factor <= 0.f)
+            Throw("\"split_factor\" must be set to a value greater than zero!");
+        if (m_max_split < 1)
+            Throw("\"max_split\" must be set to a value greater than zero!");
+
+        if (is_array_v<Float> && m_split_factor != 1.f) {
+            Log(Warn, "Path splitting is only supported by the scalar variants, "
+                      "\"split_factor\" will be ignored.");
+            m_split_factor = 1.f;
+        }
+    }
 
     MTS_INLINE
     Float index_spectrum(const UnpolarizedSpectrum &spec, const UInt32 &idx) const {
@@ -97,9 +172,12 @@ public:
         // Otherwise, it will depend on whether a valid interaction is sampled
         Mask valid_ray = !m_hide_emitters && neq(scene->environment(), nullptr);
 
-        // For now, don't use ray differentials
         Ray3f ray = ray_;
 
+        // Footprint of the path (see MonteCarloIntegrator::propagate_cone())
+        Float cone_width, cone_spread;
+        bool track_cone = init_cone(ray_, cone_width, cone_spread);
+
         // Tracks radiance scaling due to index of refraction changes
         Float eta(1.f);
 
@@ -122,25 +200,66 @@ public:
         SurfaceInteraction3f si;
         Mask needs_intersection = true;
 
+        // Depth at which Russian roulette was last considered
+        UInt32 rr_depth = 0;
+
+        /* Paths created by splitting that still need to be traced. Each real
+           scattering event below 'split_depth' on the current path adds at
+           most 'max_split - 1' entries, which bounds the size of the stack. */
+        std::vector<SplitState> split_stack;
+        if constexpr (!is_array_v<Float>) {
+            if (m_split_factor != 1.f)
+                split_stack.reserve(max_split_stack_size());
+        }
+
         for (int bounce = 0;; ++bounce) {
             // ----------------- Handle termination of paths ------------------
 
-            // Russian roulette: try to keep path weights equal to one, while accounting for the
-            // solid angle compression at refractive index boundaries. Stop with at least some
-            // probability to avoid  getting stuck (e.g. due to total internal reflection)
-            // Spectrum mis_throughput = mis_weight(p_over_f);
-            // active &= any(neq(depolarize(mis_throughput), 0.f));
-            // Float q = min(hmax(depolarize(mis_throughput)) * sqr(eta), .95f);
-            // Mask perform_rr = (depth > (uint32_t) m_rr_depth);
-            // active &= !(sampler->next_1d(active) >= q && perform_rr);
-            // update_weights(p_over_f, detach(q), 1.0f, perform_rr);
-
             Mask exceeded_max_depth = depth >= (uint32_t) m_max_depth;
             active &= !exceeded_max_depth;
             active &= any(neq(depolarize(mis_weight(p_over_f)), 0.f));
 
-            if (none(active))
+            /* Russian roulette: try to keep path weights equal to one, while
+               accounting for the solid angle compression at refractive index
+               boundaries. This is only done once per real scattering event,
+               null collisions don't change the depth. */
+            Mask perform_rr = active && depth > rr_depth && depth > (uint32_t) m_rr_depth;
+            if (any_or<true>(perform_rr)) {
+                Float q = min(hmax(mis_weight(p_over_f)) * sqr(eta), .95f);
+                Mask rr_continue = sampler->next_1d(perform_rr) < q;
+                if constexpr (!is_cuda_array_v<Float>)
+                    Statistics::add(StatsCounter::RussianRouletteTerminations,
+                                    count(perform_rr && !rr_continue));
+                active &= !perform_rr || rr_continue;
+                update_weights(p_over_f, detach(q), 1.f, channel, perform_rr);
+                update_weights(p_over_f_nee, detach(q), 1.f, channel, perform_rr);
+            }
+            masked(rr_depth, active) = depth;
+
+            if (none(active)) {
+                if constexpr (!is_array_v<Float>) {
+                    // Resume the next path that was created by splitting
+                    if (!split_stack.empty()) {
+                        const SplitState &s = split_stack.back();
+                        ray                 = s.ray;
+                        si                  = s.si;
+                        needs_intersection  = s.needs_intersection;
+                        medium              = s.medium;
+                        p_over_f            = s.p_over_f;
+                        p_over_f_nee        = s.p_over_f_nee;
+                        depth               = s.depth;
+                        rr_depth            = s.rr_depth;
+                        specular_chain      = s.specular_chain;
+                        eta                 = s.eta;
+                        cone_width          = s.cone_width;
+                        cone_spread         = s.cone_spread;
+                        split_stack.pop_back();
+                        active = true;
+                        continue;
+                    }
+                }
                 break;
+            }
 
             // ----------------------- Sampling the RTE -----------------------
             Mask active_medium  = active && neq(medium, nullptr);
@@ -204,6 +323,8 @@ public:
 
                     masked(ray.o, act_null_scatter) = mi.p;
                     masked(ray.mint, act_null_scatter) = 0.f;
+                    if (track_cone)
+                        masked(cone_width, act_null_scatter) = fmadd(cone_spread, mi.t, cone_width);
                     masked(si.t, act_null_scatter) = si.t - mi.t;
                 }
 
@@ -231,6 +352,32 @@ public:
                     // In a real interaction: reset p_over_f_nee
                     masked(p_over_f_nee, act_medium_scatter) = p_over_f;
 
+                    // ---------------------- Path splitting ----------------------
+                    if constexpr (!is_array_v<Float>) {
+                        if (act_medium_scatter && m_split_factor != 1.f &&
+                            depth < (uint32_t) m_split_depth) {
+                            uint32_t n_split = split(p_over_f, p_over_f_nee, eta, sampler, channel);
+                            Statistics::add(StatsCounter::PathSplits, n_split - 1);
+
+                            // Every additional continuation samples its own direction
+                            for (uint32_t i = 1; i < n_split; ++i) {
+                                SplitState s{ ray,    si,         true,       medium,
+                                              p_over_f, p_over_f_nee, depth, rr_depth,
+                                              specular_chain, eta, cone_width, cone_spread };
+                                auto [wo, phase_pdf] = phase->sample(phase_ctx, mi, sampler->next_2d());
+                                s.ray      = mi.spawn_ray(wo);
+                                s.ray.mint = 0.f;
+                                if (track_cone)
+                                    propagate_cone(s.cone_width, s.cone_spread, mi.t,
+                                                   phase_pdf, false, true);
+                                update_weights(s.p_over_f, phase_pdf, phase_pdf, channel, true);
+                                update_weights(s.p_over_f_nee, 1.f, phase_pdf, channel, true);
+                                Assert(split_stack.size() < max_split_stack_size());
+                                split_stack.push_back(s);
+                            }
+                        }
+                    }
+
                     // ------------------ Phase function sampling -----------------
                     masked(phase, !act_medium_scatter) = nullptr;
                     auto [wo, phase_pdf] = phase->sample(phase_ctx, mi, sampler->next_2d(act_medium_scatter), act_medium_scatter);
@@ -238,6 +385,9 @@ public:
                     new_ray.mint = 0.0f;
                     masked(ray, act_medium_scatter) = new_ray;
                     needs_intersection |= act_medium_scatter;
+                    if (track_cone)
+                        propagate_cone(cone_width, cone_spread, mi.t, phase_pdf, false,
+                                       act_medium_scatter);
 
                     update_weights(p_over_f, phase_pdf, phase_pdf, channel, act_medium_scatter);
                     update_weights(p_over_f_nee, 1.f, phase_pdf, channel, act_medium_scatter);
@@ -278,7 +428,10 @@ public:
 
                 // --------------------- Emitter sampling ---------------------
                 BSDFContext ctx;
-                BSDFPtr bsdf  = si.bsdf(ray);
+                RayDifferential3f ray_cone(ray);
+                if (track_cone)
+                    ray_cone.set_cone(cone_width, cone_spread);
+                BSDFPtr bsdf  = si.bsdf(ray_cone);
                 Mask active_e = active_surface && has_flag(bsdf->flags(), BSDFFlags::Smooth) && (depth + 1 < (uint32_t) m_max_depth);
                 if (likely(any_or<true>(active_e))) {
                     auto [p_over_f_nee_end, p_over_f_end, emitted, wo] = sample_emitter(si, false, scene, sampler, medium, p_over_f, channel, active_e);
@@ -299,6 +452,9 @@ public:
                 Ray bsdf_ray                = si.spawn_ray(si.to_world(bs.wo));
                 masked(ray, active_surface) = bsdf_ray;
                 needs_intersection |= active_surface;
+                if (track_cone)
+                    propagate_cone(cone_width, cone_spread, si.t, bs.pdf,
+                                   has_flag(bs.sampled_type, BSDFFlags::Delta), active_surface);
 
                 Mask non_null_bsdf = active_surface && !has_flag(bs.sampled_type, BSDFFlags::Null);
                 valid_ray |= non_null_bsdf;
@@ -348,6 +504,25 @@ public:
             Mask active_medium  = active && neq(medium, nullptr);
             Mask active_surface = active && !active_medium;
 
+            /* Homogeneous media: evaluate the transmittance of the segment in
+               closed form instead of tracking null collisions. The probability
+               of crossing the segment with unidirectional sampling equals the
+               transmittance itself. */
+            Mask closed_form = active_medium && medium->is_homogeneous();
+            if (any_or<true>(closed_form)) {
+                Mask intersect = needs_intersection && closed_form;
+                if (any_or<true>(intersect))
+                    masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                needs_intersection &= !closed_form;
+
+                Ray3f segment = ray;
+                segment.maxt  = si.t;
+                UnpolarizedSpectrum tr = medium->eval_transmittance(segment, sampler, closed_form);
+                update_weights(p_over_f_nee, 1.f, tr, channel, closed_form);
+                update_weights(p_over_f_uni, tr, tr, channel, closed_form);
+                active_medium &= !closed_form;
+            }
+
             if (any_or<true>(active_medium)) {
                 auto mi = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
                 masked(ray.maxt, active_medium && medium->is_homogeneous() && mi.is_valid()) = mi.t;
@@ -392,7 +567,7 @@ public:
             Mask intersect = active_surface && needs_intersection;
             if (any_or<true>(intersect))
                 masked(si, intersect)    = scene->ray_intersect(ray, intersect);
-            active_surface |= escaped_medium;
+            active_surface |= escaped_medium || closed_form;
             masked(total_dist, active_surface) += si.t;
 
             // Check if we hit an emitter and add illumination if needed
@@ -437,6 +612,29 @@ public:
         return { p_over_f_nee, p_over_f_uni, emitter_val, ray.d};
     }
 
+    /**
+     * \brief Determine the number of continuations of a path at a scattering event
+     *
+     * The expected number of continuations is proportional to the MIS-weighted
+     * throughput of the path. The weights of the path are divided by this
+     * expectation, which keeps the estimator unbiased.
+     */
+    uint32_t split(WeightMatrix &p_over_f, WeightMatrix &p_over_f_nee, Float eta,
+                   Sampler *sampler, UInt32 channel) const {
+        Float n_expected = min(m_split_factor * hmax(mis_weight(p_over_f)) * sqr(eta),
+                               (Float) m_max_split);
+        if (!(n_expected > 1.f))
+            return 1;
+        update_weights(p_over_f, n_expected, 1.f, channel, true);
+        update_weights(p_over_f_nee, n_expected, 1.f, channel, true);
+        return (uint32_t) min(floor(n_expected + sampler->next_1d()), (Float) m_max_split);
+    }
+
+    /// Upper bound on the number of pending paths created by splitting
+    size_t max_split_stack_size() const {
+        return (size_t) (m_max_split - 1) * (size_t) std::max(m_split_depth, 0);
+    }
+
     MTS_INLINE
     void update_weights(WeightMatrix &p_over_f,
                         const UnpolarizedSpectrum &p,
@@ -496,12 +694,21 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricNullPathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  split_factor = %f,\n"
+                           "  split_depth = %i,\n"
+                           "  max_split = %i\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth, m_split_factor, m_split_depth,
+                           m_max_split);
     }
 
     MTS_DECLARE_CLASS()
+
+protected:
+    ScalarFloat m_split_factor;
+    int m_split_depth;
+    int m_max_split;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(VolumetricNullPathIntegrator, MonteCarloIntegrator);
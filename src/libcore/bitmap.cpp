@@ -3,10 +3,12 @@
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
 #include <tbb/tbb.h>
+#include <mutex>
 #include <unordered_map>
 
 /* libpng */
@@ -36,6 +38,7 @@ extern "C" {
 #include <ImfStandardAttributes.h>
 #include <ImfRgbaYca.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfChannelList.h>
 #include <ImfStringAttribute.h>
 #include <ImfIntAttribute.h>
@@ -351,6 +354,23 @@ void Bitmap::convert(Bitmap *target) const {
         Throw("Bitmap::convert(): Incompatible target size!"
               " This: %s vs target: %s)", m_size, target->size());
 
+    convert(target, Point2i(0), Point2i(0), Vector2i(m_size));
+}
+
+void Bitmap::convert(Bitmap *target,
+                     Point2i source_offset,
+                     Point2i target_offset,
+                     Vector2i size) const {
+    /// Clip against bounds of source and target image
+    Vector2i shift = max(0, max(-source_offset, -target_offset));
+    source_offset += shift;
+    target_offset += shift;
+    size -= max(source_offset + size - Vector2i(m_size), 0);
+    size -= max(target_offset + size - Vector2i(target->size()), 0);
+
+    if (any(size <= 0))
+        return;
+
     ref<Struct> target_struct = new Struct(*(target->struct_()));
 
     bool source_is_rgb = m_pixel_format == PixelFormat::RGB ||
@@ -461,7 +481,17 @@ void Bitmap::convert(Bitmap *target) const {
     }
 
     StructConverter conv(m_struct, target_struct, true);
-    bool rv = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(), target->uint8_data());
+
+    size_t source_bpp = bytes_per_pixel(),
+           target_bpp = target->bytes_per_pixel();
+
+    const uint8_t *source_data = uint8_data() +
+        (source_offset.x() + source_offset.y() * (size_t) width()) * source_bpp;
+    uint8_t *target_data = target->uint8_data() +
+        (target_offset.x() + target_offset.y() * (size_t) target->width()) * target_bpp;
+
+    bool rv = conv.convert_2d(size.x(), size.y(), source_data, target_data,
+                              width() * source_bpp, target->width() * target_bpp);
     if (!rv)
         Throw("Bitmap::convert(): conversion kernel indicated a failure!");
 }
@@ -705,6 +735,7 @@ void Bitmap::write(const fs::path &path, FileFormat format, int quality) const {
 }
 
 void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
+    ScopedPhase sp(ProfilerPhase::BitmapWrite);
     auto fs = dynamic_cast<FileStream *>(stream);
 
     if (format == FileFormat::Auto) {
@@ -1228,31 +1259,31 @@ void Bitmap::read_openexr(Stream *stream) {
     }
 }
 
-void Bitmap::write_openexr(Stream *stream, int quality) const {
-    if (Imf::globalThreadCount() == 0)
-        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+/// Return the OpenEXR pixel type corresponding to a component format
+static Imf::PixelType exr_pixel_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Float32: return Imf::FLOAT;
+        case Struct::Type::Float16: return Imf::HALF;
+        case Struct::Type::UInt32: return Imf::UINT;
+        default: Throw("Unexpected field type!");
+    }
+}
 
-    PixelFormat pixel_format = m_pixel_format;
+/// Copy the metadata of a bitmap into an OpenEXR header
+static void exr_write_metadata(Imf::Header &header, const Properties &metadata_,
+                               Bitmap::PixelFormat pixel_format) {
+    using Float    = Bitmap::Float;
+    using Vector3f = Bitmap::Vector3f;
+    using Point3f  = Bitmap::Point3f;
+    using Matrix4f = Bitmap::Matrix4f;
+    using PixelFormat = Bitmap::PixelFormat;
 
-    Properties metadata(m_metadata);
+    Properties metadata(metadata_);
     if (!metadata.has_property("generatedBy"))
         metadata.set_string("generatedBy", "Mitsuba version " MTS_VERSION);
 
     std::vector<std::string> keys = metadata.property_names();
 
-    Imf::Header header(
-        (int) m_size.x(),  // width
-        (int) m_size.y(),  // height,
-        1.f,               // pixelAspectRatio
-        Imath::V2f(0, 0),  // screenWindowCenter,
-        1.f,               // screenWindowWidth
-        Imf::INCREASING_Y, // lineOrder
-        quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
-    );
-
-    if (quality > 0)
-        Imf::addDwaCompressionLevel(header, float(quality));
-
     for (auto it = keys.begin(); it != keys.end(); ++it) {
         using Type = Properties::Type;
 
@@ -1312,6 +1343,28 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
             Imath::V2f(0.f, 0.f),
             Imath::V2f(1.f / 3.f, 1.f / 3.f)));
     }
+}
+
+void Bitmap::write_openexr(Stream *stream, int quality) const {
+    if (Imf::globalThreadCount() == 0)
+        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+
+    PixelFormat pixel_format = m_pixel_format;
+
+    Imf::Header header(
+        (int) m_size.x(),  // width
+        (int) m_size.y(),  // height,
+        1.f,               // pixelAspectRatio
+        Imath::V2f(0, 0),  // screenWindowCenter,
+        1.f,               // screenWindowWidth
+        Imf::INCREASING_Y, // lineOrder
+        quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
+    );
+
+    if (quality > 0)
+        Imf::addDwaCompressionLevel(header, float(quality));
+
+    exr_write_metadata(header, m_metadata, pixel_format);
 
     size_t pixel_stride = m_struct->size(),
            row_stride = pixel_stride * m_size.x();
@@ -1320,14 +1373,7 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
     Imf::FrameBuffer framebuffer;
     const uint8_t *ptr = uint8_data();
     for (auto field : *m_struct) {
-        Imf::PixelType comp_type;
-        switch (field.type) {
-            case Struct::Type::Float32: comp_type = Imf::FLOAT; break;
-            case Struct::Type::Float16: comp_type = Imf::HALF; break;
-            case Struct::Type::UInt32: comp_type = Imf::UINT; break;
-            default: Throw("Unexpected field type!");
-        }
-
+        Imf::PixelType comp_type = exr_pixel_type(field.type);
         Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
         channels.insert(field.name, Imf::Channel(comp_type));
         framebuffer.insert(field.name, slice);
@@ -1339,6 +1385,88 @@ void Bitmap::write_openexr(Stream *stream, int quality) const {
     file.writePixels((int) m_size.y());
 }
 
+struct TiledEXRWriter::TiledEXRWriterPrivate {
+    ref<FileStream> stream;
+    std::unique_ptr<EXROStream> ostream;
+    std::unique_ptr<Imf::TiledOutputFile> file;
+    ref<Struct> struct_;
+    std::mutex mutex;
+};
+
+TiledEXRWriter::TiledEXRWriter(const fs::path &filename, const Bitmap *layout,
+                               const Vector2u &size, uint32_t tile_size)
+    : m_size(size), m_tile_size(tile_size), d(new TiledEXRWriterPrivate()) {
+    if (Imf::globalThreadCount() == 0)
+        Imf::setGlobalThreadCount(std::min(8, util::core_count()));
+
+    Imf::Header header((int) size.x(), (int) size.y(), 1.f, Imath::V2f(0, 0), 1.f,
+                       Imf::RANDOM_Y, Imf::PIZ_COMPRESSION);
+    header.setTileDescription(Imf::TileDescription(tile_size, tile_size, Imf::ONE_LEVEL));
+    exr_write_metadata(header, layout->metadata(), layout->pixel_format());
+
+    d->struct_ = new Struct(*layout->struct_());
+    Imf::ChannelList &channels = header.channels();
+    for (auto field : *d->struct_)
+        channels.insert(field.name, Imf::Channel(exr_pixel_type(field.type)));
+
+    d->stream = new FileStream(filename, FileStream::ETruncReadWrite);
+    d->ostream.reset(new EXROStream(d->stream));
+    d->file.reset(new Imf::TiledOutputFile(*d->ostream, header));
+}
+
+TiledEXRWriter::~TiledEXRWriter() {
+    close();
+}
+
+void TiledEXRWriter::write_tile(const Point2u &offset, const Bitmap *tile) {
+    if (*tile->struct_() != *d->struct_)
+        Throw("TiledEXRWriter::write_tile(): the tile does not match the layout of the file!");
+    if (any(neq(offset % m_tile_size, 0u)) ||
+        tile->size() != min(Vector2u(m_tile_size), m_size - offset))
+        Throw("TiledEXRWriter::write_tile(): invalid tile (offset=%s, size=%s)!",
+              offset, tile->size());
+
+    size_t pixel_stride = d->struct_->size(),
+           row_stride = pixel_stride * tile->width();
+
+    /* The frame buffer addresses pixels using absolute image coordinates,
+       hence the origin is shifted by the tile's offset */
+    const char *base = (const char *) tile->uint8_data() -
+                       offset.x() * pixel_stride - offset.y() * row_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (auto field : *d->struct_)
+        framebuffer.insert(field.name,
+                           Imf::Slice(exr_pixel_type(field.type), (char *) base + field.offset,
+                                      pixel_stride, row_stride));
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (!d->file)
+        Throw("TiledEXRWriter::write_tile(): the file was already closed!");
+    d->file->setFrameBuffer(framebuffer);
+    d->file->writeTile((int) (offset.x() / m_tile_size), (int) (offset.y() / m_tile_size));
+}
+
+void TiledEXRWriter::close() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->file.reset();
+    d->ostream.reset();
+    if (d->stream) {
+        d->stream->close();
+        d->stream = nullptr;
+    }
+}
+
+std::string TiledEXRWriter::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledEXRWriter[" << std::endl
+        << "  size = " << m_size << "," << std::endl
+        << "  tile_size = " << m_tile_size << "," << std::endl
+        << "  struct = " << string::indent(d->struct_->to_string()) << std::endl
+        << "]";
+    return oss.str();
+}
+
 // -----------------------------------------------------------------------------
 //   JPEG bitmap I/O
 // -----------------------------------------------------------------------------
@@ -2426,5 +2554,6 @@ void Bitmap::static_shutdown() {
 }
 
 MTS_IMPLEMENT_CLASS(Bitmap, Object)
+MTS_IMPLEMENT_CLASS(TiledEXRWriter, Object)
 
 NAMESPACE_END(mitsuba)
@@ -1,4 +1,5 @@
 #include <mitsuba/core/object.h>
+#include <mitsuba/core/profiler.h>
 #include <cstdlib>
 #include <cstdio>
 #include <sstream>
@@ -32,7 +33,10 @@ std::string Object::to_string() const {
     return oss.str();
 }
 
-Object::~Object() { }
+Object::~Object() {
+    if (unlikely(m_profiler_registered))
+        Profiler::unregister_object(this);
+}
 
 std::ostream& operator<<(std::ostream &os, const Object *object) {
     os << ((object != nullptr) ? object->to_string() : "nullptr");
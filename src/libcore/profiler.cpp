@@ -1,5 +1,8 @@
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/util.h>
 
 #if defined(MTS_ENABLE_PROFILER)
@@ -8,31 +11,258 @@
 #include <stdio.h>
 #include <tbb/tbb.h>
 #include <array>
+#include <chrono>
+#include <fstream>
 #include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 NAMESPACE_BEGIN(mitsuba)
 
-static thread_local uint64_t profiler_flags_storage = 0;
-uint64_t *profiler_flags() { return &profiler_flags_storage; }
+static thread_local ProfilerState profiler_state_storage;
+uint64_t *profiler_flags() { return &profiler_state_storage.flags; }
+ProfilerState *profiler_state() { return &profiler_state_storage; }
 
+/// Hash table entry of the sampling profiler, see \ref profiler_callback()
 struct ProfilerSample {
     uint64_t flags = (uint64_t) -1;
+    const Object *object = nullptr;
+    uint64_t generation = 0;
     uint64_t count = 0;
 };
 
 static std::array<ProfilerSample, MTS_PROFILE_HASH_SIZE> profiler_samples;
 
+// -----------------------------------------------------------------------
+//  Object registry
+// -----------------------------------------------------------------------
+
+/// Registered name of an object, valid for samples taken in the
+/// generations [first, last)
+struct ObjectRecord {
+    std::string name;
+    uint64_t first, last;
+};
+
+/* Incremented whenever a registered object is destroyed. Samples are keyed
+   on (object, generation), which disambiguates objects that were allocated
+   at the same address over the course of a session. */
+static std::atomic<uint64_t> object_generation { 0 };
+
+struct ObjectRegistry {
+    std::mutex mutex;
+    std::unordered_multimap<const Object *, ObjectRecord> names;
+    /// Number of records of destroyed objects, and when to prune them next
+    size_t retired = 0, prune_threshold = MTS_PROFILE_HASH_SIZE;
+};
+
+/* Intentionally leaked: objects with static storage duration may still be
+   destroyed (and unregister themselves) after this translation unit's
+   static variables are gone. */
+static ObjectRegistry &object_registry() {
+    static ObjectRegistry *registry = new ObjectRegistry();
+    return *registry;
+}
+
+/**
+ * Erase the records of destroyed objects that no sample refers to. At most
+ * one record per hash table entry survives, hence the registry of a long
+ * session (e.g. a render server that reloads scenes) stays bounded. New
+ * samples never refer to destroyed objects, so this is safe while the
+ * sampling signal handler is active. The caller must hold the mutex.
+ */
+static void prune_records(ObjectRegistry &registry) {
+    std::unordered_set<const ObjectRecord *> referenced;
+    for (const ProfilerSample &sample : profiler_samples) {
+        if (sample.count == 0 || !sample.object)
+            continue;
+        auto range = registry.names.equal_range(sample.object);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (sample.generation >= it->second.first &&
+                sample.generation < it->second.last)
+                referenced.insert(&it->second);
+        }
+    }
+
+    for (auto it = registry.names.begin(); it != registry.names.end();) {
+        if (it->second.last != (uint64_t) -1 &&
+            referenced.find(&it->second) == referenced.end()) {
+            it = registry.names.erase(it);
+            registry.retired--;
+        } else {
+            ++it;
+        }
+    }
+
+    registry.prune_threshold =
+        std::max(registry.retired * 2, (size_t) MTS_PROFILE_HASH_SIZE);
+}
+
+void Profiler::register_object(const Object *object, const std::string &name) {
+    ObjectRegistry &registry = object_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    object->m_profiler_registered = true;
+    auto range = registry.names.equal_range(object);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.last == (uint64_t) -1) {
+            it->second.name = name;
+            return;
+        }
+    }
+    registry.names.emplace(object, ObjectRecord{ name, object_generation.load(),
+                                                 (uint64_t) -1 });
+}
+
+void Profiler::unregister_object(const Object *object) {
+    ObjectRegistry &registry = object_registry();
+    std::lock_guard<std::mutex> guard(registry.mutex);
+    auto range = registry.names.equal_range(object);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second.last == (uint64_t) -1) {
+            it->second.last = object_generation++ + 1;
+            if (++registry.retired >= registry.prune_threshold)
+                prune_records(registry);
+            return;
+        }
+    }
+}
+
+void Profiler::register_object(const Object *object, const Properties &props) {
+    std::string id = props.id();
+    if (id.empty() || id.rfind("_unnamed_", 0) == 0)
+        register_object(object, tfm::format("%s (%s)", props.plugin_name(),
+                                            id.empty() ? "unnamed" : id));
+    else
+        register_object(object, tfm::format("%s '%s'", props.plugin_name(), id));
+}
+
+// -----------------------------------------------------------------------
+//  Timeline tracing
+// -----------------------------------------------------------------------
+
+std::atomic<bool> profiler_trace_enabled { false };
+
+/// A completed phase, as recorded by ScopedPhase
+struct TraceEvent {
+    uint64_t start, end;
+    ProfilerPhase phase;
+};
+
+/// Per-thread ring buffer of timeline events
+struct TraceBuffer {
+    std::unique_ptr<TraceEvent[]> events { new TraceEvent[MTS_PROFILE_TRACE_SIZE] };
+    std::atomic<uint64_t> head { 0 };
+    uint32_t thread_index;
+    std::string thread_name;
+};
+
+/// Reference point of all timestamps
+static const auto trace_epoch = std::chrono::steady_clock::now();
+
+/// Ring buffers of all threads that ever recorded an event (never freed,
+/// since events remain accessible after a thread has exited)
+static std::mutex trace_mutex;
+static std::vector<std::unique_ptr<TraceBuffer>> trace_buffers;
+static thread_local TraceBuffer *trace_buffer = nullptr;
+
+uint64_t profiler_trace_time() {
+    auto elapsed = std::chrono::steady_clock::now() - trace_epoch;
+    return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() + 1;
+}
+
+void profiler_trace_event(ProfilerPhase phase, uint64_t start, uint64_t end) {
+    TraceBuffer *buffer = trace_buffer;
+    if (unlikely(!buffer)) {
+        std::lock_guard<std::mutex> guard(trace_mutex);
+        buffer = new TraceBuffer();
+        buffer->thread_index = (uint32_t) trace_buffers.size();
+        Thread *thread = Thread::thread();
+        buffer->thread_name = thread ? thread->name()
+                                     : tfm::format("thread%i", buffer->thread_index);
+        trace_buffers.emplace_back(buffer);
+        trace_buffer = buffer;
+    }
+
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % MTS_PROFILE_TRACE_SIZE] = TraceEvent{ start, end, phase };
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::set_trace_enabled(bool enabled) {
+    profiler_trace_enabled = enabled;
+}
+
+void Profiler::clear_trace() {
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    for (auto &buffer : trace_buffers)
+        buffer->head = 0;
+}
+
+void Profiler::write_trace(const fs::path &filename) {
+    std::lock_guard<std::mutex> guard(trace_mutex);
+    std::ofstream os(filename.string());
+    if (!os.good())
+        Throw("Profiler::write_trace(): unable to open \"%s\"!", filename.string());
+
+    size_t event_count = 0, dropped_count = 0;
+    os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+    os << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, "
+          "\"args\": {\"name\": \"mitsuba\"}}";
+
+    for (auto &buffer : trace_buffers) {
+        os << "," << std::endl
+           << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": "
+           << buffer->thread_index << ", \"args\": {\"name\": \"" << buffer->thread_name
+           << "\"}}";
+
+        uint64_t head = buffer->head.load(std::memory_order_acquire),
+                 first = head > MTS_PROFILE_TRACE_SIZE ? head - MTS_PROFILE_TRACE_SIZE : 0;
+        dropped_count += first;
+
+        for (uint64_t i = first; i < head; ++i) {
+            const TraceEvent &event = buffer->events[i % MTS_PROFILE_TRACE_SIZE];
+            // Chrome expects timestamps and durations in microseconds
+            os << "," << std::endl
+               << "  {\"name\": \"" << profiler_phase_id[int(event.phase)]
+               << "\", \"cat\": \"mitsuba\", \"ph\": \"X\", \"pid\": 0, \"tid\": "
+               << buffer->thread_index << ", \"ts\": " << (event.start / 1000.0)
+               << ", \"dur\": " << ((event.end - event.start) / 1000.0) << "}";
+        }
+        event_count += head - first;
+    }
+    os << std::endl << "]}" << std::endl;
+
+    Log(Info, "Wrote %i timeline events of %i threads to \"%s\".", event_count,
+        trace_buffers.size(), filename.string());
+    if (dropped_count > 0)
+        Log(Warn, "Dropped the %i oldest timeline events -- you may need to "
+                  "increase MTS_PROFILE_TRACE_SIZE.", dropped_count);
+}
+
+// -----------------------------------------------------------------------
+//  Sampling profiler
+// -----------------------------------------------------------------------
+
 static void profiler_callback(int, siginfo_t *, void *) {
-    uint64_t flags = *profiler_flags();
+    const ProfilerState *state = profiler_state();
+    uint64_t flags = state->flags;
+    const Object *object = state->object;
+    uint64_t generation =
+        object ? object_generation.load(std::memory_order_relaxed) : 0;
 
-    uint64_t bucket_id =
-        std::hash<uint64_t>{}(flags) % (profiler_samples.size() - 1);
+    uint64_t hash = std::hash<uint64_t>{}(flags) ^
+                    (std::hash<const void *>{}(object) * 0x9E3779B97F4A7C15ull) ^
+                    (generation * 0xC2B2AE3D27D4EB4Full);
+    uint64_t bucket_id = hash % (profiler_samples.size() - 1);
 
     // Hash table with linear probing
     size_t tries = 0;
     while (tries < profiler_samples.size()) {
         ProfilerSample &bucket = profiler_samples[bucket_id];
-        if (bucket.flags == (uint64_t) -1 || bucket.flags == flags)
+        if (bucket.flags == (uint64_t) -1 ||
+            (bucket.flags == flags && bucket.object == object &&
+             bucket.generation == generation))
             break;
         if (++bucket_id == profiler_samples.size())
             bucket_id = 0;
@@ -47,12 +277,14 @@ static void profiler_callback(int, siginfo_t *, void *) {
 
     ProfilerSample &bucket = profiler_samples[bucket_id];
     bucket.flags = flags;
+    bucket.object = object;
+    bucket.generation = generation;
     bucket.count++;
 }
 
 void Profiler::static_initialization() {
     if (!util::detect_debugger()) {
-        (void) profiler_flags();
+        (void) profiler_state();
 
         struct sigaction sa;
         memset(&sa, 0, sizeof(sa));
@@ -91,7 +323,11 @@ void Profiler::print_report() {
     uint64_t event_count_total = 0,
              buckets_used = 0;
 
-    SampleMap leaf_results, hierarchical_results;
+    SampleMap leaf_results, hierarchical_results, object_results;
+    uint64_t object_count_total = 0;
+
+    ObjectRegistry &registry = object_registry();
+    std::unique_lock<std::mutex> object_guard(registry.mutex);
 
     size_t prefix_length = 0;
     size_t max_indent = 0;
@@ -127,8 +363,25 @@ void Profiler::print_report() {
             hierarchical_results["Idle"] += sample.count;
             leaf_results["Idle"] += sample.count;
         }
+
+        // Attribute the sample to the innermost registered object (if any)
+        if (sample.object && sample.flags != 0) {
+            auto range = registry.names.equal_range(sample.object);
+            for (auto it = range.first; it != range.second; ++it) {
+                const ObjectRecord &record = it->second;
+                if (sample.generation < record.first ||
+                    sample.generation >= record.last)
+                    continue;
+                int leaf = 63 - __builtin_clzll(sample.flags);
+                object_results[record.name + " / " + profiler_phase_id[leaf]] += sample.count;
+                object_count_total += sample.count;
+                break;
+            }
+        }
     }
 
+    object_guard.unlock();
+
     Log(Info, "Recorded %i samples, used %i/%i hash table entries.",
         event_count_total, buckets_used, profiler_samples.size());
 
@@ -145,6 +398,18 @@ void Profiler::print_report() {
         leaf_results_sorted.begin(), leaf_results_sorted.end(),
         [](auto a, auto b) { return a.second > b.second; });
 
+    std::vector<std::pair<std::string, uint64_t>> object_results_sorted(
+        object_results.begin(), object_results.end());
+
+    std::sort(
+        object_results_sorted.begin(), object_results_sorted.end(),
+        [](auto a, auto b) { return a.second > b.second; });
+
+    size_t object_prefix_length = 0;
+    for (const auto &r : object_results_sorted)
+        object_prefix_length = std::max(object_prefix_length, r.first.length());
+    object_prefix_length += 4;
+
     prefix_length += max_indent * 2 + 10;
 
     Log(Info, "\U000023F1  Profile (hierarchical):");
@@ -172,6 +437,17 @@ void Profiler::print_report() {
             std::string(prefix_length - kv.first.length() - 4, ' '),
             kv.second / float(event_count_total) * 100.f);
     }
+
+    if (object_results_sorted.empty())
+        return;
+
+    Log(Info, "\U000023F1  Profile (per object, %.2f%% of all samples):",
+        object_count_total / float(event_count_total) * 100.f);
+    for (auto kv : object_results_sorted) {
+        Log(Info, "    %s%s%.2f%%", kv.first,
+            std::string(object_prefix_length - kv.first.length(), ' '),
+            kv.second / float(event_count_total) * 100.f);
+    }
 }
 
 MTS_IMPLEMENT_CLASS(Profiler, Object)
@@ -106,6 +106,10 @@ MTS_PY_EXPORT(Bitmap) {
         .def("convert", py::overload_cast<Bitmap *>(&Bitmap::convert, py::const_),
             D(Bitmap, convert, 2), "target"_a,
             py::call_guard<py::gil_scoped_release>())
+        .def("convert", py::overload_cast<Bitmap *, ScalarPoint2i, ScalarPoint2i,
+                                          ScalarVector2i>(&Bitmap::convert, py::const_),
+            D(Bitmap, convert, 3), "target"_a, "source_offset"_a, "target_offset"_a,
+            "size"_a, py::call_guard<py::gil_scoped_release>())
         .def("accumulate", py::overload_cast<const Bitmap *, ScalarPoint2i,
                                                 ScalarPoint2i, ScalarVector2i>(
                 &Bitmap::accumulate), D(Bitmap, accumulate),
@@ -195,3 +199,18 @@ MTS_PY_EXPORT(Bitmap) {
             return py::object(result);
         });
 }
+
+MTS_PY_EXPORT(TiledEXRWriter) {
+    using Float = typename TiledEXRWriter::Float;
+    MTS_IMPORT_CORE_TYPES()
+
+    MTS_PY_CLASS(TiledEXRWriter, Object)
+        .def(py::init<const fs::path &, const Bitmap *, const Vector2u &, uint32_t>(),
+             "filename"_a, "layout"_a, "size"_a, "tile_size"_a,
+             D(TiledEXRWriter, TiledEXRWriter))
+        .def_method(TiledEXRWriter, write_tile, "offset"_a, "tile"_a,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(TiledEXRWriter, close)
+        .def_method(TiledEXRWriter, size)
+        .def_method(TiledEXRWriter, tile_size);
+}
@@ -16,6 +16,7 @@ MTS_PY_DECLARE(Properties);
 MTS_PY_DECLARE(Appender);
 MTS_PY_DECLARE(ArgParser);
 MTS_PY_DECLARE(Bitmap);
+MTS_PY_DECLARE(TiledEXRWriter);
 MTS_PY_DECLARE(Formatter);
 MTS_PY_DECLARE(FileResolver);
 MTS_PY_DECLARE(Logger);
@@ -24,9 +25,11 @@ MTS_PY_DECLARE(Stream);
 MTS_PY_DECLARE(DummyStream);
 MTS_PY_DECLARE(FileStream);
 MTS_PY_DECLARE(MemoryStream);
+MTS_PY_DECLARE(SocketStream);
 MTS_PY_DECLARE(ZStream);
 MTS_PY_DECLARE(ProgressReporter);
 MTS_PY_DECLARE(rfilter);
+MTS_PY_DECLARE(Statistics);
 MTS_PY_DECLARE(Thread);
 MTS_PY_DECLARE(util);
 
@@ -61,6 +64,12 @@ PYBIND11_MODULE(core_ext, m) {
     m.attr("MTS_ENABLE_EMBREE") = false;
 #endif
 
+#if defined(MTS_ENABLE_STATISTICS)
+    m.attr("MTS_ENABLE_STATISTICS") = true;
+#else
+    m.attr("MTS_ENABLE_STATISTICS") = false;
+#endif
+
     Jit::static_initialization();
     Class::static_initialization();
     Thread::static_initialization();
@@ -111,6 +120,7 @@ PYBIND11_MODULE(core_ext, m) {
     MTS_PY_IMPORT(rfilter);
     MTS_PY_IMPORT(Stream);
     MTS_PY_IMPORT(Bitmap);
+    MTS_PY_IMPORT(TiledEXRWriter);
     MTS_PY_IMPORT(Formatter);
     MTS_PY_IMPORT(FileResolver);
     MTS_PY_IMPORT(Logger);
@@ -118,8 +128,10 @@ PYBIND11_MODULE(core_ext, m) {
     MTS_PY_IMPORT(DummyStream);
     MTS_PY_IMPORT(FileStream);
     MTS_PY_IMPORT(MemoryStream);
+    MTS_PY_IMPORT(SocketStream);
     MTS_PY_IMPORT(ZStream);
     MTS_PY_IMPORT(ProgressReporter);
+    MTS_PY_IMPORT(Statistics);
     MTS_PY_IMPORT(Thread);
     MTS_PY_IMPORT(util);
 
@@ -34,6 +34,8 @@ MTS_PY_EXPORT(Ray) {
              "o"_a, "d"_a, "time"_a, "wavelengths"_a)
         .def("scale_differential", &RayDifferential3f::scale_differential,
              "amount"_a, D(RayDifferential, scale_differential))
+        .def("set_cone", &RayDifferential3f::set_cone,
+             "width"_a, "spread"_a, D(RayDifferential, set_cone))
         .def_field(RayDifferential3f, o_x, D(RayDifferential, o_x))
         .def_field(RayDifferential3f, o_y, D(RayDifferential, o_y))
         .def_field(RayDifferential3f, d_x, D(RayDifferential, d_x))
@@ -0,0 +1,34 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/python/python.h>
+
+MTS_PY_EXPORT(Statistics) {
+    py::enum_<StatsCounter>(m, "StatsCounter", D(StatsCounter))
+        .value("RaysTraced", StatsCounter::RaysTraced)
+        .value("ShadowRaysTraced", StatsCounter::ShadowRaysTraced)
+        .value("KDNodesVisited", StatsCounter::KDNodesVisited)
+        .value("KDPrimitivesVisited", StatsCounter::KDPrimitivesVisited)
+        .value("RussianRouletteTerminations", StatsCounter::RussianRouletteTerminations)
+        .value("PathSplits", StatsCounter::PathSplits)
+        .value("InvalidSamples", StatsCounter::InvalidSamples);
+
+    MTS_PY_STRUCT(StatsData)
+        .def(py::init<>())
+        .def_field(StatsData, counters, D(StatsData, counters))
+        .def_field(StatsData, path_length, D(StatsData, path_length))
+        .def("__getitem__", [](const StatsData &d, StatsCounter c) { return d[c]; },
+             D(StatsData, operator_array))
+        .def(py::self += py::self, D(StatsData, operator_iadd))
+        .def("__repr__", [](const StatsData &d) {
+            std::ostringstream oss;
+            oss << "StatsData[";
+            for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i)
+                oss << (i > 0 ? ", " : "") << stats_counter_id[i] << "=" << d.counters[i];
+            oss << "]";
+            return oss.str();
+        });
+
+    MTS_PY_CLASS(Statistics, Object)
+        .def_static_method(Statistics, reset)
+        .def_static_method(Statistics, data)
+        .def_static_method(Statistics, summary, "render_time"_a = 0.0);
+}
@@ -2,6 +2,7 @@
 #include <mitsuba/core/dstream.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/sstream.h>
 #include <mitsuba/core/zstream.h>
 
 #include <mitsuba/core/filesystem.h>
@@ -97,6 +98,22 @@ MTS_PY_EXPORT(MemoryStream) {
         .def_method(MemoryStream, owns_buffer);
 }
 
+MTS_PY_EXPORT(SocketStream) {
+    MTS_PY_CLASS(SocketStream, Stream)
+        .def(py::init<const std::string &, uint16_t>(), D(SocketStream, SocketStream),
+            "host"_a, "port"_a)
+        .def_method(SocketStream, peer)
+        .def_method(SocketStream, received)
+        .def_method(SocketStream, sent);
+
+    MTS_PY_CLASS(ServerSocket, Object)
+        .def(py::init<uint16_t>(), D(ServerSocket, ServerSocket), "port"_a = 0)
+        .def("accept", &ServerSocket::accept, D(ServerSocket, accept),
+             "timeout"_a = -1, py::call_guard<py::gil_scoped_release>())
+        .def_method(ServerSocket, close)
+        .def_method(ServerSocket, port);
+}
+
 MTS_PY_EXPORT(ZStream) {
     auto c = MTS_PY_CLASS(ZStream, Stream);
 
@@ -0,0 +1,297 @@
+#include <mitsuba/core/sstream.h>
+#include <sstream>
+#include <climits>
+#include <cstring>
+
+#if defined(__WINDOWS__)
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#  pragma comment(lib, "ws2_32.lib")
+   using socklen_t = int;
+#  define MTS_INVALID_SOCKET ((int64_t) INVALID_SOCKET)
+#  define MTS_SOCKET(s) ((SOCKET) (s))
+#  define MTS_CLOSE_SOCKET(s) closesocket(MTS_SOCKET(s))
+#  define MTS_SEND_FLAGS 0
+#else
+#  include <sys/socket.h>
+#  include <sys/select.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <netdb.h>
+#  include <arpa/inet.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  define MTS_INVALID_SOCKET ((int64_t) -1)
+#  define MTS_SOCKET(s) ((int) (s))
+#  define MTS_CLOSE_SOCKET(s) ::close(MTS_SOCKET(s))
+#  if defined(MSG_NOSIGNAL)
+#    define MTS_SEND_FLAGS MSG_NOSIGNAL
+#  else
+#    define MTS_SEND_FLAGS 0
+#  endif
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Return a description of the last socket error
+static std::string socket_error() {
+#if defined(__WINDOWS__)
+    return tfm::format("error code %i", WSAGetLastError());
+#else
+    return strerror(errno);
+#endif
+}
+
+/// Initialize the socket library (only needed on Windows)
+static void socket_init() {
+#if defined(__WINDOWS__)
+    static bool initialized = [] {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            Throw("Could not initialize the Winsock library!");
+        return true;
+    }();
+    (void) initialized;
+#endif
+}
+
+/// Configure a connected socket for low-latency request/response traffic
+static void socket_configure(int64_t socket) {
+    int value = 1;
+    setsockopt(MTS_SOCKET(socket), IPPROTO_TCP, TCP_NODELAY,
+               (const char *) &value, sizeof(int));
+#if defined(SO_NOSIGPIPE)
+    setsockopt(MTS_SOCKET(socket), SOL_SOCKET, SO_NOSIGPIPE,
+               (const char *) &value, sizeof(int));
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+SocketStream::SocketStream(const std::string &host, uint16_t port)
+    : Stream(), m_socket(MTS_INVALID_SOCKET), m_received(0), m_sent(0) {
+    socket_init();
+
+    addrinfo hints, *servinfo = nullptr;
+    memset(&hints, 0, sizeof(addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    std::string port_str = std::to_string(port);
+    int rv = getaddrinfo(host.c_str(), port_str.c_str(), &hints, &servinfo);
+    if (rv != 0)
+        Throw("Could not resolve the host name \"%s\": %s", host, gai_strerror(rv));
+
+    std::string reason;
+    for (addrinfo *p = servinfo; p != nullptr; p = p->ai_next) {
+        int64_t s = (int64_t) ::socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (s == MTS_INVALID_SOCKET) {
+            reason = socket_error();
+            continue;
+        }
+        if (::connect(MTS_SOCKET(s), p->ai_addr, (socklen_t) p->ai_addrlen) != 0) {
+            reason = socket_error();
+            MTS_CLOSE_SOCKET(s);
+            continue;
+        }
+        m_socket = s;
+        break;
+    }
+    freeaddrinfo(servinfo);
+
+    if (m_socket == MTS_INVALID_SOCKET)
+        Throw("Could not connect to \"%s:%i\": %s", host, port, reason);
+
+    socket_configure(m_socket);
+    m_peer = tfm::format("%s:%i", host, port);
+}
+
+SocketStream::SocketStream(int64_t socket, const std::string &peer)
+    : Stream(), m_socket(socket), m_peer(peer), m_received(0), m_sent(0) {
+    socket_configure(m_socket);
+}
+
+SocketStream::~SocketStream() {
+    close();
+}
+
+void SocketStream::close() {
+    if (m_socket == MTS_INVALID_SOCKET)
+        return;
+    MTS_CLOSE_SOCKET(m_socket);
+    m_socket = MTS_INVALID_SOCKET;
+}
+
+bool SocketStream::is_closed() const { return m_socket == MTS_INVALID_SOCKET; }
+
+void SocketStream::read(void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to read from a closed stream: %s", to_string());
+
+    char *ptr = (char *) p;
+    while (size > 0) {
+        int rv = ::recv(MTS_SOCKET(m_socket), ptr, (int) std::min(size, (size_t) INT_MAX), 0);
+        if (rv == 0)
+            Throw("Connection to %s was closed by the remote side!", m_peer);
+        if (rv < 0) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("Could not read from %s: %s", m_peer, socket_error());
+        }
+        ptr += rv;
+        size -= (size_t) rv;
+        m_received += (size_t) rv;
+    }
+}
+
+void SocketStream::write(const void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to write to a closed stream: %s", to_string());
+
+    const char *ptr = (const char *) p;
+    while (size > 0) {
+        int rv = ::send(MTS_SOCKET(m_socket), ptr, (int) std::min(size, (size_t) INT_MAX),
+                        MTS_SEND_FLAGS);
+        if (rv < 0) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("Could not write to %s: %s", m_peer, socket_error());
+        }
+        ptr += rv;
+        size -= (size_t) rv;
+        m_sent += (size_t) rv;
+    }
+}
+
+void SocketStream::seek(size_t) {
+    Throw("SocketStream does not support seeking.");
+}
+
+void SocketStream::truncate(size_t) {
+    Throw("SocketStream does not support truncation.");
+}
+
+std::string SocketStream::to_string() const {
+    std::ostringstream oss;
+
+    oss << class_()->name() << "[" << std::endl;
+    if (is_closed()) {
+        oss << "  closed" << std::endl;
+    } else {
+        oss << "  peer = \"" << m_peer << "\"" << "," << std::endl
+            << "  host_byte_order = " << host_byte_order() << "," << std::endl
+            << "  byte_order = " << byte_order() << "," << std::endl
+            << "  received = " << m_received << "," << std::endl
+            << "  sent = " << m_sent << std::endl;
+    }
+
+    oss << "]";
+    return oss.str();
+}
+
+// -----------------------------------------------------------------------------
+
+ServerSocket::ServerSocket(uint16_t port) : m_socket(MTS_INVALID_SOCKET), m_port(port) {
+    socket_init();
+
+    int64_t s = (int64_t) ::socket(AF_INET, SOCK_STREAM, 0);
+    if (s == MTS_INVALID_SOCKET)
+        Throw("Could not create a socket: %s", socket_error());
+
+    int value = 1;
+    setsockopt(MTS_SOCKET(s), SOL_SOCKET, SO_REUSEADDR, (const char *) &value, sizeof(int));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(sockaddr_in));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+
+    if (::bind(MTS_SOCKET(s), (sockaddr *) &addr, sizeof(sockaddr_in)) != 0 ||
+        ::listen(MTS_SOCKET(s), SOMAXCONN) != 0) {
+        std::string reason = socket_error();
+        MTS_CLOSE_SOCKET(s);
+        Throw("Could not listen on port %i: %s", port, reason);
+    }
+
+    socklen_t addr_len = sizeof(sockaddr_in);
+    if (::getsockname(MTS_SOCKET(s), (sockaddr *) &addr, &addr_len) == 0)
+        m_port = ntohs(addr.sin_port);
+
+    m_socket = s;
+}
+
+ServerSocket::~ServerSocket() {
+    close();
+}
+
+void ServerSocket::close() {
+    if (m_socket == MTS_INVALID_SOCKET)
+        return;
+    MTS_CLOSE_SOCKET(m_socket);
+    m_socket = MTS_INVALID_SOCKET;
+}
+
+ref<SocketStream> ServerSocket::accept(int timeout) {
+    if (m_socket == MTS_INVALID_SOCKET)
+        Throw("ServerSocket::accept(): the socket was closed!");
+
+    while (true) {
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(MTS_SOCKET(m_socket), &fds);
+
+        timeval tv;
+        tv.tv_sec = timeout / 1000;
+        tv.tv_usec = (timeout % 1000) * 1000;
+
+        int rv = ::select((int) m_socket + 1, &fds, nullptr, nullptr,
+                          timeout < 0 ? nullptr : &tv);
+        if (rv == 0)
+            return nullptr;
+        if (rv < 0) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR)
+                continue;
+#endif
+            Throw("ServerSocket::accept(): %s", socket_error());
+        }
+
+        sockaddr_storage addr;
+        socklen_t addr_len = sizeof(sockaddr_storage);
+        int64_t s = (int64_t) ::accept(MTS_SOCKET(m_socket), (sockaddr *) &addr, &addr_len);
+        if (s == MTS_INVALID_SOCKET) {
+#if !defined(__WINDOWS__)
+            if (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED)
+                continue;
+#endif
+            Throw("ServerSocket::accept(): %s", socket_error());
+        }
+
+        char host[NI_MAXHOST], service[NI_MAXSERV];
+        std::string peer = "unknown";
+        if (getnameinfo((sockaddr *) &addr, addr_len, host, NI_MAXHOST, service,
+                        NI_MAXSERV, NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+            peer = tfm::format("%s:%s", host, service);
+
+        return new SocketStream(s, peer);
+    }
+}
+
+std::string ServerSocket::to_string() const {
+    std::ostringstream oss;
+    oss << "ServerSocket[" << std::endl
+        << "  port = " << m_port << "," << std::endl
+        << "  closed = " << (m_socket == MTS_INVALID_SOCKET) << std::endl
+        << "]";
+    return oss.str();
+}
+
+MTS_IMPLEMENT_CLASS(SocketStream, Stream)
+MTS_IMPLEMENT_CLASS(ServerSocket, Object)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,122 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/logger.h>
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+#if defined(MTS_ENABLE_STATISTICS)
+/// Protects the registry of per-thread counters below
+static std::mutex stats_mutex;
+
+/// Counters of all threads that are currently alive
+static std::vector<StatsData *> stats_threads;
+
+/// Counters of threads that have already exited
+static StatsData stats_retired;
+
+/// Registers the counters of a thread upon creation and retires them on exit
+struct StatsThreadData {
+    StatsData data;
+
+    StatsThreadData() {
+        std::lock_guard<std::mutex> guard(stats_mutex);
+        stats_threads.push_back(&data);
+    }
+
+    ~StatsThreadData() {
+        std::lock_guard<std::mutex> guard(stats_mutex);
+        stats_retired += data;
+        stats_threads.erase(
+            std::remove(stats_threads.begin(), stats_threads.end(), &data),
+            stats_threads.end());
+    }
+};
+
+static thread_local StatsThreadData stats_thread_data;
+StatsData *stats_data() { return &stats_thread_data.data; }
+
+void Statistics::reset() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    for (StatsData *data : stats_threads)
+        *data = StatsData();
+    stats_retired = StatsData();
+}
+
+StatsData Statistics::data() {
+    std::lock_guard<std::mutex> guard(stats_mutex);
+    StatsData result = stats_retired;
+    for (const StatsData *data : stats_threads)
+        result += *data;
+    return result;
+}
+#else
+void Statistics::reset() { }
+StatsData Statistics::data() { return StatsData(); }
+#endif
+
+/// Format a large count using a metric suffix (e.g. "12.34 M")
+static std::string count_string(double value) {
+    const char *suffixes[] = { "", " K", " M", " G", " T" };
+    int suffix = 0;
+    while (value >= 1000.0 && suffix < 4) {
+        value /= 1000.0;
+        suffix++;
+    }
+    return tfm::format(suffix == 0 ? "%.0f%s" : "%.2f%s", value, suffixes[suffix]);
+}
+
+std::string Statistics::summary(double render_time) {
+#if defined(MTS_ENABLE_STATISTICS)
+    StatsData stats = data();
+    std::ostringstream oss;
+
+    uint64_t rays = stats[StatsCounter::RaysTraced],
+             shadow_rays = stats[StatsCounter::ShadowRaysTraced],
+             total_rays = rays + shadow_rays;
+
+    oss << "Statistics:" << std::endl;
+    for (int i = 0; i < int(StatsCounter::StatsCounterCount); ++i) {
+        StatsCounter counter = StatsCounter(i);
+        uint64_t value = stats[counter];
+        oss << tfm::format("    %-32s%s", stats_counter_id[i], count_string((double) value));
+
+        if ((counter == StatsCounter::RaysTraced ||
+             counter == StatsCounter::ShadowRaysTraced) && render_time > 0.0)
+            oss << tfm::format(" (%s rays/sec)", count_string(value / render_time));
+        else if ((counter == StatsCounter::KDNodesVisited ||
+                  counter == StatsCounter::KDPrimitivesVisited) && total_rays > 0)
+            oss << tfm::format(" (%.2f per ray)", value / (double) total_rays);
+        oss << std::endl;
+    }
+
+    uint64_t path_count = 0;
+    size_t max_bin = 0;
+    for (size_t i = 0; i < stats.path_length.size(); ++i) {
+        path_count += stats.path_length[i];
+        if (stats.path_length[i] > 0)
+            max_bin = i;
+    }
+
+    if (path_count > 0) {
+        oss << "    Path length histogram:" << std::endl;
+        for (size_t i = 0; i <= max_bin; ++i) {
+            bool last = i + 1 == stats.path_length.size();
+            oss << tfm::format("      %2i%s %6.2f%%", i, last ? "+" : " ",
+                               stats.path_length[i] * 100.0 / path_count);
+            if (i != max_bin)
+                oss << std::endl;
+        }
+    }
+
+    return oss.str();
+#else
+    (void) render_time;
+    return "Statistics: disabled (compile with MTS_ENABLE_STATISTICS to enable them).";
+#endif
+}
+
+MTS_IMPLEMENT_CLASS(Statistics, Object)
+NAMESPACE_END(mitsuba)
@@ -7,8 +7,11 @@
 #include <enoki/array.h>
 #include <enoki/half.h>
 #include <enoki/color.h>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <unordered_map>
 #include <ostream>
+#include <atomic>
 #include <map>
 
 /// Set this to '1' to view generated conversion code
@@ -16,6 +19,16 @@
 #  define MTS_JIT_LOG_ASSEMBLY 0
 #endif
 
+/// Number of pixels processed at once by the vectorized fallback (non-JIT builds)
+#if !defined(MTS_STRUCTCONVERTER_PACKET_SIZE)
+#  define MTS_STRUCTCONVERTER_PACKET_SIZE 8
+#endif
+
+/// Minimum number of pixels converted by each thread in StructConverter::convert_2d()
+#if !defined(MTS_STRUCTCONVERTER_GRAIN_SIZE)
+#  define MTS_STRUCTCONVERTER_GRAIN_SIZE 16384
+#endif
+
 NAMESPACE_BEGIN(mitsuba)
 
 // Defined in dither-matrix256.cpp
@@ -1192,9 +1205,11 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
 
     X86Compiler cc(&code);
 
-    cc.addFunc(FuncSignature4<bool, size_t, size_t, const void *, void *>(asmjit::CallConv::kIdHost));
+    cc.addFunc(FuncSignature5<bool, size_t, size_t, size_t, const void *, void *>(
+        asmjit::CallConv::kIdHost));
     auto width = cc.newInt64("width");
     auto height = cc.newInt64("height");
+    auto y_offset = cc.newInt64("y_offset");
     auto input = cc.newIntPtr("input");
     auto output = cc.newIntPtr("output");
     auto x = cc.newUInt64("x");
@@ -1202,8 +1217,9 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
 
     cc.setArg(0, width);
     cc.setArg(1, height);
-    cc.setArg(2, input);
-    cc.setArg(3, output);
+    cc.setArg(2, y_offset);
+    cc.setArg(3, input);
+    cc.setArg(4, output);
 
     // Control flow structure
     Label loop_start = cc.newLabel();
@@ -1217,9 +1233,11 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
     cc.jz(loop_y_end);
     cc.xor_(x, x);
 
+    // Rows are numbered starting at 'y_offset', 'height' becomes the end index
     cc.test(height, height);
     cc.jz(loop_y_end);
-    cc.xor_(y, y);
+    cc.mov(y, y_offset);
+    cc.add(height, y_offset);
 
     cc.bind(loop_start);
 
@@ -1342,6 +1360,7 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
     __cache[key] = (void *) m_func;
 #else
     m_dither = dither;
+    m_fast = fast_init();
 #endif
 }
 
@@ -1602,8 +1621,193 @@ void StructConverter::save(uint8_t *dst, const Struct::Field &f, Value value, si
     }
 }
 
-bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_) const {
+bool StructConverter::fast_init() {
+    auto supported = [](Struct::Type type) {
+        return type == Struct::Type::UInt8 || type == Struct::Type::Float16 ||
+               type == Struct::Type::Float32;
+    };
+
+    auto make_input = [&](const Struct::Field &f, float weight) {
+        FastInput input;
+        input.offset = f.offset;
+        input.type = f.type;
+        input.scale = (f.type == Struct::Type::UInt8 &&
+                       has_flag(f.flags, Struct::Flags::Normalized)) ? 1.f / 255.f : 1.f;
+        input.weight = weight;
+        input.gamma = has_flag(f.flags, Struct::Flags::Gamma);
+        return input;
+    };
+
+    if (m_source->byte_order() != Struct::host_byte_order() ||
+        m_target->byte_order() != Struct::host_byte_order())
+        return false;
+
+    m_fast_has_weight = false;
+    for (const Struct::Field &f : *m_source) {
+        if (!supported(f.type) || has_flag(f.flags, Struct::Flags::Assert))
+            return false;
+        if (has_flag(f.flags, Struct::Flags::Weight)) {
+            m_fast_weight = make_input(f, 1.f);
+            m_fast_has_weight = true;
+        }
+    }
+
+    for (const Struct::Field &f : *m_target) {
+        if (has_flag(f.flags, Struct::Flags::Weight) && m_fast_has_weight)
+            m_fast_has_weight = false;
+    }
+
+    uint32_t flag_mask = Struct::Flags::Normalized | Struct::Flags::Gamma;
+    m_fast_fields.clear();
+
+    for (const Struct::Field &f : *m_target) {
+        if (!supported(f.type))
+            return false;
+
+        FastField ff;
+        ff.field = &f;
+        ff.copy = false;
+
+        if (!f.blend.empty()) {
+            for (auto kv : f.blend) {
+                if (!m_source->has_field(kv.second))
+                    return false;
+                ff.inputs.push_back(make_input(m_source->field(kv.second), (float) kv.first));
+            }
+        } else if (m_source->has_field(f.name)) {
+            const Struct::Field &sf = m_source->field(f.name);
+            ff.inputs.push_back(make_input(sf, 1.f));
+            // Same representation: copy bits (like the generic implementation)
+            ff.copy = sf.type == f.type && !m_fast_has_weight &&
+                      (sf.flags & flag_mask) == (f.flags & flag_mask);
+        } else if (!has_flag(f.flags, Struct::Flags::Default)) {
+            return false;
+        }
+
+        m_fast_fields.push_back(ff);
+    }
+
+    return true;
+}
+
+bool StructConverter::fast_convert_rows(size_t width, size_t height, size_t y_offset,
+                                        const uint8_t *src, uint8_t *dest) const {
+    using FloatP = Packet<float, MTS_STRUCTCONVERTER_PACKET_SIZE>;
+    constexpr size_t N = array_size_v<FloatP>;
+
+    size_t source_size = m_source->size(),
+           target_size = m_target->size();
+
+    alignas(64) float buf[N];
+
+    // Load and linearize an input field of 'count' consecutive pixels
+    auto load_input = [&](const FastInput &input, const uint8_t *ptr, size_t count) {
+        ptr += input.offset;
+        for (size_t i = 0; i < N; ++i, ptr += source_size) {
+            float value = 0.f;
+            if (i < count) {
+                switch (input.type) {
+                    case Struct::Type::UInt8:
+                        value = (float) *ptr;
+                        break;
+
+                    case Struct::Type::Float16: {
+                            uint16_t h;
+                            memcpy(&h, ptr, sizeof(uint16_t));
+                            value = enoki::half::float16_to_float32(h);
+                        }
+                        break;
+
+                    default:
+                        memcpy(&value, ptr, sizeof(float));
+                        break;
+                }
+            }
+            buf[i] = value;
+        }
+
+        FloatP value = load<FloatP>(buf) * input.scale;
+        if (input.gamma)
+            value = srgb_to_linear(value);
+        return value;
+    };
+
+    for (size_t y = y_offset; y < y_offset + height; ++y) {
+        for (size_t x = 0; x < width; x += N) {
+            size_t count = std::min(N, width - x);
+
+            FloatP inv_weight(1.f);
+            if (m_fast_has_weight)
+                inv_weight = 1.f / load_input(m_fast_weight, src, count);
+
+            for (const FastField &ff : m_fast_fields) {
+                const Struct::Field &f = *ff.field;
+                uint8_t *ptr = dest + f.offset;
+
+                if (ff.copy) {
+                    const uint8_t *src_ptr = src + ff.inputs[0].offset;
+                    for (size_t i = 0; i < count; ++i)
+                        memcpy(ptr + i * target_size, src_ptr + i * source_size, f.size);
+                    continue;
+                }
+
+                FloatP value;
+                if (ff.inputs.empty()) {
+                    value = FloatP((float) f.default_);
+                } else {
+                    value = zero<FloatP>();
+                    for (const FastInput &input : ff.inputs)
+                        value = fmadd(load_input(input, src, count), input.weight, value);
+                }
+
+                value *= inv_weight;
+
+                if (has_flag(f.flags, Struct::Flags::Gamma))
+                    value = linear_to_srgb(value);
+
+                if (f.type == Struct::Type::UInt8) {
+                    if (has_flag(f.flags, Struct::Flags::Normalized))
+                        value *= 255.f;
+
+                    if (m_dither) {
+                        const float *dither_row = dither_matrix256 + (y % 256) * 256;
+                        for (size_t i = 0; i < N; ++i)
+                            buf[i] = dither_row[(x + i) % 256];
+                        value += load<FloatP>(buf);
+                    }
+
+                    store<FloatP>(buf, round(clamp(value, 0.f, 255.f)));
+                    for (size_t i = 0; i < count; ++i)
+                        ptr[i * target_size] = (uint8_t) buf[i];
+                } else if (f.type == Struct::Type::Float16) {
+                    store<FloatP>(buf, value);
+                    for (size_t i = 0; i < count; ++i) {
+                        uint16_t h = enoki::half::float32_to_float16(buf[i]);
+                        memcpy(ptr + i * target_size, &h, sizeof(uint16_t));
+                    }
+                } else {
+                    store<FloatP>(buf, value);
+                    for (size_t i = 0; i < count; ++i)
+                        memcpy(ptr + i * target_size, buf + i, sizeof(float));
+                }
+            }
+
+            src  += count * source_size;
+            dest += count * target_size;
+        }
+    }
+
+    return true;
+}
+
+bool StructConverter::convert_rows(size_t width, size_t height, size_t y_offset,
+                                   const void *src_, void *dest_) const {
     using namespace mitsuba::detail;
+
+    if (m_fast)
+        return fast_convert_rows(width, height, y_offset, (const uint8_t *) src_,
+                                 (uint8_t *) dest_);
+
     using Float = float;
 
     size_t source_size = m_source->size();
@@ -1628,7 +1832,7 @@ bool StructConverter::convert_2d(size_t width, size_t height, const void *src_,
     uint8_t *src  = (uint8_t *) src_;
     uint8_t *dest = (uint8_t *) dest_;
 
-    for (size_t y = 0; y<height; ++y) {
+    for (size_t y = y_offset; y < y_offset + height; ++y) {
         for (size_t x = 0; x<width; ++x) {
             Float inv_weight = 1.f;
             for (const Struct::Field &f : assert_fields) {
@@ -1691,6 +1895,49 @@ bool StructConverter::convert_2d(size_t width, size_t height, const void *src_,
 }
 #endif
 
+bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_,
+                                 size_t src_stride, size_t dest_stride) const {
+    const uint8_t *src = (const uint8_t *) src_;
+    uint8_t *dest = (uint8_t *) dest_;
+
+    bool contiguous = src_stride  == width * m_source->size() &&
+                      dest_stride == width * m_target->size();
+
+    auto convert_range = [&](size_t y_begin, size_t y_end) {
+        const uint8_t *src_row = src + y_begin * src_stride;
+        uint8_t *dest_row = dest + y_begin * dest_stride;
+
+        if (contiguous)
+            return convert_rows(width, y_end - y_begin, y_begin, src_row, dest_row);
+
+        for (size_t y = y_begin; y < y_end; ++y) {
+            if (!convert_rows(width, 1, y, src_row, dest_row))
+                return false;
+            src_row += src_stride;
+            dest_row += dest_stride;
+        }
+        return true;
+    };
+
+    // Each parallel work unit converts at least this many pixels
+    size_t grain_size = std::max((size_t) 1, MTS_STRUCTCONVERTER_GRAIN_SIZE /
+                                                 std::max(width, (size_t) 1));
+
+    if (height <= grain_size)
+        return convert_range(0, height);
+
+    std::atomic<bool> success { true };
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, height, grain_size),
+        [&](const tbb::blocked_range<size_t> &range) {
+            if (!convert_range(range.begin(), range.end()))
+                success = false;
+        }
+    );
+
+    return success;
+}
+
 std::string StructConverter::to_string() const {
     std::ostringstream oss;
     oss << "StructConverter[" << std::endl
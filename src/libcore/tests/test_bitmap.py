@@ -223,3 +223,51 @@ def test_accumulate():
     # but (row, column) in arrays.
     b1.accumulate(b2, [5, 3], [3, 1], [1, 5])
     assert np.all(np.array(b1, copy=False) == ref)
+
+
+def test_convert_region():
+    # Tests RGB(float32) -> Y (float32) conversion of a sub-frame
+    b1 = Bitmap(Bitmap.PixelFormat.RGB, Struct.Type.Float32, [10, 8])
+    b1_np = np.array(b1, copy=False)
+    b1_np[:] = np.arange(b1.height() * b1.width() * 3).reshape(b1_np.shape)
+
+    b2 = Bitmap(Bitmap.PixelFormat.Y, Struct.Type.Float32, [6, 6])
+    b2_np = np.array(b2, copy=False)
+    b2_np[:] = -1
+
+    # Convert the 4x3 region at (2, 1) into position (1, 2) of the target
+    b1.convert(b2, [2, 1], [1, 2], [4, 3])
+
+    ref = -np.ones((6, 6, 1))
+    ref[2:5, 1:5, 0] = np.dot(b1_np[1:4, 2:6, :], [0.212671, 0.715160, 0.072169])
+    assert np.allclose(b2_np, ref, rtol=1e-5)
+
+    # Out-of-bounds regions are clipped
+    b1.convert(b2, [8, 6], [4, 4], [5, 5])
+    ref[4:6, 4:6, 0] = np.dot(b1_np[6:8, 8:10, :], [0.212671, 0.715160, 0.072169])
+    assert np.allclose(b2_np, ref, rtol=1e-5)
+
+
+def test_convert_parallel():
+    from mitsuba.core import set_thread_count
+
+    # Large images are converted by several threads in bands of rows
+    b1 = Bitmap(Bitmap.PixelFormat.RGB, Struct.Type.Float32, [1000, 700])
+    b1_np = np.array(b1, copy=False)
+    b1_np[:] = np.random.uniform(size=b1_np.shape)
+
+    b2 = np.array(b1.convert(Bitmap.PixelFormat.Y, Struct.Type.Float32, False))
+    ref = np.dot(b1_np, [0.212671, 0.715160, 0.072169])
+    assert np.allclose(b2[:, :, 0], ref, rtol=1e-5)
+
+    # Dithering must not depend on how the rows were distributed: compare
+    # against a single-threaded conversion of the same image
+    b3 = np.array(b1.convert(Bitmap.PixelFormat.RGB, Struct.Type.UInt8, True))
+    try:
+        set_thread_count(1)
+        b4 = np.array(b1.convert(Bitmap.PixelFormat.RGB, Struct.Type.UInt8, True))
+        b5 = np.array(b1.convert(Bitmap.PixelFormat.Y, Struct.Type.Float32, False))
+    finally:
+        set_thread_count()
+    assert np.all(b3 == b4)
+    assert np.all(b2 == b5)
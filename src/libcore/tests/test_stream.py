@@ -283,3 +283,37 @@ def test08_fstream(rw, tmpfile):
     else:
         with pytest.raises(RuntimeError):
             FileStream(new_name)
+
+
+def test09_socket_stream():
+    from mitsuba.core import ServerSocket, SocketStream
+
+    server = ServerSocket()
+    assert server.port() > 0
+    assert server.accept(timeout=0) is None
+
+    client = SocketStream('localhost', server.port())
+    remote = server.accept(timeout=1000)
+    assert remote is not None
+    assert client.can_read() and client.can_write()
+
+    client.write_string('hello world')
+    client.write_float(1.5)
+    assert remote.read_string() == 'hello world'
+    assert remote.read_float() == 1.5
+    assert client.sent() == remote.received() == 19
+    assert client.size() == remote.tell() == 19
+
+    with pytest.raises(RuntimeError):
+        client.seek(0)
+    with pytest.raises(RuntimeError):
+        client.truncate(0)
+
+    # Reading from a connection that was closed by the remote side fails
+    client.close()
+    with pytest.raises(RuntimeError):
+        remote.read_int32()
+
+    server.close()
+    with pytest.raises(RuntimeError):
+        SocketStream('localhost', server.port())
@@ -278,3 +278,31 @@ def test19_invalid_vector(variant_scalar_rgb):
                    <vector name="10" value="1, 2, 3" x="4"/>
                    </scene>""")
     e.match(err_str3)
+
+
+def test20_shared_reference(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    scene = xml.load_string("""<scene version="2.0.0">
+                   <bsdf type="diffuse" id="my_bsdf"/>
+                   <shape type="sphere">
+                       <ref id="my_bsdf"/>
+                   </shape>
+                   <shape type="sphere">
+                       <point name="center" x="3" y="0" z="0"/>
+                       <ref id="my_bsdf"/>
+                   </shape>
+                   </scene>""")
+    assert len(scene.shapes()) == 2
+
+
+def test21_cyclic_reference(variant_scalar_rgb):
+    from mitsuba.core import xml
+
+    with pytest.raises(Exception) as e:
+        xml.load_string("""<scene version="2.0.0">
+                   <bsdf type="twosided" id="my_bsdf">
+                       <ref id="my_bsdf"/>
+                   </bsdf>
+                   </scene>""")
+    e.match('"my_bsdf" \\(indirectly\\) references itself')
@@ -1,5 +1,7 @@
+#include <atomic>
 #include <cctype>
 #include <fstream>
+#include <mutex>
 #include <set>
 #include <unordered_map>
 
@@ -15,7 +17,9 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
 #include <pugixml.hpp>
@@ -225,7 +229,6 @@ struct XMLObject {
     std::function<std::string(ptrdiff_t)> offset;
     size_t location = 0;
     ref<Object> object;
-    tbb::spin_mutex mutex;
 };
 
 enum class ColorMode {
@@ -983,70 +986,56 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
     return std::make_pair("", "");
 }
 
-static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id) {
-    auto it = ctx.instances.find(id);
-    if (it == ctx.instances.end())
-        Throw("reference to unknown object \"%s\"!", id);
-
-    auto &inst = it->second;
-    tbb::spin_mutex::scoped_lock lock(inst.mutex);
-
-    if (inst.object) {
-        return inst.object;
-    } else if (!inst.alias.empty()) {
-        std::string alias = inst.alias;
-        lock.release();
-        return instantiate_node(ctx, alias);
+/// Follow the chain of aliases starting at \c id and return the ID of the actual object
+static std::string resolve_alias(XMLParseContext &ctx, const std::string &id) {
+    std::string current = id;
+    for (size_t i = 0; ; ++i) {
+        auto it = ctx.instances.find(current);
+        if (it == ctx.instances.end())
+            Throw("reference to unknown object \"%s\"!", current);
+        if (it->second.alias.empty())
+            return current;
+        if (i > ctx.instances.size())
+            Throw("alias \"%s\" references itself!", id);
+        current = it->second.alias;
     }
+}
 
+/**
+ * Instantiate a single object. All of its named references must already have
+ * been instantiated, which is guaranteed by the dependency graph constructed
+ * in \ref instantiate_graph().
+ */
+static void instantiate_object(XMLParseContext &ctx, XMLObject &inst) {
+    Timer timer;
     Properties &props = inst.props;
     const auto &named_references = props.named_references();
 
-    ThreadEnvironment env;
-
-    auto functor = [&](const tbb::blocked_range<uint32_t> &range) {
-        ScopedSetThreadEnvironment set_env(env);
-        for (uint32_t i = range.begin(); i != range.end(); ++i) {
-            auto &kv = named_references[i];
-            try {
-                ref<Object> obj;
-                auto instantiate_recursively = [&]() {
-                    obj = instantiate_node(ctx, kv.second);
-                };
-
-                // Potentially isolate from parent tasks to prevent deadlocks
-                if (ctx.parallelize)
-                    tbb::this_task_arena::isolate(instantiate_recursively);
-                else
-                    instantiate_recursively();
-
-                // Give the object a chance to recursively expand into sub-objects
-                std::vector<ref<Object>> children = obj->expand();
-                if (children.empty()) {
-                    props.set_object(kv.first, obj, false);
-                } else if (children.size() == 1) {
-                    props.set_object(kv.first, children[0], false);
-                } else {
-                    int ctr = 0;
-                    for (auto c : children)
-                        props.set_object(kv.first + "_" + std::to_string(ctr++), children[0], false);
-                }
-            } catch (const std::exception &e) {
-                if (strstr(e.what(), "Error while loading") == nullptr)
-                    Throw("Error while loading \"%s\" (near %s): %s",
-                          inst.src_id, inst.offset(inst.location), e.what());
-                else
-                    throw;
+    for (auto &kv : named_references) {
+        try {
+            ref<Object> obj = ctx.instances.find(resolve_alias(ctx, kv.second))->second.object;
+            if (!obj)
+                Throw("object \"%s\" was not instantiated!", (const std::string &) kv.second);
+
+            // Give the object a chance to recursively expand into sub-objects
+            std::vector<ref<Object>> children = obj->expand();
+            if (children.empty()) {
+                props.set_object(kv.first, obj, false);
+            } else if (children.size() == 1) {
+                props.set_object(kv.first, children[0], false);
+            } else {
+                int ctr = 0;
+                for (auto c : children)
+                    props.set_object(kv.first + "_" + std::to_string(ctr++), children[0], false);
             }
+        } catch (const std::exception &e) {
+            if (strstr(e.what(), "Error while loading") == nullptr)
+                Throw("Error while loading \"%s\" (near %s): %s",
+                      inst.src_id, inst.offset(inst.location), e.what());
+            else
+                throw;
         }
-    };
-
-    tbb::blocked_range<uint32_t> range(0u, (uint32_t) named_references.size(), 1);
-
-    if (ctx.parallelize)
-        tbb::parallel_for(range, functor);
-    else
-        functor(range);
+    }
 
     try {
         inst.object = PluginManager::instance()->create_object(props, inst.class_);
@@ -1077,7 +1066,124 @@ static ref<Object> instantiate_node(XMLParseContext &ctx, const std::string &id)
               unqueried.size() > 1 ? "properties" : "property", unqueried,
               string::to_lower(inst.class_->name()), props.plugin_name());
     }
-    return inst.object;
+
+    Log(Debug, "Loaded %s plugin of type \"%s\" (\"%s\") in %s",
+        string::to_lower(inst.class_->name()), props.plugin_name(), props.id(),
+        util::time_string(timer.value()));
+}
+
+/**
+ * Instantiate the object \c id along with everything it (transitively)
+ * references.
+ *
+ * The loader first builds an explicit dependency graph of all reachable
+ * objects, where each object depends on the objects it references. When
+ * parallel loading is enabled, the graph is then executed on a TBB flow
+ * graph, so that an object is created as soon as all of its dependencies are
+ * available, and independent resources (e.g. meshes and textures in
+ * different parts of the scene) load concurrently. Otherwise, the objects
+ * are created one after the other in topological order.
+ */
+static ref<Object> instantiate_graph(XMLParseContext &ctx, const std::string &id) {
+    std::string root_id = resolve_alias(ctx, id);
+
+    // Reachable objects in topological order (dependencies come first)
+    std::vector<std::string> order;
+    // Deduplicated dependencies of each object
+    std::unordered_map<std::string, std::vector<std::string>> deps;
+    // 1: currently being visited, 2: done
+    std::unordered_map<std::string, int> state;
+
+    std::function<void(const std::string &)> visit = [&](const std::string &node_id) {
+        int &s = state[node_id];
+        XMLObject &inst = ctx.instances.find(node_id)->second;
+        if (s == 2)
+            return;
+        else if (s == 1)
+            Throw("Error while loading \"%s\" (near %s): object \"%s\" "
+                  "(indirectly) references itself!", inst.src_id,
+                  inst.offset(inst.location), node_id);
+        s = 1;
+
+        std::vector<std::string> &node_deps = deps[node_id];
+        if (!inst.object) {
+            for (auto &kv : inst.props.named_references()) {
+                std::string child_id;
+                try {
+                    child_id = resolve_alias(ctx, kv.second);
+                } catch (const std::exception &e) {
+                    Throw("Error while loading \"%s\" (near %s): %s",
+                          inst.src_id, inst.offset(inst.location), e.what());
+                }
+                visit(child_id);
+                if (std::find(node_deps.begin(), node_deps.end(), child_id) == node_deps.end())
+                    node_deps.push_back(child_id);
+            }
+        }
+
+        state[node_id] = 2;
+        order.push_back(node_id);
+    };
+
+    visit(root_id);
+
+    Timer timer;
+    if (!ctx.parallelize) {
+        for (const std::string &node_id : order) {
+            XMLObject &inst = ctx.instances.find(node_id)->second;
+            if (!inst.object)
+                instantiate_object(ctx, inst);
+        }
+    } else {
+        using Node = tbb::flow::continue_node<tbb::flow::continue_msg>;
+
+        ThreadEnvironment env;
+        tbb::flow::graph graph;
+        std::unordered_map<std::string, std::unique_ptr<Node>> nodes;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        std::atomic<bool> failed(false);
+
+        for (const std::string &node_id : order) {
+            XMLObject *inst = &ctx.instances.find(node_id)->second;
+            nodes[node_id] = std::make_unique<Node>(
+                graph, [&, inst](const tbb::flow::continue_msg &) {
+                    // Skip the remaining work once an error has occurred
+                    if (inst->object || failed)
+                        return tbb::flow::continue_msg();
+                    ScopedSetThreadEnvironment set_env(env);
+                    try {
+                        instantiate_object(ctx, *inst);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guard(error_mutex);
+                        if (!error)
+                            error = std::current_exception();
+                        failed = true;
+                    }
+                    return tbb::flow::continue_msg();
+                });
+        }
+
+        for (const std::string &node_id : order)
+            for (const std::string &child_id : deps[node_id])
+                tbb::flow::make_edge(*nodes[child_id], *nodes[node_id]);
+
+        // Start with the objects that don't depend on anything
+        for (const std::string &node_id : order) {
+            if (deps[node_id].empty())
+                nodes[node_id]->try_put(tbb::flow::continue_msg());
+        }
+
+        graph.wait_for_all();
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    Log(Debug, "Instantiated %i objects in %s", order.size(),
+        util::time_string(timer.value()));
+
+    return ctx.instances.find(root_id)->second.object;
 }
 
 NAMESPACE_END(detail)
@@ -1104,7 +1210,7 @@ ref<Object> load_string(const std::string &string, const std::string &variant,
     size_t arg_counter; // Unused
     auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, prop,
                                       param, arg_counter, 0).second;
-    return detail::instantiate_node(ctx, scene_id);
+    return detail::instantiate_graph(ctx, scene_id);
 }
 
 ref<Object> load_file(const fs::path &filename_, const std::string &variant,
@@ -1163,7 +1269,7 @@ ref<Object> load_file(const fs::path &filename_, const std::string &variant,
         filename = backup;
     }
 
-    return detail::instantiate_node(ctx, scene_id);
+    return detail::instantiate_graph(ctx, scene_id);
 }
 
 NAMESPACE_END(xml)
@@ -4,7 +4,9 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MTS_VARIANT BSDF<Float, Spectrum>::BSDF(const Properties &props)
-    : m_flags(+BSDFFlags::None), m_id(props.id()) { }
+    : m_flags(+BSDFFlags::None), m_id(props.id()) {
+    Profiler::register_object(this, props);
+}
 
 MTS_VARIANT BSDF<Float, Spectrum>::~BSDF() { }
 
@@ -13,6 +15,11 @@ MTS_VARIANT Spectrum BSDF<Float, Spectrum>::eval_null_transmission(
     return 0.f;
 }
 
+MTS_VARIANT typename BSDF<Float, Spectrum>::Mask BSDF<Float, Spectrum>::alpha_test(
+    const SurfaceInteraction3f & /* si */, Mask /* active */) const {
+    return true;
+}
+
 MTS_VARIANT std::string BSDF<Float, Spectrum>::id() const { return m_id; }
 
 template <typename Index>
@@ -109,6 +116,10 @@ std::string type_mask_to_string(Index type_mask) {
         oss << "non_symmetric ";
         type_mask = type_mask & ~BSDFFlags::NonSymmetric;
     }
+    if (is_set(BSDFFlags::AlphaTest)) {
+        oss << "alpha_test ";
+        type_mask = type_mask & ~BSDFFlags::AlphaTest;
+    }
 #undef is_set
 
     Assert(type_mask == 0);
@@ -6,7 +6,9 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MTS_VARIANT Endpoint<Float, Spectrum>::Endpoint(const Properties &props) : m_id(props.id()) {
+    Profiler::register_object(this, props);
     m_world_transform = props.animated_transform("to_world", ScalarTransform4f()).get();
+    m_to_world = m_world_transform->eval(0.f);
 }
 
 MTS_VARIANT Endpoint<Float, Spectrum>::~Endpoint() { }
@@ -14,6 +16,16 @@ MTS_VARIANT Endpoint<Float, Spectrum>::~Endpoint() { }
 MTS_VARIANT void Endpoint<Float, Spectrum>::set_scene(const Scene *) {
 }
 
+MTS_VARIANT void Endpoint<Float, Spectrum>::traverse(TraversalCallback *callback) {
+    if (m_world_transform->size() <= 1)
+        callback->put_parameter("to_world", m_to_world);
+}
+
+MTS_VARIANT void Endpoint<Float, Spectrum>::parameters_changed() {
+    if (m_world_transform->size() <= 1)
+        m_world_transform = new AnimatedTransform(m_to_world);
+}
+
 MTS_VARIANT void Endpoint<Float, Spectrum>::set_shape(Shape * shape) {
     m_shape = shape;
 }
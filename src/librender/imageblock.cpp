@@ -1,6 +1,7 @@
 #include <mitsuba/render/imageblock.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/statistics.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -104,6 +105,8 @@ ImageBlock<Float, Spectrum>::put(const Point2f &pos_, const Float *value, Mask a
             }
             oss << "]";
             Log(Warn, "%s", oss.str());
+            if constexpr (!is_cuda_array_v<Float>)
+                Statistics::add(StatsCounter::InvalidSamples, count(active && !is_valid));
             active &= is_valid;
         }
     }
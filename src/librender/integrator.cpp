@@ -5,6 +5,9 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/progress.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/warp.h>
@@ -15,10 +18,91 @@
 #include <mitsuba/render/spiral.h>
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
+#include <atomic>
+#include <exception>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Identifies the coordinator of a distributed render job ("MTS2")
+#define MTS_REMOTE_MAGIC 0x3253544Du
+
+/// Revision of the coordinator/worker protocol
+#define MTS_REMOTE_VERSION 1
+
+/**
+ * \brief Parameters of a distributed render job, which are sent to every
+ * worker upon connection. Workers refuse jobs that don't match their scene.
+ *
+ * The coordinator then repeatedly sends a command byte (1: render a block,
+ * 0: done), followed by the offset, size and identifier of the block. The
+ * worker responds with the entry count and the contents of the rendered
+ * \ref ImageBlock.
+ */
+struct RemoteJobInfo {
+    std::string variant;
+    int32_t crop_offset[2], crop_size[2];
+    uint32_t channel_count, block_size, samples_per_pass;
+    int32_t border_size;
+
+    template <typename Film>
+    RemoteJobInfo(const std::string &variant, const Film *film, size_t channel_count,
+                  uint32_t block_size, size_t samples_per_pass, int border_size)
+        : variant(variant), crop_offset{ film->crop_offset().x(), film->crop_offset().y() },
+          crop_size{ film->crop_size().x(), film->crop_size().y() },
+          channel_count((uint32_t) channel_count), block_size(block_size),
+          samples_per_pass((uint32_t) samples_per_pass), border_size(border_size) { }
+
+    RemoteJobInfo() = default;
+
+    void write(Stream *stream) const {
+        stream->write((uint32_t) MTS_REMOTE_MAGIC);
+        stream->write((uint32_t) MTS_REMOTE_VERSION);
+        stream->write(variant);
+        stream->write_array(crop_offset, 2);
+        stream->write_array(crop_size, 2);
+        stream->write(channel_count);
+        stream->write(block_size);
+        stream->write(samples_per_pass);
+        stream->write(border_size);
+    }
+
+    void read(Stream *stream) {
+        uint32_t magic, version;
+        stream->read(magic);
+        stream->read(version);
+        if (magic != MTS_REMOTE_MAGIC)
+            Throw("The remote side is not a Mitsuba render coordinator!");
+        if (version != MTS_REMOTE_VERSION)
+            Throw("Protocol version mismatch (coordinator: %i, worker: %i)!",
+                  version, MTS_REMOTE_VERSION);
+        stream->read(variant);
+        stream->read_array(crop_offset, 2);
+        stream->read_array(crop_size, 2);
+        stream->read(channel_count);
+        stream->read(block_size);
+        stream->read(samples_per_pass);
+        stream->read(border_size);
+    }
+
+    bool operator==(const RemoteJobInfo &i) const {
+        return variant == i.variant && crop_offset[0] == i.crop_offset[0] &&
+               crop_offset[1] == i.crop_offset[1] && crop_size[0] == i.crop_size[0] &&
+               crop_size[1] == i.crop_size[1] && channel_count == i.channel_count &&
+               block_size == i.block_size && samples_per_pass == i.samples_per_pass &&
+               border_size == i.border_size;
+    }
+
+    bool operator!=(const RemoteJobInfo &i) const { return !operator==(i); }
+
+    std::string to_string() const {
+        return tfm::format("%s, %ix%i+%i+%i, %i channels, block size %i, %i spp/pass, border %i",
+                           variant, crop_size[0], crop_size[1], crop_offset[0],
+                           crop_offset[1], channel_count, block_size,
+                           samples_per_pass, border_size);
+    }
+};
+
 // -----------------------------------------------------------------------------
 
 MTS_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
@@ -67,6 +151,7 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
     // Insert default channels and set up the film
     for (size_t i = 0; i < 5; ++i)
         channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+    film->set_pass_count(n_passes);
     film->prepare(channels);
 
     if constexpr (!is_cuda_array_v<Float>) {
@@ -91,42 +176,220 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
         size_t total_blocks = spiral.block_count() * n_passes,
                blocks_done = 0;
 
-        m_render_timer.reset();
-        tbb::parallel_for(
-            tbb::blocked_range<size_t>(0, total_blocks, 1),
-            [&](const tbb::blocked_range<size_t> &range) {
-                ScopedSetThreadEnvironment set_env(env);
-                ref<Sampler> sampler = sensor->sampler()->clone();
-                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
-                                                       film->reconstruction_filter(),
-                                                       !has_aovs);
-                scoped_flush_denormals flush_denormals(true);
-                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+        using BlockInfo = std::tuple<ScalarVector2i, ScalarVector2i, size_t>;
+
+        /* Blocks that were handed to a remote worker, which disconnected
+           before sending them back. They are rendered again. */
+        std::vector<BlockInfo> requeued;
+
+        auto next_block = [&]() -> BlockInfo {
+            /* Critical section: check for blocks of failed workers */ {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!requeued.empty()) {
+                    BlockInfo info = requeued.back();
+                    requeued.pop_back();
+                    return info;
+                }
+            }
+            return spiral.next_block();
+        };
+
+        auto block_done = [&]() {
+            /* Critical section: update progress bar */ {
+                std::lock_guard<std::mutex> lock(mutex);
+                blocks_done++;
+                progress->update(blocks_done / (ScalarFloat) total_blocks);
+            }
+        };
+
+        // Render up to 'count' blocks on the calling thread
+        auto render_blocks = [&](size_t count) {
+            ScopedSetThreadEnvironment set_env(env);
+            ref<Sampler> sampler = sensor->sampler()->clone();
+            ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                   film->reconstruction_filter(),
+                                                   !has_aovs);
+            scoped_flush_denormals flush_denormals(true);
+            std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+
+            // For each block
+            for (size_t i = 0; i < count && !should_stop(); ++i) {
+                auto [offset, size, block_id] = next_block();
+
+                // The remaining blocks may have been handed out to remote workers
+                if (hprod(size) == 0)
+                    break;
+
+                block->set_size(size);
+                block->set_offset(offset);
+
+                // Ensure that the sample generation is fully deterministic
+                sampler->seed(block_id);
+
+                render_block(scene, sensor, sampler, block,
+                             aovs.get(), samples_per_pass);
+
+                film->put(block);
+                block_done();
+            }
+        };
+
+        /* Distributed rendering: remote workers pull blocks from the same
+           queue as the local threads until it runs empty */
+        std::thread coordinator;
+        std::vector<std::thread> remote_threads;
+        std::atomic<bool> accepting(true);
+        RemoteJobInfo job_info(class_()->variant(), film.get(), channels.size(),
+                               m_block_size, samples_per_pass,
+                               film->reconstruction_filter()->border_size());
+
+        // Send the job description, returns whether the worker accepted it
+        auto handshake = [&](SocketStream *stream) {
+            job_info.write(stream);
+            bool accepted;
+            stream->read(accepted);
+            if (!accepted) {
+                std::string reason;
+                stream->read(reason);
+                Log(Warn, "Worker %s declined the render job: %s", stream->peer(), reason);
+            }
+            return accepted;
+        };
+
+        // Run a function on a new thread that is known to Mitsuba's thread system
+        auto spawn_thread = [&](auto func) {
+            return std::thread([func]() {
+                Thread::register_external_thread("rmt");
+                func();
+                Thread::unregister_external_thread();
+            });
+        };
+
+        auto serve_worker = [&](ref<SocketStream> stream) {
+            ScopedSetThreadEnvironment set_env(env);
+            ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                   film->reconstruction_filter(),
+                                                   !has_aovs);
+            BlockInfo current;
+            bool pending = false;
+            size_t block_count = 0;
+
+            try {
+                if (!handshake(stream))
+                    return;
+                Log(Info, "Worker %s joined the render job.", stream->peer());
+
+                while (!should_stop()) {
+                    current = next_block();
+                    auto [offset, size, block_id] = current;
+                    if (hprod(size) == 0)
+                        break;
+                    pending = true;
+
+                    int32_t values[4] = { offset.x(), offset.y(), size.x(), size.y() };
+                    stream->write((uint8_t) 1);
+                    stream->write_array(values, 4);
+                    stream->write((uint64_t) block_id);
 
-                // For each block
-                for (auto i = range.begin(); i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size, block_id] = spiral.next_block();
-                    Assert(hprod(size) != 0);
                     block->set_size(size);
                     block->set_offset(offset);
 
-                    // Ensure that the sample generation is fully deterministic
-                    sampler->seed(block_id);
-
-                    render_block(scene, sensor, sampler, block,
-                                 aovs.get(), samples_per_pass);
+                    uint64_t entries;
+                    stream->read(entries);
+                    if (entries != (uint64_t) block->data().size())
+                        Throw("received an image block with an unexpected size!");
+                    stream->read_array(block->data().data(), entries);
+                    pending = false;
 
                     film->put(block);
+                    block_done();
+                    block_count++;
+                }
+
+                stream->write((uint8_t) 0);
+                Log(Info, "Worker %s rendered %i block%s.", stream->peer(),
+                    block_count, block_count == 1 ? "" : "s");
+            } catch (const std::exception &e) {
+                Log(Warn, "Lost the connection to worker %s: %s", stream->peer(), e.what());
+                if (pending) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    requeued.push_back(current);
+                }
+            }
+        };
+
+        /* Stop accepting remote workers and join all threads on every exit
+           path, including when the local rendering throws (in which case the
+           remote workers are stopped early as well) */
+        struct RemoteThreadGuard {
+            SamplingIntegrator *integrator;
+            std::atomic<bool> &accepting;
+            std::thread &coordinator;
+            std::vector<std::thread> &remote_threads;
+
+            void join() {
+                accepting = false;
+                if (coordinator.joinable())
+                    coordinator.join();
+                for (auto &thread : remote_threads) {
+                    if (thread.joinable())
+                        thread.join();
+                }
+            }
+
+            ~RemoteThreadGuard() {
+                if (std::uncaught_exceptions() > 0)
+                    integrator->cancel();
+                join();
+            }
+        } remote_guard { this, accepting, coordinator, remote_threads };
 
-                    /* Critical section: update progress bar */ {
-                        std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (ScalarFloat) total_blocks);
+        Statistics::reset();
+        m_render_timer.reset();
+
+        if (m_coordinator_socket) {
+            Log(Info, "Accepting remote workers on port %i.", m_coordinator_socket->port());
+            coordinator = spawn_thread([&]() {
+                ScopedSetThreadEnvironment set_env(env);
+                try {
+                    while (accepting) {
+                        ref<SocketStream> stream = m_coordinator_socket->accept(100);
+                        if (stream)
+                            remote_threads.push_back(
+                                spawn_thread([&, stream]() { serve_worker(stream); }));
                     }
+                } catch (const std::exception &e) {
+                    Log(Warn, "Stopped accepting remote workers: %s", e.what());
                 }
+            });
+        }
+
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, total_blocks, 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                render_blocks(range.size());
             }
         );
+
+        if (coordinator.joinable()) {
+            remote_guard.join();
+
+            // Dismiss workers that are still waiting in the connection backlog
+            try {
+                while (ref<SocketStream> stream = m_coordinator_socket->accept(0)) {
+                    if (handshake(stream))
+                        stream->write((uint8_t) 0);
+                }
+            } catch (const std::exception &) { }
+
+            // Render blocks of workers that disconnected after the local threads finished
+            render_blocks((size_t) -1);
+        }
     } else {
+        if (m_coordinator_socket)
+            Log(Warn, "Distributed rendering is not supported by GPU variants, "
+                      "rendering locally.");
+
         ref<Sampler> sampler = sensor->sampler();
 
         ScalarFloat diff_scale_factor = rsqrt((ScalarFloat) sampler->sample_count());
@@ -153,19 +416,137 @@ MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render(Scene *scene, Senso
         film->put(block);
     }
 
-    if (!m_stop)
+    if (!m_stop) {
+        size_t render_time = m_render_timer.value();
         Log(Info, "Rendering finished. (took %s)",
-            util::time_string(m_render_timer.value(), true));
+            util::time_string(render_time, true));
+
+        // Per-thread counters are only collected by the CPU code path
+        if constexpr (!is_cuda_array_v<Float>)
+            Log(Info, "%s", Statistics::summary(render_time / 1000.0));
+    }
 
     return !m_stop;
 }
 
+MTS_VARIANT bool SamplingIntegrator<Float, Spectrum>::render_worker(Scene *scene, Sensor *sensor,
+                                                                   const std::string &host,
+                                                                   uint16_t port,
+                                                                   size_t connections) {
+    if constexpr (is_cuda_array_v<Float>) {
+        ENOKI_MARK_USED(scene);
+        ENOKI_MARK_USED(sensor);
+        ENOKI_MARK_USED(host);
+        ENOKI_MARK_USED(port);
+        ENOKI_MARK_USED(connections);
+        Throw("Distributed rendering is not supported by GPU variants.");
+    } else {
+        ScopedPhase sp(ProfilerPhase::Render);
+        m_stop = false;
+
+        ref<Film> film = sensor->film();
+        size_t total_spp        = sensor->sampler()->sample_count();
+        size_t samples_per_pass = (m_samples_per_pass == (size_t) -1)
+                                   ? total_spp : std::min((size_t) m_samples_per_pass, total_spp);
+
+        std::vector<std::string> channels = aov_names();
+        bool has_aovs = !channels.empty();
+        for (size_t i = 0; i < 5; ++i)
+            channels.insert(channels.begin() + i, std::string(1, "XYZAW"[i]));
+
+        RemoteJobInfo expected(class_()->variant(), film.get(), channels.size(),
+                               m_block_size, samples_per_pass,
+                               film->reconstruction_filter()->border_size());
+
+        if (connections == 0)
+            connections = __global_thread_count;
+
+        Log(Info, "Rendering blocks for %s:%i (%i connection%s)", host, port,
+            connections, connections == 1 ? "" : "s");
+
+        ThreadEnvironment env;
+        std::atomic<size_t> blocks_done(0);
+        std::atomic<bool> success(true);
+
+        Statistics::reset();
+        m_render_timer.reset();
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, connections, 1),
+            [&](const tbb::blocked_range<size_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                ref<Sampler> sampler = sensor->sampler()->clone();
+                ref<ImageBlock> block = new ImageBlock(m_block_size, channels.size(),
+                                                       film->reconstruction_filter(),
+                                                       !has_aovs);
+                scoped_flush_denormals flush_denormals(true);
+                std::unique_ptr<Float[]> aovs(new Float[channels.size()]);
+
+                for (auto i = range.begin(); i != range.end(); ++i) {
+                    try {
+                        ref<SocketStream> stream = new SocketStream(host, port);
+
+                        RemoteJobInfo info;
+                        info.read(stream);
+                        if (info != expected) {
+                            std::string reason = tfm::format(
+                                "job (%s) does not match the local scene (%s)",
+                                info.to_string(), expected.to_string());
+                            stream->write(false);
+                            stream->write(reason);
+                            Throw("%s", reason);
+                        }
+                        stream->write(true);
+
+                        while (true) {
+                            uint8_t command;
+                            stream->read(command);
+                            if (command == 0)
+                                break;
+
+                            int32_t values[4];
+                            uint64_t block_id;
+                            stream->read_array(values, 4);
+                            stream->read(block_id);
+
+                            block->set_size(ScalarVector2i(values[2], values[3]));
+                            block->set_offset(ScalarPoint2i(values[0], values[1]));
+
+                            // Same seed as for a local render of this block
+                            sampler->seed(block_id);
+
+                            render_block(scene, sensor, sampler, block,
+                                         aovs.get(), samples_per_pass);
+                            if (should_stop())
+                                Throw("rendering was cancelled.");
+
+                            stream->write((uint64_t) block->data().size());
+                            stream->write_array(block->data().data(), block->data().size());
+                            blocks_done++;
+                        }
+                    } catch (const std::exception &e) {
+                        Log(Warn, "Remote rendering failed: %s", e.what());
+                        success = false;
+                    }
+                }
+            }
+        );
+
+        size_t render_time = m_render_timer.value();
+        Log(Info, "Rendered %i block%s for %s:%i. (took %s)", (size_t) blocks_done,
+            blocks_done == 1 ? "" : "s", host, port, util::time_string(render_time, true));
+        Log(Info, "%s", Statistics::summary(render_time / 1000.0));
+
+        return success && !m_stop;
+    }
+}
+
 MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *scene,
                                                                    const Sensor *sensor,
                                                                    Sampler *sampler,
                                                                    ImageBlock *block,
                                                                    Float *aovs,
                                                                    size_t sample_count_) const {
+    ScopedPhase sp(ProfilerPhase::RenderBlock);
     block->clear();
     uint32_t pixel_count  = (uint32_t)(m_block_size * m_block_size),
              sample_count = (uint32_t)(sample_count_ == (size_t) -1
@@ -209,6 +590,23 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *
 MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
     const Scene *scene, const Sensor *sensor, Sampler *sampler, ImageBlock *block,
     Float *aovs, const Vector2f &pos, ScalarFloat diff_scale_factor, Mask active) const {
+    auto [ray, ray_weight, position_sample] =
+        sample_sensor_ray(sensor, sampler, pos, diff_scale_factor, active);
+
+    std::pair<Spectrum, Mask> result = sample(scene, sampler, ray, aovs + 5, active);
+
+    put_sample(block, position_sample, ray.wavelengths, ray_weight * result.first,
+               result.second, aovs, active);
+}
+
+MTS_VARIANT std::tuple<typename SamplingIntegrator<Float, Spectrum>::RayDifferential3f,
+                       Spectrum,
+                       typename SamplingIntegrator<Float, Spectrum>::Vector2f>
+SamplingIntegrator<Float, Spectrum>::sample_sensor_ray(const Sensor *sensor,
+                                                       Sampler *sampler,
+                                                       const Vector2f &pos,
+                                                       ScalarFloat diff_scale_factor,
+                                                       Mask active) const {
     Vector2f position_sample = pos + sampler->next_2d(active);
 
     Point2f aperture_sample(.5f);
@@ -230,10 +628,13 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
 
     ray.scale_differential(diff_scale_factor);
 
-    std::pair<Spectrum, Mask> result = sample(scene, sampler, ray, aovs + 5, active);
-    result.first = ray_weight * result.first;
+    return { ray, ray_weight, position_sample };
+}
 
-    UnpolarizedSpectrum spec_u = depolarize(result.first);
+MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::put_sample(
+    ImageBlock *block, const Vector2f &position_sample, const Wavelength &wavelengths,
+    const Spectrum &value, const Mask &valid, Float *aovs, Mask active) const {
+    UnpolarizedSpectrum spec_u = depolarize(value);
 
     Color3f xyz;
     if constexpr (is_monochromatic_v<Spectrum>) {
@@ -242,13 +643,14 @@ MTS_VARIANT void SamplingIntegrator<Float, Spectrum>::render_sample(
         xyz = srgb_to_xyz(spec_u, active);
     } else {
         static_assert(is_spectral_v<Spectrum>);
-        xyz = spectrum_to_xyz(spec_u, ray.wavelengths, active);
+        xyz = spectrum_to_xyz(spec_u, wavelengths, active);
     }
+    ENOKI_MARK_USED(wavelengths);
 
     aovs[0] = xyz.x();
     aovs[1] = xyz.y();
     aovs[2] = xyz.z();
-    aovs[3] = select(result.second, Float(1.f), Float(0.f));
+    aovs[3] = select(valid, Float(1.f), Float(0.f));
     aovs[4] = 1.f;
 
     block->put(position_sample, aovs, active);
@@ -1,6 +1,8 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
+#include <tbb/tbb.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -44,23 +46,213 @@ MTS_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.int_("kd_exact_primitive_threshold"));
 
+    /* kd-tree construction: Use the memory-optimized representation, which
+       stores the primitive index of single-primitive leaves within the node
+       and bounds the per-thread memory usage of the O(n log n) builder by
+       the size of the subtree being built. Default: ``false`` */
+    set_compact(props.bool_("kd_compact", false));
+
+    /* kd-tree traversal: Keep an intersection-optimized copy of all triangles
+       (vertex position and two edge vectors). Faster, but requires additional
+       memory. Default: ``true``, unless the compact representation is used */
+    m_triangle_cache = props.bool_("kd_triangle_cache", !compact());
+
+    /* kd-tree traversal: Test the triangles of leaf nodes in SIMD packets
+       (scalar variants only, requires the triangle cache). Default: ``true`` */
+    m_use_leaf_packets = props.bool_("kd_leaf_packets", true);
+
     m_primitive_map.push_back(0);
 }
 
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
+    ScopedPhase sp(ProfilerPhase::InitKDTree);
     Timer timer;
     Log(Info, "Building a SAH kd-tree (%i primitives) ..",
         primitive_count());
 
     Base::build();
 
-    Log(Info, "Finished. (%s of storage, took %s)",
+    size_t triangle_storage = 0;
+    if (m_triangle_cache) {
+        build_triangle_cache();
+        build_leaf_packets();
+        triangle_storage = primitive_count() * sizeof(TriangleRecord) +
+                           m_triangle_packet_count * sizeof(TrianglePacket);
+        if (m_leaf_packets)
+            triangle_storage += m_node_count * sizeof(Index);
+    }
+
+    Log(Info, "Finished. (%s of storage, %s peak build memory, took %s)",
         util::mem_string(m_index_count * sizeof(Index) +
-                        m_node_count * sizeof(KDNode)),
+                        m_node_count * sizeof(KDNode) + triangle_storage),
+        util::mem_string(peak_build_memory()),
         util::time_string(timer.value())
     );
 }
 
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build_triangle_cache() {
+    if (!m_triangles)
+        m_triangles.reset(new TriangleRecord[primitive_count()]);
+
+    for (Size s = 0; s < shape_count(); ++s) {
+        const Shape *shape = m_shapes[s];
+        const Mesh *mesh = shape->is_mesh() ? (const Mesh *) shape : nullptr;
+        Size offset = m_primitive_map[s],
+             count  = m_primitive_map[s + 1] - offset;
+
+        tbb::parallel_for(
+            tbb::blocked_range<Size>(0, count, 4096),
+            [&](const tbb::blocked_range<Size> &range) {
+                for (Size i = range.begin(); i != range.end(); ++i) {
+                    TriangleRecord &tri = m_triangles[offset + i];
+                    tri.shape_index = s;
+                    tri.prim_index = i;
+
+                    if (!mesh)
+                        continue;
+
+                    auto fi = mesh->face_indices(i);
+                    ScalarPoint3f p0 = mesh->vertex_position(fi[0]),
+                                  p1 = mesh->vertex_position(fi[1]),
+                                  p2 = mesh->vertex_position(fi[2]);
+                    ScalarVector3f e1 = p1 - p0, e2 = p2 - p0;
+
+                    for (size_t k = 0; k < 3; ++k) {
+                        tri.p0[k] = p0[k];
+                        tri.e1[k] = e1[k];
+                        tri.e2[k] = e2[k];
+                    }
+                }
+            }
+        );
+    }
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::build_leaf_packets() {
+    m_leaf_packets.reset();
+    m_triangle_packets.reset();
+    m_triangle_packet_count = 0;
+
+    if constexpr (is_array_v<Float>)
+        return;
+
+    if (!m_use_leaf_packets || !m_triangles)
+        return;
+
+    /* Only plain triangles can be tested in packets */
+    std::vector<bool> packable(shape_count());
+    for (Size s = 0; s < shape_count(); ++s) {
+        const Shape *shape = m_shapes[s];
+        const BSDF *bsdf = shape->bsdf();
+        packable[s] = shape->is_mesh() &&
+                      !(bsdf != nullptr && bsdf->has_alpha_test());
+    }
+
+    /* Assign a range of packets to each leaf */
+    m_leaf_packets.reset(new Index[m_node_count]);
+    Size packet_count = 0;
+    for (Size n = 0; n < m_node_count; ++n) {
+        const KDNode &node = m_nodes[n];
+        Size prim_count = node.leaf() ? node.primitive_count() : 0;
+        bool packed = prim_count > 1;
+
+        for (Size i = 0; packed && i < prim_count; ++i)
+            packed = packable[m_triangles[leaf_primitive(&node, i)].shape_index];
+
+        if (packed) {
+            m_leaf_packets[n] = packet_count;
+            packet_count += Size((prim_count + LeafPacketSize - 1) / LeafPacketSize);
+        } else {
+            m_leaf_packets[n] = InvalidPacket;
+        }
+    }
+
+    if (packet_count == 0) {
+        m_leaf_packets.reset();
+        return;
+    }
+
+    m_triangle_packets.reset(new TrianglePacket[packet_count]);
+    m_triangle_packet_count = packet_count;
+
+    /* Transpose the cached triangles into structure-of-arrays layout */
+    tbb::parallel_for(
+        tbb::blocked_range<Size>(0, m_node_count, 4096),
+        [&](const tbb::blocked_range<Size> &range) {
+            for (Size n = range.begin(); n != range.end(); ++n) {
+                if (m_leaf_packets[n] == InvalidPacket)
+                    continue;
+
+                const KDNode *node = &m_nodes[n];
+                Size prim_count = node->primitive_count();
+                TrianglePacket *packet = &m_triangle_packets[m_leaf_packets[n]];
+
+                for (Size i = 0; i < prim_count; i += LeafPacketSize, ++packet) {
+                    for (size_t lane = 0; lane < LeafPacketSize; ++lane) {
+                        Index prim_index = leaf_primitive(
+                            node, std::min(i + Size(lane), prim_count - 1));
+                        const TriangleRecord &tri = m_triangles[prim_index];
+
+                        for (size_t k = 0; k < 3; ++k) {
+                            packet->p0[k].coeff(lane) = tri.p0[k];
+                            packet->e1[k].coeff(lane) = tri.e1[k];
+                            packet->e2[k].coeff(lane) = tri.e2[k];
+                        }
+                        packet->prim_index[lane] = prim_index;
+                    }
+                }
+            }
+        }
+    );
+}
+
+MTS_VARIANT void ShapeKDTree<Float, Spectrum>::update() {
+    bool dirty = false, topology_changed = false;
+    for (Size s = 0; s < shape_count(); ++s) {
+        Shape *shape = m_shapes[s];
+        if (!shape->is_mesh() || !((Mesh *) shape)->dirty())
+            continue;
+        ((Mesh *) shape)->clear_dirty();
+        dirty = true;
+        topology_changed |= shape->primitive_count() !=
+                            m_primitive_map[s + 1] - m_primitive_map[s];
+    }
+
+    if (!dirty)
+        return;
+
+    if (topology_changed) {
+        /* Primitive indices have shifted -- rebuild the tree from scratch */
+        m_nodes.reset();
+        m_indices.reset();
+        m_triangles.reset();
+        m_leaf_packets.reset();
+        m_triangle_packets.reset();
+        m_triangle_packet_count = 0;
+        m_bbox.reset();
+        m_primitive_map.resize(1);
+
+        std::vector<ref<Shape>> shapes;
+        shapes.swap(m_shapes);
+        for (Shape *shape : shapes)
+            add_shape(shape);
+        build();
+        return;
+    }
+
+    ScopedPhase sp(ProfilerPhase::InitKDTree);
+    Timer timer;
+
+    Size rebuilt = Base::refit();
+    if (m_triangle_cache) {
+        build_triangle_cache();
+        build_leaf_packets();
+    }
+
+    Log(Debug, "Refit the kd-tree (%i subtrees rebuilt, took %s)", rebuilt,
+        util::time_string(timer.value()));
+}
+
 MTS_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
     m_primitive_map.push_back(m_primitive_map.back() +
@@ -2,6 +2,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/phase.h>
+#include <mitsuba/render/sampler.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/texture.h>
 
@@ -85,6 +86,67 @@ Medium<Float, Spectrum>::eval_tr_and_pdf(const MediumInteraction3f &mi,
     return { tr, pdf };
 }
 
+MTS_VARIANT typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::eval_transmittance(const Ray3f &ray, Sampler *sampler,
+                                            Mask active) const {
+    MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+
+    MediumInteraction3f mi;
+    mi.p           = ray.o;
+    mi.time        = ray.time;
+    mi.wavelengths = ray.wavelengths;
+    Float majorant = hmax(get_combined_extinction(mi, active));
+
+    return eval_transmittance_residual(ray, sampler, 0.f, majorant, active);
+}
+
+MTS_VARIANT typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::eval_transmittance_residual(const Ray3f &ray, Sampler *sampler,
+                                                     Float control, Float majorant,
+                                                     Mask active) const {
+    auto [aabb_its, mint, maxt] = intersect_aabb(ray);
+    active &= aabb_its;
+    mint = max(ray.mint, mint);
+    maxt = min(ray.maxt, maxt);
+    active &= mint < maxt;
+
+    UnpolarizedSpectrum tr(1.f);
+    if (none_or<false>(active))
+        return tr;
+
+    // Closed-form transmittance of the control extinction
+    masked(tr, active) = exp(-control * (maxt - mint));
+
+    Float residual_majorant = majorant - control;
+    active &= residual_majorant > 0.f;
+
+    MediumInteraction3f mi;
+    mi.sh_frame    = Frame3f(ray.d);
+    mi.wi          = -ray.d;
+    mi.time        = ray.time;
+    mi.wavelengths = ray.wavelengths;
+    mi.medium      = this;
+
+    Float t = mint;
+    while (any(active)) {
+        // Sample a tentative collision with respect to the residual majorant
+        t -= enoki::log(1.f - sampler->next_1d(active)) / residual_majorant;
+        active &= t < maxt;
+        if (none_or<false>(active))
+            break;
+
+        mi.t = t;
+        mi.p = ray(t);
+        UnpolarizedSpectrum sigma_t = std::get<2>(get_scattering_coefficients(mi, active));
+        masked(tr, active) *= max(1.f - (sigma_t - control) / residual_majorant, 0.f);
+
+        // Stop tracking once all channels are fully occluded
+        active &= any(neq(tr, 0.f));
+    }
+
+    return tr;
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(Medium, Object, "medium")
 MTS_INSTANTIATE_CLASS(Medium)
 NAMESPACE_END(mitsuba)
@@ -192,6 +192,158 @@ MTS_VARIANT void Mesh<Float, Spectrum>::area_distr_build() {
     );
 }
 
+MTS_VARIANT void Mesh<Float, Spectrum>::buffers_export() {
+    if constexpr (!is_cuda_array_v<Float>) {
+        m_faces_buf = empty<DynamicBuffer<UInt32>>(m_face_count * 3);
+        m_vertex_positions_buf = empty<DynamicBuffer<Float>>(m_vertex_count * 3);
+        if (has_vertex_normals())
+            m_vertex_normals_buf = empty<DynamicBuffer<Float>>(m_vertex_count * 3);
+        if (has_vertex_texcoords())
+            m_vertex_texcoords_buf = empty<DynamicBuffer<Float>>(m_vertex_count * 2);
+
+        ScalarIndex *faces_ptr = m_faces_buf.data();
+        for (ScalarSize i = 0; i < m_face_count; ++i) {
+            auto fi = face_indices(i);
+            for (size_t k = 0; k < 3; ++k)
+                faces_ptr[i * 3 + k] = fi[k];
+        }
+
+        ScalarFloat *positions_ptr = m_vertex_positions_buf.data(),
+                    *normals_ptr   = m_vertex_normals_buf.data(),
+                    *texcoords_ptr = m_vertex_texcoords_buf.data();
+
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            InputPoint3f p = vertex_position(i);
+            for (size_t k = 0; k < 3; ++k)
+                positions_ptr[i * 3 + k] = p[k];
+
+            if (has_vertex_normals()) {
+                InputNormal3f n = vertex_normal(i);
+                for (size_t k = 0; k < 3; ++k)
+                    normals_ptr[i * 3 + k] = n[k];
+            }
+
+            if (has_vertex_texcoords()) {
+                auto uv = vertex_texcoord(i);
+                for (size_t k = 0; k < 2; ++k)
+                    texcoords_ptr[i * 2 + k] = uv[k];
+            }
+        }
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::buffers_import() {
+    if constexpr (!is_cuda_array_v<Float>) {
+        /* Nothing to do unless traverse() exported the buffers */
+        if (m_vertex_positions_buf.empty() && m_faces_buf.empty())
+            return;
+
+        if (m_vertex_positions_buf.size() % 3 != 0 || m_faces_buf.size() % 3 != 0)
+            Throw("Mesh \"%s\": the sizes of the vertex position and face buffers "
+                  "must be multiples of 3!", m_name);
+
+        ScalarSize vertex_count = ScalarSize(m_vertex_positions_buf.size() / 3),
+                   face_count   = ScalarSize(m_faces_buf.size() / 3);
+
+        if (!has_vertex_normals() && !m_vertex_normals_buf.empty())
+            Throw("Mesh \"%s\": storing new normals in a Mesh that didn't have "
+                  "normals at construction time is not implemented yet.", m_name);
+        if (has_vertex_texcoords() && m_vertex_texcoords_buf.size() != vertex_count * 2)
+            Throw("Mesh \"%s\": expected %i texture coordinates, got %i!", m_name,
+                  vertex_count * 2, m_vertex_texcoords_buf.size());
+
+        const ScalarIndex *faces_ptr = m_faces_buf.data();
+        for (size_t i = 0; i < face_count * 3; ++i) {
+            if (faces_ptr[i] >= vertex_count)
+                Throw("Mesh \"%s\": face %i references vertex %i, but the mesh "
+                      "only has %i vertices!", m_name, i / 3, faces_ptr[i], vertex_count);
+        }
+
+        /* Reallocate the interleaved buffers if the number of vertices or
+           faces changed. Other per-vertex attributes (e.g. colors) of the
+           vertices that still exist are preserved. */
+        bool vertex_count_changed = vertex_count != m_vertex_count;
+        if (vertex_count_changed) {
+            VertexHolder vertices(new uint8_t[(vertex_count + 1) * m_vertex_size]());
+            memcpy(vertices.get(), m_vertices.get(),
+                   std::min(vertex_count, m_vertex_count) * m_vertex_size);
+            m_vertices = std::move(vertices);
+            m_vertex_count = vertex_count;
+        }
+
+        bool faces_changed = face_count != m_face_count;
+        if (faces_changed) {
+            m_faces = FaceHolder(new uint8_t[(face_count + 1) * m_face_size]());
+            m_face_count = face_count;
+        }
+
+        using ScalarIndex3 = Array<ScalarIndex, 3>;
+        for (ScalarSize i = 0; i < face_count; ++i) {
+            ScalarIndex3 fi = load_unaligned<ScalarIndex3>(faces_ptr + i * 3);
+            faces_changed |= any(neq(fi, face_indices(i)));
+            store_unaligned(face(i), fi);
+        }
+
+        /* Normals that were not modified by the caller are recomputed if the
+           geometry changed (or if the buffer no longer matches) */
+        bool normals_given = has_vertex_normals() &&
+                             m_vertex_normals_buf.size() == vertex_count * 3,
+             normals_changed = false,
+             positions_changed = false;
+
+        const ScalarFloat *positions_ptr = m_vertex_positions_buf.data(),
+                          *normals_ptr   = m_vertex_normals_buf.data(),
+                          *texcoords_ptr = m_vertex_texcoords_buf.data();
+
+        for (ScalarSize i = 0; i < vertex_count; ++i) {
+            InputPoint3f p(InputFloat(positions_ptr[i * 3 + 0]),
+                           InputFloat(positions_ptr[i * 3 + 1]),
+                           InputFloat(positions_ptr[i * 3 + 2]));
+            positions_changed |= any(neq(p, vertex_position(i)));
+            store_unaligned(vertex(i), p);
+
+            if (normals_given) {
+                InputNormal3f n(InputFloat(normals_ptr[i * 3 + 0]),
+                                InputFloat(normals_ptr[i * 3 + 1]),
+                                InputFloat(normals_ptr[i * 3 + 2]));
+                normals_changed |= any(neq(n, vertex_normal(i)));
+                store_unaligned(vertex(i) + m_normal_offset, n);
+            }
+
+            if (has_vertex_texcoords()) {
+                InputVector2f uv(InputFloat(texcoords_ptr[i * 2 + 0]),
+                                 InputFloat(texcoords_ptr[i * 2 + 1]));
+                store_unaligned(vertex(i) + m_texcoord_offset, uv);
+            }
+        }
+
+        if (has_vertex_normals() && !normals_changed &&
+            (positions_changed || faces_changed || !normals_given))
+            recompute_vertex_normals();
+
+        /* Notifications that don't modify the geometry (e.g. when only a
+           parameter of the BSDF changed) leave the acceleration data
+           structure and the sampling table alone */
+        if (positions_changed || faces_changed || vertex_count_changed) {
+            recompute_bbox();
+
+            /* The sampling table is rebuilt on demand */
+            m_area_distr = DiscreteDistribution<Float>();
+            m_dirty = true;
+        }
+
+        /* Release the flat copies, traverse() exports them again if needed */
+        release_buffers();
+    }
+}
+
+MTS_VARIANT void Mesh<Float, Spectrum>::release_buffers() {
+    m_vertex_positions_buf = DynamicBuffer<Float>();
+    m_vertex_normals_buf   = DynamicBuffer<Float>();
+    m_vertex_texcoords_buf = DynamicBuffer<Float>();
+    m_faces_buf            = DynamicBuffer<UInt32>();
+}
+
 MTS_VARIANT typename Mesh<Float, Spectrum>::ScalarSize
 Mesh<Float, Spectrum>::primitive_count() const {
     return face_count();
@@ -589,6 +741,8 @@ MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed() {
 
         if (m_area_distr.empty())
             area_distr_build();
+    } else {
+        buffers_import();
     }
 }
 
@@ -702,16 +856,36 @@ MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
         callback->put_parameter("vertex_positions", m_optix->vertex_positions);
         callback->put_parameter("vertex_normals",   m_optix->vertex_normals);
         callback->put_parameter("vertex_texcoords", m_optix->vertex_texcoords);
+    } else {
+        traverse_cpu(callback);
     }
 }
 
 #else // MTS_ENABLE_OPTIX off
 MTS_VARIANT void Mesh<Float, Spectrum>::parameters_changed() {
+    buffers_import();
 }
-MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback * /*callback*/) {
+
+MTS_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
+    Base::traverse(callback);
+    traverse_cpu(callback);
 }
 #endif
 
+MTS_VARIANT void Mesh<Float, Spectrum>::traverse_cpu(TraversalCallback *callback) {
+    if constexpr (!is_cuda_array_v<Float>) {
+        buffers_export();
+        callback->put_parameter("faces_buf", m_faces_buf);
+        callback->put_parameter("vertex_positions_buf", m_vertex_positions_buf);
+        if (has_vertex_normals())
+            callback->put_parameter("vertex_normals_buf", m_vertex_normals_buf);
+        if (has_vertex_texcoords())
+            callback->put_parameter("vertex_texcoords_buf", m_vertex_texcoords_buf);
+    } else {
+        ENOKI_MARK_USED(callback);
+    }
+}
+
 MTS_IMPLEMENT_CLASS_VARIANT(Mesh, Shape)
 MTS_INSTANTIATE_CLASS(Mesh)
 NAMESPACE_END(mitsuba)
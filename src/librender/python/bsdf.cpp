@@ -22,6 +22,7 @@ MTS_PY_EXPORT(BSDFContext) {
         .value("NonSymmetric", BSDFFlags::NonSymmetric, D(BSDFFlags, NonSymmetric))
         .value("FrontSide", BSDFFlags::FrontSide, D(BSDFFlags, FrontSide))
         .value("BackSide", BSDFFlags::BackSide, D(BSDFFlags, BackSide))
+        .value("AlphaTest", BSDFFlags::AlphaTest, D(BSDFFlags, AlphaTest))
         .value("Reflection", BSDFFlags::Reflection, D(BSDFFlags, Reflection))
         .value("Transmission", BSDFFlags::Transmission, D(BSDFFlags, Transmission))
         .value("Diffuse", BSDFFlags::Diffuse, D(BSDFFlags, Diffuse))
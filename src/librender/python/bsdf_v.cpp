@@ -71,11 +71,14 @@ MTS_PY_EXPORT(BSDF) {
             "ctx"_a, "si"_a, "wo"_a, "active"_a = true, D(BSDF, pdf))
         .def("eval_null_transmission", vectorize(&BSDF::eval_null_transmission),
             "si"_a, "active"_a = true, D(BSDF, eval_null_transmission))
+        .def("alpha_test", vectorize(&BSDF::alpha_test),
+            "si"_a, "active"_a = true, D(BSDF, alpha_test))
         .def("flags", py::overload_cast<Mask>(&BSDF::flags, py::const_),
             "active"_a = true, D(BSDF, flags))
         .def("flags", py::overload_cast<size_t, Mask>(&BSDF::flags, py::const_),
             "index"_a, "active"_a = true, D(BSDF, flags, 2))
         .def_method(BSDF, needs_differentials, "active"_a = true)
+        .def_method(BSDF, has_alpha_test, "active"_a = true)
         .def_method(BSDF, component_count, "active"_a = true)
         .def_method(BSDF, id)
         .def_readwrite("m_flags",      &PyBSDF::m_flags)
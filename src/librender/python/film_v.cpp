@@ -12,14 +12,22 @@ MTS_PY_EXPORT(Film) {
     MTS_PY_CLASS(Film, Object)
         .def_method(Film, prepare, "channels"_a)
         .def_method(Film, put, "block"_a)
+        .def_method(Film, set_pass_count, "pass_count"_a)
         .def_method(Film, set_destination_file, "filename"_a)
         .def("develop", py::overload_cast<>(&Film::develop))
         .def("develop", py::overload_cast<const ScalarPoint2i &, const ScalarVector2i &,
                                             const ScalarPoint2i &, Bitmap *>(
                 &Film::develop, py::const_),
             "offset"_a, "size"_a, "target_offset"_a, "target"_a)
+        .def("develop_incremental",
+            [](const Film &film, const ScalarPoint2i &offset, const ScalarVector2i &size,
+               const ScalarPoint2i &target_offset, Bitmap *target) {
+                return film.develop_incremental(offset, size, target_offset, target);
+            }, "offset"_a, "size"_a, "target_offset"_a, "target"_a,
+            D(Film, develop_incremental))
         .def_method(Film, destination_exists, "basename"_a)
         .def_method(Film, bitmap, "raw"_a = false)
+        .def_method(Film, developed_bitmap)
         .def_method(Film, has_high_quality_edges)
         .def_method(Film, size)
         .def_method(Film, crop_size)
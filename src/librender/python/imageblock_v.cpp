@@ -36,5 +36,31 @@ MTS_PY_EXPORT(ImageBlock) {
         .def_method(ImageBlock, set_warn_negative, "value"_a)
         .def_method(ImageBlock, border_size)
         .def_method(ImageBlock, channel_count)
-        .def("data", py::overload_cast<>(&ImageBlock::data, py::const_), D(ImageBlock, data));
+        .def("data", py::overload_cast<>(&ImageBlock::data, py::const_), D(ImageBlock, data))
+        .def_property_readonly("__array_interface__", [](ImageBlock &block) -> py::object {
+            // Expose the storage (including the border) without copying it
+            if constexpr (is_cuda_array_v<Float>) {
+                cuda_eval();
+                cuda_sync();
+            }
+
+            ScalarVector2i size = block.size() + 2 * block.border_size();
+            py::dict result;
+            result["shape"] = py::make_tuple((size_t) size.y(), (size_t) size.x(),
+                                             block.channel_count());
+
+            std::string code(3, '\0');
+            #if defined(LITTLE_ENDIAN)
+                code[0] = '<';
+            #else
+                code[0] = '>';
+            #endif
+            code[1] = 'f';
+            code[2] = (char) ('0' + sizeof(ScalarFloat));
+
+            result["typestr"] = code;
+            result["data"] = py::make_tuple(size_t(block.data().managed().data()), false);
+            result["version"] = 3;
+            return py::object(result);
+        });
 }
@@ -158,7 +158,13 @@ MTS_PY_EXPORT(Integrator) {
                     ref<SamplingIntegrator>>(m, "SamplingIntegrator", D(SamplingIntegrator))
             .def(py::init<const Properties&>())
             .def_method(SamplingIntegrator, aov_names)
-            .def_method(SamplingIntegrator, should_stop);
+            .def_method(SamplingIntegrator, should_stop)
+            .def_method(SamplingIntegrator, set_coordinator_socket, "socket"_a)
+            .def_method(SamplingIntegrator, coordinator_socket)
+            .def("render_worker", &SamplingIntegrator::render_worker,
+                 "scene"_a, "sensor"_a, "host"_a, "port"_a, "connections"_a = 0,
+                 py::call_guard<py::gil_scoped_release>(),
+                 D(SamplingIntegrator, render_worker));
 
     bind_integrator_sample<Float, Spectrum>(integrator);
 
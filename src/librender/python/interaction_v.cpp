@@ -137,6 +137,8 @@ MTS_PY_EXPORT(SurfaceInteraction) {
             D(SurfaceInteraction, compute_partials))
         .def("has_uv_partials", &SurfaceInteraction3f::has_uv_partials,
             D(SurfaceInteraction, has_uv_partials))
+        .def("footprint", &SurfaceInteraction3f::footprint,
+            D(SurfaceInteraction, footprint))
         // .def("normal_derivative", &SurfaceInteraction3f::normal_derivative, D(SurfaceInteraction, normal_derivative)) // TODO
         .def_repr(SurfaceInteraction3f);
 
@@ -26,6 +26,10 @@ MTS_PY_EXPORT(ShapeKDTree) {
         })
         .def("__len__", &ShapeKDTree::primitive_count)
         .def("bbox", [] (ShapeKDTree &s) { return s.bbox(); })
+        .def("compact", [] (ShapeKDTree &s) { return s.compact(); },
+             D(TShapeKDTree, compact))
+        .def("peak_build_memory", [] (ShapeKDTree &s) { return s.peak_build_memory(); },
+             D(TShapeKDTree, peak_build_memory))
         .def_method(ShapeKDTree, build)
         .def_method(ShapeKDTree, build);
 #else
@@ -62,6 +62,9 @@ MTS_PY_EXPORT(Shape) {
         .def_method(Mesh, write)
         .def_method(Mesh, recompute_vertex_normals)
         .def_method(Mesh, recompute_bbox)
+        .def_method(Mesh, dirty)
+        .def_method(Mesh, clear_dirty)
+        .def_method(Mesh, release_buffers)
         .def("vertices", [](py::object &o) {
             Mesh &m = py::cast<Mesh&>(o);
             py::dtype dtype = o.attr("vertex_struct")().attr("dtype")();
@@ -27,6 +27,7 @@ MTS_PY_EXPORT(Volume) {
                  &Volume::eval_gradient, py::const_)),
              D(Volume, eval_gradient), "it"_a, "active"_a = true)
         .def_method(Volume, max)
+        .def_method(Volume, min)
         .def_method(Volume, bbox)
         .def_method(Volume, resolution)
         .def("__repr__", &Volume::to_string);
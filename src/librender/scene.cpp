@@ -1,5 +1,6 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/scene.h>
@@ -109,10 +110,12 @@ MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
 
-    if constexpr (is_cuda_array_v<Float>)
+    if constexpr (is_cuda_array_v<Float>) {
         return ray_intersect_gpu(ray, active);
-    else
+    } else {
+        Statistics::add(StatsCounter::RaysTraced, count(active));
         return ray_intersect_cpu(ray, active);
+    }
 }
 
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
@@ -132,10 +135,12 @@ MTS_VARIANT typename Scene<Float, Spectrum>::Mask
 Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask active) const {
     MTS_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
 
-    if constexpr (is_cuda_array_v<Float>)
+    if constexpr (is_cuda_array_v<Float>) {
         return ray_test_gpu(ray, active);
-    else
+    } else {
+        Statistics::add(StatsCounter::ShadowRaysTraced, count(active));
         return ray_test_cpu(ray, active);
+    }
 }
 
 MTS_VARIANT std::pair<typename Scene<Float, Spectrum>::DirectionSample3f, Spectrum>
@@ -215,6 +220,16 @@ MTS_VARIANT void Scene<Float, Spectrum>::traverse(TraversalCallback *callback) {
 }
 
 MTS_VARIANT void Scene<Float, Spectrum>::parameters_changed() {
+    if constexpr (!is_cuda_array_v<Float>) {
+        /* Refit or rebuild the acceleration data structure if the geometry
+           of any mesh changed. The GPU version is handled by OptiX. */
+        accel_update_cpu();
+
+        m_bbox.reset();
+        for (Shape *shape : m_shapes)
+            m_bbox.expand(shape->bbox());
+    }
+
     if (m_environment)
         m_environment->set_scene(this);
 }
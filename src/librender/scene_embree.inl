@@ -39,6 +39,23 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     rtcReleaseScene((RTCScene) m_accel);
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_update_cpu() {
+    bool dirty = false;
+    for (Shape *shape : m_shapes) {
+        if (shape->is_mesh() && ((Mesh *) shape)->dirty()) {
+            ((Mesh *) shape)->clear_dirty();
+            dirty = true;
+        }
+    }
+
+    /* The shared vertex and index buffers may have been reallocated,
+       hence the Embree scene is simply recreated */
+    if (dirty) {
+        accel_release_cpu();
+        accel_init_cpu(Properties());
+    }
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
     if constexpr (!is_cuda_array_v<Float>) {
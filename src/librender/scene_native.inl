@@ -14,6 +14,10 @@ MTS_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     m_accel = nullptr;
 }
 
+MTS_VARIANT void Scene<Float, Spectrum>::accel_update_cpu() {
+    ((ShapeKDTree *) m_accel)->update();
+}
+
 MTS_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
     const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
@@ -23,7 +27,11 @@ Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, Mask active) const {
 
     SurfaceInteraction3f si;
     if (likely(any(hit))) {
-        ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction);
+        // Attribute the time spent here to the intersected shape (scalar mode)
+        const Object *shape = nullptr;
+        if constexpr (!is_array_v<Float>)
+            shape = kdtree->shape(reinterpret_array<uint32_t>(cache[0]));
+        ScopedPhase sp(ProfilerPhase::CreateSurfaceInteraction, shape);
         si = kdtree->create_surface_interaction(ray, hit_t, cache, hit);
     } else {
         si.wavelengths = ray.wavelengths;
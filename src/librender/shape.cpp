@@ -5,6 +5,7 @@
 #include <mitsuba/render/sensor.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
 
 #if defined(MTS_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -31,6 +32,8 @@ NAMESPACE_BEGIN(mitsuba)
 #endif
 
 MTS_VARIANT Shape<Float, Spectrum>::Shape(const Properties &props) : m_id(props.id()) {
+    Profiler::register_object(this, props);
+
     for (auto &kv : props.objects()) {
         Emitter *emitter = dynamic_cast<Emitter *>(kv.second.get());
         BSDF *bsdf = dynamic_cast<BSDF *>(kv.second.get());
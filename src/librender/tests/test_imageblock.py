@@ -247,4 +247,22 @@ def test06_put_values_basic(variant_scalar_spectral):
             # we'll just add one sample right in the center of each pixel.
             im.put([j + 0.5, i + 0.5], wavelengths, spectrum, alpha=1.0)
 
-    check_value(im, ref, atol=1e-6)
\ No newline at end of file
+    check_value(im, ref, atol=1e-6)
+
+def test07_array_interface(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.render import ImageBlock
+
+    rfilter = load_string("""<rfilter version="2.0.0" type="gaussian"/>""")
+    im = ImageBlock([10, 5], 3, filter=rfilter)
+    im.clear()
+    im.put([2.5, 3.5], [1, 2, 3])
+
+    # The array shares the storage of the block, including its border
+    arr = np.array(im, copy=False)
+    b = im.border_size()
+    assert arr.shape == (5 + 2 * b, 10 + 2 * b, 3)
+    check_value(im, arr)
+
+    arr[:] = 4
+    check_value(im, 4)
@@ -148,6 +148,164 @@ def test06_render_timeout(variants_cpu_rgb, int_name):
     assert ek.allclose(timeout, effective, atol=0.5)
 
 
+def test07_render_statistics(variants_cpu_rgb):
+    from mitsuba.core import Statistics, StatsCounter
+
+    if not mitsuba.core.MTS_ENABLE_STATISTICS:
+        pytest.skip("Render statistics are disabled in this build.")
+
+    integrator = make_integrator('path', """<integer name="max_depth" value="4"/>""")
+    scene = SCENES['box']['factory']()
+    sensor = scene.sensors()[0]
+    assert integrator.render(scene, sensor)
+
+    stats = Statistics.data()
+    film_size = sensor.film().crop_size()
+    sample_count = film_size[0] * film_size[1] * sensor.sampler().sample_count()
+
+    # At least one camera ray per sample, shadow rays for emitter sampling
+    assert stats[StatsCounter.RaysTraced] >= sample_count
+    assert stats[StatsCounter.ShadowRaysTraced] > 0
+    assert stats[StatsCounter.InvalidSamples] == 0
+
+    # Every path ends up in the histogram exactly once, and max_depth bounds its length
+    assert sum(stats.path_length) == sample_count
+    assert sum(stats.path_length[4:]) == 0
+
+    if not mitsuba.core.MTS_ENABLE_EMBREE:
+        assert stats[StatsCounter.KDNodesVisited] > 0
+        assert stats[StatsCounter.KDPrimitivesVisited] > 0
+
+    assert 'Rays traced' in Statistics.summary(1.0)
+
+    Statistics.reset()
+    assert stats.counters != Statistics.data().counters
+    assert all(v == 0 for v in Statistics.data().counters)
+
+
+def test08_render_distributed(variants_cpu_rgb):
+    from threading import Thread
+    from time import sleep
+    from mitsuba.core import ServerSocket, ThreadEnvironment, ScopedSetThreadEnvironment
+
+    xml = """<integer name="max_depth" value="4"/>"""
+    scene = SCENES['box']['factory']()
+    sensor = scene.sensors()[0]
+    integrator = make_integrator('path', xml)
+
+    assert integrator.render(scene, sensor)
+    reference = np.array(sensor.film().bitmap(raw=True), copy=True)
+
+    socket = ServerSocket()
+    integrator.set_coordinator_socket(socket)
+    assert integrator.coordinator_socket() is socket
+
+    # Workers load their own copy of the scene, like separate processes would
+    env = ThreadEnvironment()
+    results = []
+
+    def worker():
+        with ScopedSetThreadEnvironment(env):
+            worker_scene = SCENES['box']['factory']()
+            results.append(make_integrator('path', xml).render_worker(
+                worker_scene, worker_scene.sensors()[0], 'localhost',
+                socket.port(), connections=2))
+
+    workers = [Thread(target=worker) for i in range(2)]
+    for t in workers:
+        t.start()
+    sleep(0.5)
+
+    assert integrator.render(scene, sensor)
+    socket.close()
+    for t in workers:
+        t.join()
+
+    assert results == [True, True]
+    image = np.array(sensor.film().bitmap(raw=True), copy=True)
+
+    # Blocks are seeded identically, only the accumulation order may differ
+    assert ek.allclose(image, reference, rtol=1e-4, atol=1e-5)
+
+
+def test09_deferred_shadow_rays(variant_packet_rgb):
+    scene = SCENES['box']['factory']()
+    sensor = scene.sensors()[0]
+
+    images = []
+    for batch_size in [0, 1024]:
+        integrator = make_integrator('path', """
+            <integer name="max_depth" value="4"/>
+            <integer name="shadow_batch_size" value="{}"/>""".format(batch_size))
+        assert integrator.render(scene, sensor)
+        images.append(np.array(sensor.film().bitmap(raw=True), copy=True))
+
+    # Same samples and shadow rays, only the accumulation order differs
+    assert ek.allclose(images[0], images[1], rtol=1e-4, atol=1e-5)
+
+
+@pytest.mark.parametrize("int_name", ["path", "volpath", "volpathsimple"])
+def test10_ray_footprint(variant_scalar_rgb, tmpdir, int_name):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+
+    # Checkerboard with a period of two texels, every MIP level above the
+    # full-resolution image is a constant 0.5
+    data = (np.indices((256, 256)).sum(axis=0) % 2).astype(np.float32)
+    filename = str(tmpdir.join('checkerboard.exr'))
+    Bitmap(np.repeat(data[:, :, None], 3, axis=2)).write(filename)
+
+    def render(reflectance):
+        scene = load_string("""<scene version="2.0.0">
+            <integrator type="{}">
+                <integer name="max_depth" value="2"/>
+            </integrator>
+            <sensor type="perspective">
+                <float name="fov" value="30"/>
+                <transform name="to_world">
+                    <lookat origin="0, 0, 3.5" target="0, 0, 0" up="0, 1, 0"/>
+                </transform>
+                <sampler type="independent">
+                    <integer name="sample_count" value="1"/>
+                </sampler>
+                <film type="hdrfilm">
+                    <integer name="width" value="16"/>
+                    <integer name="height" value="16"/>
+                    <rfilter type="box"/>
+                </film>
+            </sensor>
+            <emitter type="point">
+                <point name="position" x="0" y="0" z="3"/>
+            </emitter>
+            <shape type="rectangle">
+                <bsdf type="diffuse">
+                    {}
+                </bsdf>
+            </shape>
+        </scene>""".format(int_name, reflectance))
+        sensor = scene.sensors()[0]
+        assert scene.integrator().render(scene, sensor)
+        return np.array(sensor.film().bitmap(), copy=True)[:, :, 0]
+
+    texture = """<texture type="bitmap" name="reflectance">
+        <string name="filename" value="{}"/>
+        <string name="filter_type" value="{{}}"/>
+        <boolean name="raw" value="true"/>
+    </texture>""".format(filename)
+
+    reference = render('<spectrum name="reflectance" value="0.5"/>')
+    assert np.all(reference > 0)
+
+    # Camera rays cover several texels: trilinear lookups must see a
+    # non-zero footprint and return the average of the checkerboard
+    trilinear = render(texture.format('trilinear'))
+    assert ek.allclose(trilinear, reference, rtol=1e-3)
+
+    # .. whereas bilinear lookups alias
+    bilinear = render(texture.format('bilinear'))
+    assert np.max(np.abs(bilinear / reference - 1)) > 0.5
+
+
 def make_reference_renders():
     mitsuba.set_variant('scalar_rgb')
     from mitsuba.core import Bitmap, Struct
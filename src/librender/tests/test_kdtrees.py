@@ -131,3 +131,225 @@ def test03_depth_packet_stairs(variant_packet_rgb):
     # TODO: spot-check (here, we only check consistency)
     assert ek.all(res_shadow == res.is_valid())
     compare_results(res_naive, res, atol=1e-6)
+
+
+def test04_refit_after_vertex_update(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.render import SurfaceInteraction3f
+    from mitsuba.python.util import traverse
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    n_steps = 20
+    scene = make_synthetic_scene(n_steps)
+
+    params = traverse(scene)
+    key = [k for k in params.keys() if k.endswith('vertex_positions_buf')][0]
+
+    # Move the stairs down along Z and squash them along X
+    positions = params[key]
+    params[key] = type(positions)([
+        positions[i] * (0.5 if i % 3 == 0 else 1.0) - (0.5 if i % 3 == 2 else 0.0)
+        for i in range(len(positions))
+    ])
+    params.update()
+
+    assert ek.allclose(scene.bbox().min[2], -0.5)
+
+    n = 32
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n - 1):
+        for y in range(n - 1):
+            o = [x * inv_n, y * inv_n, 2]
+            r = Ray3f(o, [0, 0, -1], 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive = scene.ray_intersect_naive(r)
+            res       = scene.ray_intersect(r)
+
+            compare_results(res_naive, res)
+            if x * inv_n < 0.5:
+                step_idx = ek.floor((y * inv_n) * n_steps)
+                expected = SurfaceInteraction3f()
+                expected.t = 2.5 - (step_idx / n_steps)
+                compare_results(res, expected, atol=1e-6)
+            else:
+                assert not res.is_valid()
+
+
+
+def test05_rebuild_after_topology_change(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.python.util import traverse
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    n_steps = 20
+    scene = make_synthetic_scene(n_steps)
+    mesh = scene.shapes()[0]
+
+    # Drop the upper half of the stairs (faces are stored step by step)
+    params = traverse(scene)
+    key = [k for k in params.keys() if k.endswith('faces_buf')][0]
+    faces = params[key]
+    face_count = 4 * (n_steps // 2)
+    params[key] = type(faces)([faces[i] for i in range(face_count * 3)])
+    params.update()
+
+    assert mesh.primitive_count() == face_count
+
+    n = 32
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n - 1):
+        for y in range(n - 1):
+            r = Ray3f([x * inv_n, y * inv_n, 2], [0, 0, -1], 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive = scene.ray_intersect_naive(r)
+            res       = scene.ray_intersect(r)
+            compare_results(res_naive, res)
+            assert res.is_valid() == (y * inv_n < 0.5)
+
+@fresolver_append_path
+def test06_compact_bunny(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Small exact threshold and leaves: exercises both builders and inline leaves
+    scene = load_string("""
+        <scene version="0.5.0">
+            <boolean name="kd_compact" value="true"/>
+            <integer name="kd_stop_prims" value="1"/>
+            <integer name="kd_exact_primitive_threshold" value="64"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/ply/bunny_lowres.ply"/>
+            </shape>
+        </scene>
+    """)
+    b = scene.bbox()
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            r = Ray3f(o, [0, 0, 1], 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+            assert ek.all(res_shadow == res_naive.is_valid())
+            compare_results(res_naive, res)
+
+
+def test07_peak_build_memory(variant_scalar_rgb):
+    from mitsuba.core import Properties
+    from mitsuba.render import ShapeKDTree
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Build both trees from the same mesh using the O(N log N) builder, whose
+    # edge events and classification tables dominate the temporary storage
+    mesh = create_stairs(4000)
+    peak = {}
+    for compact in [False, True]:
+        props = Properties()
+        props["kd_compact"] = compact
+        props["kd_exact_primitive_threshold"] = 100000
+        kdtree = ShapeKDTree(props)
+        kdtree.add_shape(mesh)
+        kdtree.build()
+        assert kdtree.compact() == compact
+        peak[compact] = kdtree.peak_build_memory()
+        assert peak[compact] > 0
+
+    assert peak[True] < peak[False]
+
+
+def test08_parallel_nlogn_stairs(variant_scalar_rgb):
+    from mitsuba.core import Properties, Ray3f
+    from mitsuba.render import Scene
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Large enough for the O(N log N) builder to recurse in parallel
+    n_steps = 4000
+    props = Properties("scene")
+    props["_unnamed_0"] = create_stairs(n_steps)
+    props["kd_exact_primitive_threshold"] = 100000
+    scene = Scene(props)
+
+    n = 32
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n - 1):
+        for y in range(n - 1):
+            r = Ray3f([x * inv_n, y * inv_n, 2], [0, 0, -1], 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive = scene.ray_intersect_naive(r)
+            res       = scene.ray_intersect(r)
+            assert ek.all(scene.ray_test(r) == res_naive.is_valid())
+            compare_results(res_naive, res)
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('leaf_packets', [False, True])
+def test09_leaf_packets_bunny(variant_scalar_rgb, leaf_packets):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Large leaves, most of which end with a partially filled packet
+    scene = load_string("""
+        <scene version="0.5.0">
+            <boolean name="kd_leaf_packets" value="{}"/>
+            <integer name="kd_stop_prims" value="11"/>
+            <shape type="ply">
+                <string name="filename" value="resources/data/ply/bunny_lowres.ply"/>
+            </shape>
+        </scene>
+    """.format('true' if leaf_packets else 'false'))
+    b = scene.bbox()
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            r = Ray3f(o, [0, 0, 1], 0.5, wavelengths)
+            r.mint = 0
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+            assert ek.all(res_shadow == res_naive.is_valid())
+            compare_results(res_naive, res)
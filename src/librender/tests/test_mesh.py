@@ -228,3 +228,43 @@ def test06_load_various_features(variant_scalar_rgb, mesh_format, features, face
                 assert ek.allclose(v[3:6], [0.0, 1.0, 0.0])
 
     return fresolver_append_path(test)()
+
+
+@fresolver_append_path
+def test07_parameters_changed_without_geometry(variant_scalar_rgb):
+    from mitsuba.core.xml import load_string
+    from mitsuba.python.util import traverse
+
+    shape = load_string("""
+        <shape type="obj" version="2.0.0">
+            <string name="filename" value="resources/data/tests/obj/cbox_smallbox.obj"/>
+            <bsdf type="diffuse"/>
+        </shape>
+    """)
+
+    # Only a BSDF parameter changes: the geometry is left untouched
+    params = traverse(shape)
+    positions_key = [k for k in params.keys() if k.endswith('vertex_positions_buf')][0]
+    reflectance_key = [k for k in params.keys() if 'reflectance' in k][0]
+    params[reflectance_key] = type(params[reflectance_key])(0.2)
+    params.update()
+    assert not shape.dirty()
+
+    # The flat copies are released once they have been written back
+    assert len(params[positions_key]) == 0
+
+    # Moving the vertices marks the mesh as dirty
+    bbox_min = shape.bbox().min
+    params = traverse(shape)
+    positions = params[positions_key]
+    params[positions_key] = type(positions)([p + 1.0 for p in positions])
+    params.update()
+    assert shape.dirty()
+    assert ek.allclose(shape.bbox().min, bbox_min + 1.0)
+
+    # Copies exported by a traversal that doesn't modify the geometry can be
+    # released without notifying the mesh
+    params = traverse(shape)
+    assert len(params[positions_key]) > 0
+    shape.release_buffers()
+    assert len(params[positions_key]) == 0
@@ -1,6 +1,7 @@
 import pytest
 
 import mitsuba
+import enoki as ek
 from mitsuba.python.test.util import fresolver_append_path
 
 
@@ -48,3 +49,56 @@ def test01_emitter_checks(variant_scalar_rgb):
                 + shape_xml.format('<emitter type="area" id="my_inner_emitter"/>')
                 + shape_xml.format('<ref id="my_emitter"/>'), 4)
 
+
+
+@fresolver_append_path
+def test02_update_without_refit(variant_scalar_rgb):
+    from mitsuba.core import Thread, Appender, LogLevel, Transform4f
+    from mitsuba.core.xml import load_string
+    from mitsuba.python.util import traverse
+
+    if mitsuba.core.MTS_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = load_string("""<scene version="2.0.0">
+        <sensor type="perspective"/>
+        <emitter type="point"/>
+        <shape type="obj">
+            <string name="filename" value="resources/data/tests/obj/rectangle_uv.obj"/>
+        </shape>
+    </scene>""")
+
+    # Record the messages of the kd-tree (logged at the 'Debug' level)
+    messages = []
+
+    class MyAppender(Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+    logger = Thread.thread().logger()
+    log_level = logger.log_level()
+    appender = MyAppender()
+    logger.set_log_level(LogLevel.Debug)
+    logger.add_appender(appender)
+
+    try:
+        # Moving the sensor and emitter leaves the kd-tree alone
+        params = traverse(scene)
+        assert 'PerspectiveCamera.to_world' in params
+        assert 'PointLight.to_world' in params
+        for key in params.keys():
+            if key.endswith('to_world'):
+                params[key] = Transform4f.translate([0, 0, 1]) * params[key]
+        params.update()
+        assert not any('kd-tree refit' in m for m in messages)
+        assert ek.allclose(scene.emitters()[0].bbox().min, [0, 0, 1])
+
+        # .. while moving the mesh refits it
+        key = [k for k in params.keys() if k.endswith('vertex_positions_buf')][0]
+        positions = params[key]
+        params[key] = type(positions)([p + 1.0 for p in positions])
+        params.update()
+        assert any('kd-tree refit' in m for m in messages)
+    finally:
+        logger.remove_appender(appender)
+        logger.set_log_level(log_level)
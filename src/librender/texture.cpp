@@ -11,7 +11,9 @@ NAMESPACE_BEGIN(mitsuba)
 // =======================================================================
 
 MTS_VARIANT Texture<Float, Spectrum>::Texture(const Properties &props)
-    : m_id(props.id()) { }
+    : m_id(props.id()) {
+    Profiler::register_object(this, props);
+}
 
 MTS_VARIANT Texture<Float, Spectrum>::~Texture() { }
 
@@ -91,6 +93,9 @@ Volume<Float, Spectrum>::eval_gradient(const Interaction3f & /*it*/, Mask /*acti
 MTS_VARIANT typename Volume<Float, Spectrum>::ScalarFloat
 Volume<Float, Spectrum>::max() const { NotImplementedError("max"); }
 
+MTS_VARIANT typename Volume<Float, Spectrum>::ScalarFloat
+Volume<Float, Spectrum>::min() const { return 0.f; }
+
 //! @}
 // =======================================================================
 
@@ -3,6 +3,7 @@
 #include <mitsuba/core/frame.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/warp.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/medium.h>
@@ -15,7 +16,8 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class HeterogeneousMedium final : public Medium<Float, Spectrum> {
 public:
-    MTS_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction)
+    MTS_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction,
+                    eval_transmittance_residual)
     MTS_IMPORT_TYPES(Scene, Sampler, Texture, Volume)
 
     HeterogeneousMedium(const Properties &props) : Base(props) {
@@ -50,6 +52,24 @@ public:
 
         m_max_density = m_density_scale * m_sigmat->max();
         m_aabb        = m_sigmat->bbox();
+
+        std::string transmittance = string::to_lower(props.string("transmittance", "residual_ratio"));
+        if (transmittance == "residual_ratio")
+            m_min_density = std::min(m_density_scale * m_sigmat->min(), m_max_density);
+        else if (transmittance == "ratio")
+            m_min_density = 0.f;
+        else
+            Throw("The \"transmittance\" parameter must be equal to either "
+                  "\"ratio\" or \"residual_ratio\"!");
+    }
+
+    UnpolarizedSpectrum eval_transmittance(const Ray3f &ray, Sampler *sampler,
+                                           Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+        /* Residual ratio tracking, using the minimum density of the grid as
+           control extinction (reduces to ratio tracking when it is zero) */
+        return eval_transmittance_residual(ray, sampler, m_min_density,
+                                           m_max_density, active);
     }
 
     UnpolarizedSpectrum
@@ -86,7 +106,9 @@ public:
         oss << "HeterogeneousMedium[" << std::endl
             << "  albedo  = " << string::indent(m_albedo) << std::endl
             << "  sigma_t = " << string::indent(m_sigmat) << std::endl
-            << "  density = " << string::indent(m_density) << std::endl
+            << "  density = " << string::indent(m_density) << "," << std::endl
+            << "  min_density = " << m_min_density << "," << std::endl
+            << "  max_density = " << m_max_density << std::endl
             << "]";
         return oss.str();
     }
@@ -96,7 +118,7 @@ private:
     ref<Volume> m_sigmat, m_albedo, m_density;
 
     ScalarBoundingBox3f m_aabb;
-    ScalarFloat m_density_scale, m_max_density;
+    ScalarFloat m_density_scale, m_max_density, m_min_density;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(HeterogeneousMedium, Medium)
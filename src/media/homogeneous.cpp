@@ -70,6 +70,22 @@ public:
         return { sigmas, sigman, sigmat };
     }
 
+    UnpolarizedSpectrum eval_transmittance(const Ray3f &ray, Sampler * /* sampler */,
+                                           Mask active) const override {
+        MTS_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+
+        // Closed-form solution, no random numbers are needed
+        MediumInteraction3f mi;
+        mi.p           = ray.o;
+        mi.time        = ray.time;
+        mi.wavelengths = ray.wavelengths;
+
+        UnpolarizedSpectrum sigmat = eval_sigmat(mi),
+                            tau    = sigmat * (ray.maxt - ray.mint);
+        masked(tau, eq(sigmat, 0.f)) = 0.f;
+        return select(active, exp(-tau), 1.f);
+    }
+
     std::tuple<Mask, Float, Float>
     intersect_aabb(const Ray3f & /* ray */) const override {
         return { true, 0.f, math::Infinity<Float> };
@@ -0,0 +1,55 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def write_volume(filename, data):
+    res = data.shape[0]
+    with open(filename, 'wb') as f:
+        f.write(b'VOL')
+        f.write(np.uint8(3).tobytes())                 # Version
+        f.write(np.int32(1).tobytes())                 # Float32 data
+        f.write(np.array([res] * 3 + [1], dtype=np.int32).tobytes())
+        f.write(np.array([0, 0, 0, 1, 1, 1], dtype=np.float32).tobytes())
+        f.write(data.astype(np.float32).tobytes())
+
+
+@pytest.mark.parametrize('transmittance', ['ratio', 'residual_ratio'])
+def test01_transmittance_constant_density(variant_scalar_rgb, tmpdir, transmittance):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    sigma_t = 2.0
+    filename = str(tmpdir.join('grid.vol'))
+    write_volume(filename, np.full((8, 8, 8), sigma_t))
+
+    medium = load_string("""<medium version="2.0.0" type="heterogeneous">
+            <string name="transmittance" value="{}"/>
+            <volume name="sigma_t" type="gridvolume">
+                <string name="filename" value="{}"/>
+            </volume>
+            <rgb name="albedo" value="0.5"/>
+        </medium>""".format(transmittance, filename))
+    sampler = load_string("""<sampler version="2.0.0" type="independent"/>""")
+    sampler.seed(0)
+
+    # Diagonal segment through the grid, partially outside of its bounds
+    o = np.array([0.1, 0.2, -1.0])
+    d = np.array([0.6, 0.5, 2.0])
+    d /= np.linalg.norm(d)
+    ray = Ray3f(o.tolist(), d.tolist(), 0.0, [])
+    ray.mint = 0.0
+    ray.maxt = 10.0
+
+    # Length of the part of the segment that lies within the unit cube
+    t0 = np.max(np.minimum(-o / d, (1 - o) / d))
+    t1 = np.min(np.maximum(-o / d, (1 - o) / d))
+    expected = np.exp(-sigma_t * (t1 - t0))
+
+    n = 4000
+    mean = np.mean([medium.eval_transmittance(ray, sampler)[0] for i in range(n)])
+
+    # Ratio tracking returns 0 or 1 here (the majorant is tight): allow for
+    # four standard deviations of the mean
+    assert abs(mean - expected) < 4 * np.sqrt(expected * (1 - expected) / n) + 1e-5
@@ -0,0 +1,25 @@
+import mitsuba
+import pytest
+import enoki as ek
+
+
+def test01_transmittance(variant_scalar_rgb):
+    from mitsuba.core import Ray3f
+    from mitsuba.core.xml import load_string
+
+    medium = load_string("""<medium version="2.0.0" type="homogeneous">
+        <rgb name="sigma_t" value="0.5, 1.0, 2.0"/>
+        <rgb name="albedo" value="0.5"/>
+    </medium>""")
+    sampler = load_string("""<sampler version="2.0.0" type="independent"/>""")
+
+    ray = Ray3f([0, 0, 0], [0, 0, 1], 0.0, [])
+    ray.mint = 0.0
+    ray.maxt = 2.0
+
+    tr = medium.eval_transmittance(ray, sampler)
+    assert ek.allclose(tr, [ek.exp(-1.0), ek.exp(-2.0), ek.exp(-4.0)])
+
+    # Infinite segments are fully occluded
+    ray.maxt = float('inf')
+    assert ek.allclose(medium.eval_transmittance(ray, sampler), 0.0)
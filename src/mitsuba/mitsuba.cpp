@@ -1,3 +1,4 @@
+#include <mitsuba/core/appender.h>
 #include <mitsuba/core/argparser.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
@@ -6,17 +7,32 @@
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
 #include <tbb/task_scheduler_init.h>
+#include <condition_variable>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #if !defined(__WINDOWS__)
 #  include <signal.h>
+#  include <sys/socket.h>
+#  include <sys/stat.h>
+#  include <sys/un.h>
+#  include <unistd.h>
+#  include <cerrno>
+#  include <cstring>
 #endif
 
 using namespace mitsuba;
@@ -61,12 +77,77 @@ Options:
 
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
+
+    --trace <filename>
+        Record a timeline of the profiler phases executed by each
+        thread (scene loading, kd-tree construction, rendered blocks,
+        film development, ..) and write it to "filename" using the
+        Chrome trace format (viewable in chrome://tracing).
+
+    -f <filename>, --frames <filename>
+        Render an animation sequence. The scene is loaded only once,
+        and every line of "filename" describes a frame using a list of
+        parameter overrides separated by semicolons, e.g.
+
+          PerspectiveCamera.to_world = lookat 0,1,5 0,0,0 0,1,0
+
+        Overrides remain active in subsequent frames. Transforms are
+        specified using 16 matrix entries (row-major order) or one of
+        "lookat <origin> <target> <up>", "translate <v>", "scale <v>"
+        and "rotate <axis> <angle>". Only modified objects (and the
+        acceleration data structure, if needed) are updated between
+        frames. Frame 'i' is written to "<output>_<iiii>.exr", where
+        the frame index is zero-padded to four digits (e.g.
+        "scene_0007.exr"). Run with -v to list the available parameters.
+
+    --server <socket>
+        Run as a persistent render server that accepts jobs over the
+        UNIX domain socket "socket" (not available on Windows). Parsed
+        scenes stay cached until their XML file is modified. A job is
+        a sequence of text lines, which ends with "render":
+
+          scene <filename>         (required)
+          mode <variant>           (default: value of -m)
+          set <key> = <value>      (see --frames, persists in the cache)
+          sensor <index>
+          spp <count>
+          output <filename>        (optionally write an EXR file, the
+                                    path must be relative and stay within
+                                    the working directory of the server)
+          render
+
+        The server replies with "progress <percent>" lines and with
+        "tile <x> <y> <width> <height> <bytes>" lines, each followed by
+        the raw pixel data of a modified region of the image (as
+        described by a preceding "image <width> <height> <channels>
+        <format>" line), and finally with "done" or "error <message>".
+        Several jobs can be sent over one connection. The command
+        "shutdown" stops the server.
+
+    --coordinator <port>
+        Distribute the image blocks of the rendering to remote worker
+        processes, which connect to the TCP port "port". Local threads
+        keep rendering as well, and blocks of workers that disconnect
+        are rendered again.
+
+    --worker <host>:<port>
+        Render image blocks for the coordinator at the given address
+        (using one connection per thread) instead of producing an
+        image. The worker must load the same scene (and parameters)
+        as the coordinator. Can't be combined with --frames.
 )";
 }
 
 std::function<void(void)> develop_callback;
 std::mutex develop_callback_mutex;
 
+/// Socket on which remote workers connect (--coordinator)
+ref<ServerSocket> coordinator_socket;
+
+/// Address of the coordinator to render blocks for (--worker)
+std::string worker_host;
+uint16_t worker_port = 0;
+
 template <typename Float, typename Spectrum>
 bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
@@ -77,13 +158,25 @@ bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
     auto sensor = scene->sensors()[sensor_i];
     auto film = sensor->film();
 
-    filename.replace_extension("exr");
-    film->set_destination_file(filename);
-
     auto integrator = scene->integrator();
     if (!integrator)
         Throw("No integrator specified for scene: %s", scene->to_string());
 
+    if (!worker_host.empty() || coordinator_socket) {
+        auto *sampling_integrator =
+            dynamic_cast<SamplingIntegrator<Float, Spectrum> *>(integrator.get());
+        if (!sampling_integrator)
+            Throw("Distributed rendering requires a sampling-based integrator!");
+
+        if (!worker_host.empty())
+            return sampling_integrator->render_worker(scene, sensor.get(),
+                                                      worker_host, worker_port);
+        sampling_integrator->set_coordinator_socket(coordinator_socket);
+    }
+
+    filename.replace_extension("exr");
+    film->set_destination_file(filename);
+
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = [&]() { film->develop(); };
@@ -100,6 +193,657 @@ bool render(Object *scene_, size_t sensor_i, filesystem::path filename) {
     return success;
 }
 
+/// A parameter of the scene graph, as reported by Object::traverse()
+struct SceneParameter {
+    void *ptr;
+    const std::type_info *type;
+    Object *owner;
+};
+
+/**
+ * \brief Collects the parameters of a scene graph, using the same naming
+ * scheme as the \c mitsuba.python.util.traverse() function
+ */
+class SceneTraversal : public TraversalCallback {
+public:
+    SceneTraversal(Object *root) { visit(root, nullptr, "", 0); }
+
+    void put_object(const std::string &name, Object *obj) override {
+        if (!obj || m_hierarchy.find(obj) != m_hierarchy.end())
+            return;
+
+        std::string prefix = m_prefix.empty() ? name : m_prefix + "." + name,
+                    unique = prefix;
+        for (int ctr = 1; m_prefixes.find(unique) != m_prefixes.end(); ++ctr)
+            unique = prefix + "_" + std::to_string(ctr);
+
+        visit(obj, m_node, unique, m_depth + 1);
+    }
+
+    /// Return all parameters indexed by name
+    const std::map<std::string, SceneParameter> &parameters() const { return m_params; }
+
+    /// Remove all parameters for which \c pred(name, parameter) returns \c true
+    template <typename Predicate> void remove_parameters(Predicate pred) {
+        for (auto it = m_params.begin(); it != m_params.end();) {
+            if (pred(it->first, it->second))
+                it = m_params.erase(it);
+            else
+                ++it;
+        }
+    }
+
+    /**
+     * \brief Call \ref Object::parameters_changed() on the given objects and
+     * all of their parents, proceeding from the leaves towards the root
+     */
+    void notify(const std::unordered_set<Object *> &modified) const {
+        std::vector<std::pair<size_t, Object *>> work;
+        std::unordered_set<Object *> visited;
+        for (Object *node : modified) {
+            while (node && visited.insert(node).second) {
+                auto it = m_hierarchy.find(node);
+                work.emplace_back(it->second.second, node);
+                node = it->second.first;
+            }
+        }
+
+        std::stable_sort(work.begin(), work.end(),
+            [](const auto &a, const auto &b) { return a.first > b.first; });
+        for (auto &kv : work)
+            kv.second->parameters_changed();
+    }
+
+protected:
+    void put_parameter_impl(const std::string &name, const std::type_info &type,
+                            void *ptr) override {
+        m_params[m_prefix.empty() ? name : m_prefix + "." + name] =
+            SceneParameter{ ptr, &type, m_node };
+    }
+
+private:
+    void visit(Object *node, Object *parent, const std::string &prefix, size_t depth) {
+        m_hierarchy[node] = { parent, depth };
+        m_prefixes.insert(prefix);
+
+        Object *node_prev = m_node;
+        std::string prefix_prev = m_prefix;
+        size_t depth_prev = m_depth;
+
+        m_node = node; m_prefix = prefix; m_depth = depth;
+        node->traverse(this);
+        m_node = node_prev; m_prefix = prefix_prev; m_depth = depth_prev;
+    }
+
+private:
+    std::map<std::string, SceneParameter> m_params;
+    std::unordered_map<Object *, std::pair<Object *, size_t>> m_hierarchy;
+    std::unordered_set<std::string> m_prefixes;
+    Object *m_node = nullptr;
+    std::string m_prefix;
+    size_t m_depth = 0;
+};
+
+/**
+ * \brief Release the flat geometry buffers that meshes export when they are
+ * traversed, and remove them from the parameter list
+ *
+ * Parameter overrides cannot specify these buffers. Without this, every mesh
+ * of the scene would keep a second copy of its geometry.
+ */
+template <typename Float, typename Spectrum>
+void release_mesh_buffers(SceneTraversal &traversal) {
+    MTS_IMPORT_TYPES(Mesh)
+
+    traversal.remove_parameters([](const std::string &, const SceneParameter &param) {
+        auto *mesh = dynamic_cast<Mesh *>(param.owner);
+        if (!mesh)
+            return false;
+        mesh->release_buffers();
+        return *param.type == typeid(DynamicBuffer<Float>) ||
+               *param.type == typeid(DynamicBuffer<UInt32>);
+    });
+}
+
+/// Parse a parameter override and write it into the referenced scene parameter
+template <typename Float, typename Spectrum>
+void set_parameter(const std::string &name, const SceneParameter &param,
+                   const std::string &value) {
+    MTS_IMPORT_TYPES()
+
+    std::vector<std::string> tokens = string::tokenize(value, ", \t");
+    std::string keyword;
+    if (!tokens.empty() && std::isalpha((unsigned char) tokens[0][0])) {
+        keyword = string::to_lower(tokens[0]);
+        tokens.erase(tokens.begin());
+    }
+
+    std::vector<ScalarFloat> v;
+    for (const std::string &token : tokens) {
+        try {
+            v.push_back((ScalarFloat) std::stod(token));
+        } catch (...) {
+            Throw("Parameter \"%s\": could not parse \"%s\"", name, token);
+        }
+    }
+
+    auto expect = [&](size_t count) {
+        if (v.size() != count)
+            Throw("Parameter \"%s\": expected %i values, got %i!", name, count, v.size());
+    };
+
+    auto vec3 = [&](size_t i) { return ScalarVector3f(v[i], v[i + 1], v[i + 2]); };
+
+    auto transform = [&]() -> ScalarTransform4f {
+        if (keyword == "lookat") {
+            expect(9);
+            return ScalarTransform4f::look_at(vec3(0), vec3(3), vec3(6));
+        } else if (keyword == "translate") {
+            expect(3);
+            return ScalarTransform4f::translate(vec3(0));
+        } else if (keyword == "scale") {
+            expect(3);
+            return ScalarTransform4f::scale(vec3(0));
+        } else if (keyword == "rotate") {
+            expect(4);
+            return ScalarTransform4f::rotate(vec3(0), v[3]);
+        } else if (keyword.empty()) {
+            expect(16);
+            ScalarMatrix4f m;
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 4; ++j)
+                    m(i, j) = v[i * 4 + j];
+            return ScalarTransform4f(m);
+        }
+        Throw("Parameter \"%s\": unknown transformation \"%s\"", name, keyword);
+    };
+
+    if (!keyword.empty() && *param.type != typeid(ScalarTransform4f))
+        Throw("Parameter \"%s\": unexpected keyword \"%s\"", name, keyword);
+
+    const std::type_info &type = *param.type;
+    if (type == typeid(ScalarFloat)) {
+        expect(1);
+        *(ScalarFloat *) param.ptr = v[0];
+    } else if (type == typeid(Float)) {
+        expect(1);
+        *(Float *) param.ptr = Float(v[0]);
+    } else if (type == typeid(ScalarColor3f)) {
+        expect(3);
+        *(ScalarColor3f *) param.ptr = ScalarColor3f(v[0], v[1], v[2]);
+    } else if (type == typeid(Color3f)) {
+        expect(3);
+        *(Color3f *) param.ptr = Color3f(v[0], v[1], v[2]);
+    } else if (type == typeid(ScalarPoint3f)) {
+        expect(3);
+        *(ScalarPoint3f *) param.ptr = ScalarPoint3f(vec3(0));
+    } else if (type == typeid(ScalarVector3f)) {
+        expect(3);
+        *(ScalarVector3f *) param.ptr = vec3(0);
+    } else if (type == typeid(ScalarTransform4f)) {
+        *(ScalarTransform4f *) param.ptr = transform();
+    } else {
+        Throw("Parameter \"%s\" has an unsupported type (%s)", name, type.name());
+    }
+}
+
+/**
+ * \brief Render an animation sequence described by the file \c frames_file
+ *
+ * The scene is only loaded once. For every frame, the specified parameter
+ * overrides are applied, the modified objects are notified via \ref
+ * Object::parameters_changed(), and the scene is rendered again.
+ */
+template <typename Float, typename Spectrum>
+bool render_sequence(Object *scene, size_t sensor_i, filesystem::path filename,
+                     const filesystem::path &frames_file) {
+    std::ifstream is(frames_file.string());
+    if (!is.good())
+        Throw("Could not open the frame list \"%s\"!", frames_file.string());
+
+    SceneTraversal traversal(scene);
+    release_mesh_buffers<Float, Spectrum>(traversal);
+    Log(Debug, "Scene parameters that can be modified by the frame list:");
+    for (const auto &kv : traversal.parameters())
+        Log(Debug, "  %s", kv.first);
+
+    std::string base = filename.string(),
+                extension = filename.extension().string();
+    base = base.substr(0, base.size() - extension.size());
+
+    std::string line;
+    size_t frame = 0;
+    bool success = true;
+    while (success && std::getline(is, line)) {
+        line = string::trim(line);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::unordered_set<Object *> modified;
+        for (const std::string &item : string::tokenize(line, ";")) {
+            auto sep = item.find('=');
+            if (sep == std::string::npos)
+                Throw("Frame %i: expected key=value pairs, got \"%s\"", frame, item);
+            std::string key   = string::trim(item.substr(0, sep)),
+                        value = string::trim(item.substr(sep + 1));
+
+            auto it = traversal.parameters().find(key);
+            if (it == traversal.parameters().end())
+                Throw("Frame %i: unknown scene parameter \"%s\"!", frame, key);
+
+            set_parameter<Float, Spectrum>(key, it->second, value);
+            modified.insert(it->second.owner);
+        }
+
+        Timer timer;
+        traversal.notify(modified);
+        Log(Info, "Frame %i: updated %i object(s) (took %s)", frame,
+            modified.size(), util::time_string(timer.value()));
+
+        success = render<Float, Spectrum>(
+            scene, sensor_i, base + tfm::format("_%04i", frame));
+        frame++;
+    }
+
+    return success;
+}
+
+#if !defined(__WINDOWS__)
+#  if defined(MSG_NOSIGNAL)
+#    define MTS_SEND_FLAGS MSG_NOSIGNAL
+#  else
+#    define MTS_SEND_FLAGS 0
+#  endif
+
+/// Connection to a client of the render server (see \ref run_server())
+class ServerConnection {
+public:
+    ServerConnection(int fd) : m_fd(fd) {
+#if defined(SO_NOSIGPIPE)
+        int value = 1;
+        setsockopt(m_fd, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(int));
+#endif
+    }
+
+    ~ServerConnection() { ::close(m_fd); }
+
+    /// Read a line of text. Returns \c false once the client hung up.
+    bool read_line(std::string &line) {
+        line.clear();
+        while (true) {
+            char c;
+            ssize_t rv = ::recv(m_fd, &c, 1, 0);
+            if (rv < 0 && errno == EINTR)
+                continue;
+            if (rv <= 0)
+                return !line.empty();
+            if (c == '\n')
+                return true;
+            if (c != '\r')
+                line += c;
+        }
+    }
+
+    /// Send a line of text, optionally followed by a binary payload
+    void send(std::string line, const void *data = nullptr, size_t size = 0) {
+        std::replace(line.begin(), line.end(), '\n', ' ');
+        line += '\n';
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+        write(line.data(), line.size());
+        if (size > 0)
+            write(data, size);
+    }
+
+private:
+    void write(const void *ptr, size_t size) {
+        const char *p = (const char *) ptr;
+        /* Keep rendering if the client went away, the output is discarded */
+        while (size > 0 && m_good) {
+            ssize_t rv = ::send(m_fd, p, size, MTS_SEND_FLAGS);
+            if (rv < 0) {
+                if (errno == EINTR)
+                    continue;
+                m_good = false;
+                break;
+            }
+            p += rv;
+            size -= (size_t) rv;
+        }
+    }
+
+    int m_fd;
+    bool m_good = true;
+    std::mutex m_mutex;
+};
+
+/// Forwards warnings and progress messages of a job to the client
+class ServerAppender : public Appender {
+public:
+    ServerAppender(ServerConnection *conn) : m_conn(conn) { }
+
+    void append(LogLevel level, const std::string &text) override {
+        if (level >= Warn)
+            m_conn->send("log " + text);
+    }
+
+    void log_progress(float progress, const std::string & /* name */,
+                      const std::string & /* formatted */, const std::string & /* eta */,
+                      const void * /* ptr */) override {
+        m_conn->send(tfm::format("progress %.1f", progress));
+        m_started = true;
+    }
+
+    /// Has the rendering reported progress (i.e. is the film prepared)?
+    bool started() const { return m_started; }
+
+private:
+    ServerConnection *m_conn;
+    std::atomic<bool> m_started { false };
+};
+
+/// Description of a job submitted to the render server
+struct ServerJob {
+    std::string scene;
+    std::string mode;
+    std::string output;
+    std::vector<std::pair<std::string, std::string>> overrides;
+    size_t sensor = 0;
+    size_t spp = 0;
+};
+
+/// Interval (in milliseconds) at which modified image regions are streamed
+#define MTS_SERVER_STREAM_INTERVAL 1000
+
+template <typename Float, typename Spectrum>
+bool serve_job(Object *scene_, const ServerJob &job, ServerConnection &conn) {
+    MTS_IMPORT_TYPES(Sampler)
+    auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (job.sensor >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    auto integrator = scene->integrator();
+    if (!integrator)
+        Throw("No integrator specified for scene: %s", scene->to_string());
+
+    if (!job.overrides.empty()) {
+        SceneTraversal traversal(scene);
+        release_mesh_buffers<Float, Spectrum>(traversal);
+        std::unordered_set<Object *> modified;
+        for (const auto &kv : job.overrides) {
+            auto it = traversal.parameters().find(kv.first);
+            if (it == traversal.parameters().end())
+                Throw("Unknown scene parameter \"%s\"!", kv.first);
+            set_parameter<Float, Spectrum>(kv.first, it->second, kv.second);
+            modified.insert(it->second.owner);
+        }
+        traversal.notify(modified);
+    }
+
+    auto sensor = scene->sensors()[job.sensor];
+    auto film = sensor->film();
+    auto sampler = sensor->sampler();
+
+    /* Stream the image regions that received new samples since the
+       previous update. The film keeps track of these regions, hence
+       unmodified parts of the image are neither developed nor copied. */
+    ref<Bitmap> preview;
+    std::vector<std::pair<ScalarPoint2i, ScalarVector2i>> regions;
+    std::vector<uint8_t> buffer;
+
+    auto stream_regions = [&]() {
+        if (!preview) {
+            preview = film->bitmap();
+            conn.send(tfm::format("image %i %i %i %s", preview->width(), preview->height(),
+                                  preview->channel_count(), preview->component_format()));
+        }
+
+        regions.clear();
+        film->develop_incremental(ScalarPoint2i(0), film->crop_size(),
+                                  ScalarPoint2i(0), preview.get(), &regions);
+
+        size_t bpp = preview->bytes_per_pixel();
+        for (const auto &[offset, size] : regions) {
+            size_t x = (size_t) offset.x(), y = (size_t) offset.y(),
+                   w = (size_t) size.x(),   h = (size_t) size.y();
+
+            buffer.resize(w * h * bpp);
+            for (size_t j = 0; j < h; ++j)
+                memcpy(buffer.data() + j * w * bpp,
+                       preview->uint8_data() + ((y + j) * preview->width() + x) * bpp,
+                       w * bpp);
+
+            conn.send(tfm::format("tile %i %i %i %i %i", x, y, w, h, buffer.size()),
+                      buffer.data(), buffer.size());
+        }
+    };
+
+    ref<Logger> logger = Thread::thread()->logger();
+    ref<ServerAppender> appender = new ServerAppender(&conn);
+    logger->add_appender(appender);
+
+    /* The scene is cached across jobs: detach the appender and restore the
+       sample count on every exit path */
+    struct JobGuard {
+        Logger *logger;
+        ServerAppender *appender;
+        Sampler *sampler;
+        size_t sample_count;
+
+        ~JobGuard() {
+            logger->remove_appender(appender);
+            sampler->set_sample_count(sample_count);
+        }
+    } job_guard { logger.get(), appender.get(), sampler, sampler->sample_count() };
+
+    if (job.spp > 0)
+        sampler->set_sample_count(job.spp);
+
+    /* Render on a separate thread, while this (connection) thread
+       periodically streams the modified regions to the client */
+    ThreadEnvironment env;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool finished = false, success = false;
+    std::exception_ptr error, stream_error;
+
+    std::thread render_thread([&]() {
+        Thread::register_external_thread("srv");
+        {
+            ScopedSetThreadEnvironment set_env(env);
+            try {
+                success = integrator->render(scene, sensor.get());
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        Thread::unregister_external_thread();
+
+        std::lock_guard<std::mutex> guard(mutex);
+        finished = true;
+        cv.notify_one();
+    });
+
+    /* The render thread must be joined on every exit path. If streaming
+       fails (e.g. because the client disconnected), stop the render and
+       report the error once it has finished. */
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!cv.wait_for(lock, std::chrono::milliseconds(MTS_SERVER_STREAM_INTERVAL),
+                        [&]() { return finished; })) {
+        if (stream_error || !appender->started())
+            continue;
+        lock.unlock();
+        try {
+            stream_regions();
+        } catch (...) {
+            stream_error = std::current_exception();
+            integrator->cancel();
+        }
+        lock.lock();
+    }
+    lock.unlock();
+    render_thread.join();
+
+    if (stream_error)
+        std::rethrow_exception(stream_error);
+    if (error)
+        std::rethrow_exception(error);
+
+    if (success) {
+        stream_regions();
+        if (!job.output.empty()) {
+            fs::path filename(job.output);
+            filename.replace_extension("exr");
+            film->set_destination_file(filename);
+            film->develop();
+        }
+    }
+
+    return success;
+}
+
+/**
+ * \brief Run a persistent render server, which accepts jobs over the UNIX
+ * domain socket \c socket_path (see the description of --server)
+ *
+ * Parsed scenes are cached per file and variant, and they are only reloaded
+ * when the modification time of the scene file changes.
+ */
+void run_server(const std::string &socket_path, const std::string &default_mode,
+                const xml::ParameterList &params) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(sockaddr_un));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path))
+        Throw("--server: the socket path \"%s\" is too long!", socket_path);
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        Throw("--server: could not create socket: %s", strerror(errno));
+
+    ::unlink(socket_path.c_str());
+    if (::bind(fd, (sockaddr *) &addr, sizeof(sockaddr_un)) < 0 || ::listen(fd, 16) < 0) {
+        std::string reason = strerror(errno);
+        ::close(fd);
+        Throw("--server: could not listen on \"%s\": %s", socket_path, reason);
+    }
+
+    Log(Info, "Render server listening on \"%s\" ..", socket_path);
+
+    struct CachedScene {
+        ref<Object> scene;
+        time_t mtime;
+    };
+    std::map<std::pair<std::string, std::string>, CachedScene> cache;
+
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+    bool running = true;
+
+    while (running) {
+        int client = ::accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno != EINTR)
+                Log(Warn, "--server: accept() failed: %s", strerror(errno));
+            continue;
+        }
+
+        ServerConnection conn(client);
+        ServerJob job;
+        job.mode = default_mode;
+        std::string line;
+
+        while (running && conn.read_line(line)) {
+            try {
+                line = string::trim(line);
+                if (line.empty() || line[0] == '#')
+                    continue;
+
+                auto sep = line.find(' ');
+                std::string command = line.substr(0, sep),
+                            arg = sep == std::string::npos ? "" : string::trim(line.substr(sep + 1));
+
+                if (command == "scene") {
+                    job.scene = arg;
+                } else if (command == "mode") {
+                    job.mode = arg;
+                } else if (command == "set") {
+                    auto eq = arg.find('=');
+                    if (eq == std::string::npos)
+                        Throw("set: expected key=value pair!");
+                    job.overrides.emplace_back(string::trim(arg.substr(0, eq)),
+                                               string::trim(arg.substr(eq + 1)));
+                } else if (command == "sensor") {
+                    job.sensor = std::stoul(arg);
+                } else if (command == "spp") {
+                    job.spp = std::stoul(arg);
+                } else if (command == "output") {
+                    // Clients may only write below the working directory of the server
+                    auto parts = string::tokenize(arg, "/\\");
+                    if (fs::path(arg).is_absolute() ||
+                        std::find(parts.begin(), parts.end(), "..") != parts.end())
+                        Throw("output: \"%s\" must be a relative path that stays within "
+                              "the working directory of the server!", arg);
+                    job.output = arg;
+                } else if (command == "shutdown") {
+                    running = false;
+                    conn.send("done");
+                } else if (command == "render") {
+                    ServerJob current = std::move(job);
+                    job = ServerJob();
+                    job.mode = default_mode;
+
+                    if (current.scene.empty())
+                        Throw("render: no scene was specified!");
+                    fs::path path = fs::absolute(current.scene);
+
+                    struct stat st;
+                    if (::stat(path.string().c_str(), &st) != 0)
+                        Throw("render: scene file \"%s\" does not exist!", path.string());
+
+                    // Add the scene file's directory to the search path.
+                    ref<FileResolver> fr2 = new FileResolver(*fr);
+                    if (!fr2->contains(path.parent_path()))
+                        fr2->append(path.parent_path());
+                    thread->set_file_resolver(fr2);
+
+                    Timer timer;
+                    auto key = std::make_pair(path.string(), current.mode);
+                    auto it = cache.find(key);
+                    if (it == cache.end() || it->second.mtime != st.st_mtime) {
+                        Log(Info, "Loading scene \"%s\" (%s) ..", path.string(), current.mode);
+                        ref<Object> scene = xml::load_file(path.string(), current.mode, params);
+                        it = cache.insert_or_assign(key, CachedScene{ scene, st.st_mtime }).first;
+                        conn.send(tfm::format("log Loaded the scene in %s",
+                                              util::time_string(timer.value())));
+                    }
+
+                    bool success = MTS_INVOKE_VARIANT(current.mode, serve_job,
+                                                      it->second.scene.get(), current, conn);
+                    thread->set_file_resolver(fr);
+
+                    if (success)
+                        conn.send(tfm::format("done %s", util::time_string(timer.value())));
+                    else
+                        conn.send("error rendering failed");
+                } else {
+                    Throw("unknown command \"%s\"", command);
+                }
+            } catch (const std::exception &e) {
+                thread->set_file_resolver(fr);
+                conn.send(std::string("error ") + e.what());
+            }
+        }
+    }
+
+    ::close(fd);
+    ::unlink(socket_path.c_str());
+    Log(Info, "Render server stopped.");
+}
+#endif
+
 #if !defined(__WINDOWS__)
 // Handle the hang-up signal and write a partially rendered image to disk
 void hup_signal_handler(int signal) {
@@ -132,6 +876,11 @@ int main(int argc, char *argv[]) {
     auto arg_update    = parser.add(StringVec{ "-u", "--update" }, false);
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_trace     = parser.add(StringVec{ "--trace" }, true);
+    auto arg_frames    = parser.add(StringVec{ "-f", "--frames" }, true);
+    auto arg_server    = parser.add(StringVec{ "--server" }, true);
+    auto arg_coord     = parser.add(StringVec{ "--coordinator" }, true);
+    auto arg_worker    = parser.add(StringVec{ "--worker" }, true);
     auto arg_extra     = parser.add("", true);
     bool print_profile = false;
     xml::ParameterList params;
@@ -174,6 +923,15 @@ int main(int argc, char *argv[]) {
 
         size_t sensor_i  = (*arg_sensor_i ? arg_sensor_i->as_int() : 0);
 
+        if (*arg_trace) {
+#if defined(MTS_ENABLE_PROFILER)
+            Profiler::set_trace_enabled(true);
+#else
+            Log(Warn, "--trace: Mitsuba was compiled without profiler support, "
+                      "no timeline will be recorded.");
+#endif
+        }
+
         // Initialize Intel Thread Building Blocks with the requested number of threads
         if (*arg_threads)
             __global_thread_count = arg_threads->as_int();
@@ -188,7 +946,29 @@ int main(int argc, char *argv[]) {
         if (!fr->contains(base_path))
             fr->append(base_path);
 
-        if (!*arg_extra || *arg_help) {
+        if (*arg_coord) {
+            coordinator_socket = new ServerSocket((uint16_t) arg_coord->as_int());
+            Log(Info, "Listening for remote workers on port %i.", coordinator_socket->port());
+        }
+
+        if (*arg_worker) {
+            std::string address = arg_worker->as_string();
+            auto sep = address.rfind(':');
+            if (sep == std::string::npos)
+                Throw("--worker: expected a <host>:<port> pair!");
+            worker_host = address.substr(0, sep);
+            worker_port = (uint16_t) std::stoi(address.substr(sep + 1));
+            if (*arg_frames)
+                Throw("--worker: can't be combined with --frames!");
+        }
+
+        if (*arg_server) {
+#if !defined(__WINDOWS__)
+            run_server(arg_server->as_string(), mode, params);
+#else
+            Throw("--server: this feature is not available on Windows.");
+#endif
+        } else if (!*arg_extra || *arg_help) {
             help((int) __global_thread_count);
         } else {
             Log(Info, "%s", util::info_build((int) __global_thread_count));
@@ -217,11 +997,21 @@ int main(int argc, char *argv[]) {
             ref<Object> parsed =
                 xml::load_file(arg_extra->as_string(), mode, params, *arg_update);
 
-            bool success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
-                                              sensor_i, filename);
+            bool success;
+            if (*arg_frames)
+                success = MTS_INVOKE_VARIANT(mode, render_sequence, parsed.get(), sensor_i,
+                                             filename, filesystem::path(arg_frames->as_string()));
+            else
+                success = MTS_INVOKE_VARIANT(mode, render, parsed.get(),
+                                             sensor_i, filename);
             print_profile = print_profile || success;
             arg_extra = arg_extra->next();
         }
+
+        if (Profiler::trace_enabled()) {
+            Profiler::set_trace_enabled(false);
+            Profiler::write_trace(arg_trace->as_string());
+        }
     } catch (const std::exception &e) {
         error_msg = std::string("Caught a critical exception: ") + e.what();
     } catch (...) {
@@ -255,6 +1045,7 @@ int main(int argc, char *argv[]) {
 #endif
     }
 
+    coordinator_socket = nullptr;
     Profiler::static_shutdown();
     if (print_profile)
         Profiler::print_report();
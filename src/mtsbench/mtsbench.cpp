@@ -0,0 +1,739 @@
+#include <mitsuba/core/appender.h>
+#include <mitsuba/core/argparser.h>
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/jit.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/rfilter.h>
+#include <mitsuba/core/struct.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/core/xml.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/texture.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_scheduler_init.h>
+#include <chrono>
+#include <fstream>
+
+using namespace mitsuba;
+
+static void help(int thread_count) {
+    std::cout << util::info_build(thread_count) << std::endl;
+    std::cout << util::info_copyright() << std::endl;
+    std::cout << util::info_features() << std::endl;
+    std::cout << R"(
+Usage: mtsbench [options] [scene XML file]
+
+Runs a fixed suite of micro- and macro-benchmarks (kd-tree construction,
+ray casting, BSDF sampling/evaluation, texture lookups, image block
+splatting, struct conversion and volumetric path tracing of a procedural
+cloud) and reports the results as JSON. When a
+scene file is given, the ray casting benchmarks use its geometry instead
+of the built-in procedural mesh.
+
+Options:
+
+    -h, --help
+        Display this help text.
+
+    -m, --mode
+        Variant to benchmark. Can be specified multiple times to
+        benchmark several variants in one run (CUDA/autodiff variants
+        are skipped).
+
+        Default: )" MTS_DEFAULT_VARIANT R"(
+
+        Available modes:
+              )" << string::indent(MTS_VARIANTS, 14) << R"(
+    -v, --verbose
+        Be more verbose. (can be specified multiple times)
+
+    -t <count>, --threads <count>
+        Number of threads used by the kd-tree builder and the parallel
+        struct conversion benchmarks.
+
+    -n <count>, --iterations <count>
+        Number of work items (rays, samples, lookups) per micro-benchmark.
+        Default value: 1000000.
+
+    -r <count>, --resolution <count>
+        Tessellation of the procedural benchmark mesh. The mesh has
+        2 * count^2 triangles. Default value: 512.
+
+    -o <filename>, --output <filename>
+        Write the JSON report to "filename" instead of standard output.
+        Without this option, log messages are written to standard error,
+        so that the output can be redirected to a valid JSON file.
+)";
+}
+
+/// Result of a single benchmark run
+struct BenchmarkResult {
+    std::string variant;
+    std::string name;
+    std::string unit;
+    size_t items;
+    double seconds;
+    /// Estimated per-pixel variance of rendering benchmarks (zero otherwise)
+    double error = 0.0;
+    /// Peak memory usage (in bytes) of kd-tree build benchmarks (zero otherwise)
+    size_t memory = 0;
+};
+
+/// Run \c func once and return the elapsed wall-clock time in seconds
+template <typename Func> double measure(Func &&func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+/// Accumulates benchmark outputs so that the compiler cannot elide the work
+static volatile double benchmark_sink = 0.0;
+
+/**
+ * \brief Return a path for a scratch file of the benchmarks within the
+ * temporary directory of the system (instead of the working directory)
+ */
+static fs::path temporary_path(const std::string &name) {
+#if defined(__WINDOWS__)
+    const char *tmpdir = getenv("TEMP");
+#else
+    const char *tmpdir = getenv("TMPDIR");
+#endif
+    fs::path dir(tmpdir != nullptr ? tmpdir : "/tmp");
+    if (!fs::is_directory(dir))
+        dir = fs::current_path();
+    return dir / name;
+}
+
+/// Generate a randomly displaced height field with 2 * res^2 triangles
+template <typename Float, typename Spectrum>
+ref<Mesh<Float, Spectrum>> create_benchmark_mesh(uint32_t res) {
+    MTS_IMPORT_TYPES(Mesh)
+    using InputFloat  = typename Mesh::InputFloat;
+    using ScalarIndex = typename Mesh::ScalarIndex;
+
+    ref<Struct> vertex_struct = new Struct();
+    for (auto name : { "x", "y", "z" })
+        vertex_struct->append(name, struct_type_v<InputFloat>);
+
+    ref<Struct> face_struct = new Struct();
+    for (auto name : { "i0", "i1", "i2" })
+        face_struct->append(name, struct_type_v<ScalarIndex>);
+
+    uint32_t vertex_res = res + 1;
+    ref<Mesh> mesh = new Mesh("mtsbench_mesh", vertex_struct, vertex_res * vertex_res,
+                              face_struct, 2 * res * res);
+
+    PCG32<uint32_t> rng;
+    InputFloat *vertices = (InputFloat *) mesh->vertices();
+    for (uint32_t y = 0; y < vertex_res; ++y) {
+        for (uint32_t x = 0; x < vertex_res; ++x) {
+            InputFloat u = InputFloat(x) / InputFloat(res),
+                       v = InputFloat(y) / InputFloat(res);
+            *vertices++ = 2.f * u - 1.f;
+            *vertices++ = 2.f * v - 1.f;
+            *vertices++ = .1f * std::sin(10.f * u) * std::cos(7.f * v) +
+                          .01f * rng.next_float32();
+        }
+    }
+
+    ScalarIndex *faces = (ScalarIndex *) mesh->faces();
+    for (uint32_t y = 0; y < res; ++y) {
+        for (uint32_t x = 0; x < res; ++x) {
+            ScalarIndex i00 = y * vertex_res + x, i10 = i00 + 1,
+                        i01 = i00 + vertex_res, i11 = i01 + 1;
+            *faces++ = i00; *faces++ = i10; *faces++ = i11;
+            *faces++ = i00; *faces++ = i11; *faces++ = i01;
+        }
+    }
+
+    mesh->recompute_bbox();
+    return mesh;
+}
+
+/// Write a procedural cloud density grid (res^3 voxels) in the Mitsuba volume format
+static void write_cloud_volume(const fs::path &path, int32_t res) {
+    ref<FileStream> stream = new FileStream(path, FileStream::ETruncReadWrite);
+    stream->write("VOL", 3);
+    stream->write((uint8_t) 3);  // version
+    stream->write((int32_t) 1);  // float32 data
+    stream->write(res); stream->write(res); stream->write(res);
+    stream->write((int32_t) 1);  // channel count
+    for (float v : { -1.f, -1.f, -1.f, 1.f, 1.f, 1.f })
+        stream->write(v);
+
+    /* Soft sphere with a few octaves of (cheap) sinusoidal detail, which
+       gives the density the spatial variation of a cumulus cloud */
+    for (int32_t z = 0; z < res; ++z) {
+        for (int32_t y = 0; y < res; ++y) {
+            for (int32_t x = 0; x < res; ++x) {
+                float px = 2.f * (x + .5f) / res - 1.f,
+                      py = 2.f * (y + .5f) / res - 1.f,
+                      pz = 2.f * (z + .5f) / res - 1.f;
+                float detail = 0.f, scale = 1.f;
+                for (int octave = 0; octave < 4; ++octave) {
+                    float f = 3.f * (1 << octave);
+                    detail += scale * std::sin(f * px + 1.3f * octave) *
+                              std::sin(f * py + .7f * octave) *
+                              std::sin(f * pz + 2.1f * octave);
+                    scale *= .5f;
+                }
+                float r = std::sqrt(px * px + py * py + pz * pz);
+                stream->write(std::max(0.f, 1.f - r + .3f * detail));
+            }
+        }
+    }
+    stream->close();
+}
+
+/**
+ * Render a dense, high-albedo cloud using the volumetric path tracer with
+ * and without Russian roulette / splitting. Besides the render time, the
+ * per-pixel variance is estimated from two independent renderings, which
+ * yields the relative time that each configuration needs to reach the
+ * error of the first one (the product of time and variance).
+ */
+template <typename Float, typename Spectrum>
+void run_cloud_benchmark(const std::string &variant, std::vector<BenchmarkResult> &results) {
+    MTS_IMPORT_TYPES(Scene, Sensor)
+
+    fs::path volume_path = temporary_path("mtsbench_cloud.vol");
+    write_cloud_volume(volume_path, 64);
+
+    const int max_depth = 1024, width = 32, spp = 16;
+    auto render = [&](int rr_depth, float split_factor, int seed, double &seconds) {
+        std::string xml = tfm::format(R"(
+<scene version="2.0.0">
+    <integrator type="volpath">
+        <integer name="max_depth" value="%i"/>
+        <integer name="rr_depth" value="%i"/>
+        <float name="split_factor" value="%f"/>
+    </integrator>
+    <sensor type="perspective">
+        <transform name="to_world">
+            <lookat origin="0, 0, 4" target="0, 0, 0" up="0, 1, 0"/>
+        </transform>
+        <float name="fov" value="35"/>
+        <sampler type="independent">
+            <integer name="sample_count" value="%i"/>
+            <integer name="seed" value="%i"/>
+        </sampler>
+        <film type="hdrfilm">
+            <integer name="width" value="%i"/>
+            <integer name="height" value="%i"/>
+            <string name="pixel_format" value="rgb"/>
+            <rfilter type="box"/>
+        </film>
+    </sensor>
+    <emitter type="constant"/>
+    <shape type="sphere">
+        <bsdf type="null"/>
+        <medium name="interior" type="heterogeneous">
+            <volume name="sigma_t" type="gridvolume">
+                <string name="filename" value="%s"/>
+            </volume>
+            <float name="density_scale" value="40"/>
+            <rgb name="albedo" value="0.99"/>
+        </medium>
+    </shape>
+</scene>)", max_depth, rr_depth, split_factor, spp, seed, width, width,
+            volume_path.string());
+
+        ref<Scene> scene = dynamic_cast<Scene *>(xml::load_string(xml, variant).get());
+        Sensor *sensor = scene->sensors()[0].get();
+        seconds += measure([&]() { scene->integrator()->render(scene.get(), sensor); });
+        return sensor->film()->bitmap()->convert(Bitmap::PixelFormat::RGB,
+                                                 Struct::Type::Float32, false);
+    };
+
+    struct Configuration { const char *name; int rr_depth; float split_factor; };
+    const Configuration configs[] = {
+        { "volpath_cloud_no_rr", max_depth + 1, 1.f },
+        { "volpath_cloud_rr", 5, 1.f },
+        { "volpath_cloud_rr_split", 5, 4.f }
+    };
+
+    double reference_cost = 0.0;
+    for (const Configuration &config : configs) {
+        if (config.split_factor != 1.f && is_array_v<Float>)
+            continue;
+
+        double seconds = 0.0;
+        ref<Bitmap> img0 = render(config.rr_depth, config.split_factor, 0, seconds),
+                    img1 = render(config.rr_depth, config.split_factor, 1, seconds);
+
+        // Var[X] = E[(X_0 - X_1)^2] / 2 for two independent estimates X_0, X_1
+        const float *d0 = (const float *) img0->data(), *d1 = (const float *) img1->data();
+        size_t value_count = img0->pixel_count() * img0->channel_count();
+        double variance = 0.0;
+        for (size_t i = 0; i < value_count; ++i)
+            variance += sqr((double) d0[i] - (double) d1[i]);
+        variance /= 2.0 * value_count;
+
+        double cost = seconds * variance;
+        if (reference_cost == 0.0)
+            reference_cost = cost;
+        Log(Info, "%s: %-36s %.3f sec, variance %.4g, relative time to equal error %.3f",
+            variant, config.name, seconds, variance, cost / reference_cost);
+        results.push_back({ variant, config.name, "samples",
+                            2 * (size_t) (width * width * spp), seconds, variance });
+    }
+
+    fs::remove(volume_path);
+}
+
+template <typename Float, typename Spectrum>
+void run_benchmarks_impl(const std::string &variant, Object *parsed, size_t iterations,
+                         uint32_t resolution, std::vector<BenchmarkResult> &results) {
+    MTS_IMPORT_TYPES(BSDF, Mesh, ImageBlock, ReconstructionFilter, Sampler, Scene,
+                     Shape, ShapeKDTree, Texture)
+
+    constexpr size_t Width = array_size_v<Float>;
+    size_t packet_count = std::max(iterations / Width, (size_t) 1);
+    size_t item_count = packet_count * Width;
+
+    auto record = [&](const std::string &name, const std::string &unit,
+                      size_t items, double seconds) {
+        Log(Info, "%s: %-36s %.3f M%s/sec", variant, name,
+            items / seconds * 1e-6, unit);
+        results.push_back({ variant, name, unit, items, seconds });
+    };
+
+    PluginManager *pmgr = PluginManager::instance();
+    ref<Sampler> sampler = pmgr->create_object<Sampler>(Properties("independent"));
+    sampler->seed(0);
+
+    auto sample_wavelengths = [&]() {
+        Wavelength wavelengths;
+        if constexpr (is_spectral_v<Spectrum>)
+            std::tie(wavelengths, std::ignore) =
+                sample_wavelength<Float, Spectrum>(sampler->next_1d());
+        return wavelengths;
+    };
+
+    // ---------------------------------------------------------------------
+    //  Scene setup & kd-tree construction
+    // ---------------------------------------------------------------------
+
+    ref<Scene> scene = dynamic_cast<Scene *>(parsed);
+    if (parsed && !scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+
+    if (!scene) {
+        ref<Mesh> mesh = create_benchmark_mesh<Float, Spectrum>(resolution);
+        Properties props("scene");
+        props.set_object("mesh", mesh.get());
+        scene = new Scene(props);
+    }
+
+    for (bool compact : { false, true }) {
+        size_t prim_count = 0, memory = 0;
+        double build_time = measure([&]() {
+            Properties props;
+            props.set_bool("kd_compact", compact);
+            ref<ShapeKDTree> kdtree = new ShapeKDTree(props);
+            for (Shape *shape : scene->shapes())
+                kdtree->add_shape(shape);
+            kdtree->build();
+            prim_count = kdtree->primitive_count();
+            memory = kdtree->peak_build_memory();
+        });
+        std::string name = compact ? "kdtree_build_compact" : "kdtree_build";
+        record(name, "prims", prim_count, build_time);
+        results.back().memory = memory;
+        Log(Info, "%s: %-36s %s peak memory", variant, name, util::mem_string(memory));
+    }
+
+    // ---------------------------------------------------------------------
+    //  Ray casting (coherent & incoherent, closest hit & shadow rays)
+    // ---------------------------------------------------------------------
+
+    ScalarBoundingBox3f bbox = scene->bbox();
+    ScalarPoint3f center = bbox.center();
+    ScalarFloat radius = norm(bbox.extents()) * .5f;
+
+    /* Coherent rays: a pinhole camera looking at the scene from above,
+       rays are generated in scanline order */
+    size_t ray_res = (size_t) std::sqrt((double) item_count);
+    ScalarPoint3f eye = center + ScalarVector3f(0.f, 0.f, 2.f * radius);
+    auto coherent_ray = [&](size_t i) {
+        UInt32 index = UInt32(uint32_t(i * Width));
+        if constexpr (is_array_v<Float>)
+            index += arange<UInt32>();
+        Float u = Float(index % uint32_t(ray_res)) / Float(ray_res),
+              v = Float(index / uint32_t(ray_res)) / Float(ray_res);
+        Point3f target(center.x() + (2.f * u - 1.f) * radius,
+                       center.y() + (2.f * v - 1.f) * radius,
+                       center.z());
+        return Ray3f(Point3f(eye), normalize(target - eye), 0.f, sample_wavelengths());
+    };
+
+    /* Incoherent rays: random origins on the bounding sphere of the
+       scene, pointing in uniformly random directions */
+    auto incoherent_ray = [&]() {
+        Point3f o = center + radius * warp::square_to_uniform_sphere(sampler->next_2d());
+        Vector3f d = warp::square_to_uniform_sphere(sampler->next_2d());
+        return Ray3f(o, d, 0.f, sample_wavelengths());
+    };
+
+    std::vector<Ray3f> rays(packet_count);
+    for (size_t i = 0; i < packet_count; ++i)
+        rays[i] = coherent_ray(i);
+
+    double t = measure([&]() {
+        Float sum = 0.f;
+        for (size_t i = 0; i < packet_count; ++i)
+            sum += select(scene->ray_intersect(rays[i]).is_valid(), Float(1.f), Float(0.f));
+        benchmark_sink += hsum(sum);
+    });
+    record("ray_intersect_coherent", "rays", item_count, t);
+
+    t = measure([&]() {
+        Float sum = 0.f;
+        for (size_t i = 0; i < packet_count; ++i)
+            sum += select(scene->ray_test(rays[i]), Float(1.f), Float(0.f));
+        benchmark_sink += hsum(sum);
+    });
+    record("ray_test_coherent", "rays", item_count, t);
+
+    for (size_t i = 0; i < packet_count; ++i)
+        rays[i] = incoherent_ray();
+
+    t = measure([&]() {
+        Float sum = 0.f;
+        for (size_t i = 0; i < packet_count; ++i)
+            sum += select(scene->ray_intersect(rays[i]).is_valid(), Float(1.f), Float(0.f));
+        benchmark_sink += hsum(sum);
+    });
+    record("ray_intersect_incoherent", "rays", item_count, t);
+
+    t = measure([&]() {
+        Float sum = 0.f;
+        for (size_t i = 0; i < packet_count; ++i)
+            sum += select(scene->ray_test(rays[i]), Float(1.f), Float(0.f));
+        benchmark_sink += hsum(sum);
+    });
+    record("ray_test_incoherent", "rays", item_count, t);
+    rays.clear();
+
+    // ---------------------------------------------------------------------
+    //  BSDF sampling & evaluation
+    // ---------------------------------------------------------------------
+
+    std::vector<SurfaceInteraction3f> interactions(packet_count);
+    std::vector<Point2f> samples(packet_count);
+    std::vector<Vector3f> directions(packet_count);
+    for (size_t i = 0; i < packet_count; ++i) {
+        SurfaceInteraction3f &si = interactions[i];
+        si.t = 0.f;
+        si.p = 0.f;
+        si.n = Normal3f(0.f, 0.f, 1.f);
+        si.sh_frame = Frame3f(si.n);
+        si.uv = sampler->next_2d();
+        si.wi = warp::square_to_cosine_hemisphere(sampler->next_2d());
+        si.wavelengths = sample_wavelengths();
+        samples[i] = sampler->next_2d();
+        directions[i] = warp::square_to_cosine_hemisphere(sampler->next_2d());
+    }
+
+    BSDFContext ctx;
+    for (auto name : { "diffuse", "conductor", "roughconductor", "dielectric",
+                       "roughdielectric", "plastic", "roughplastic" }) {
+        ref<BSDF> bsdf = pmgr->create_object<BSDF>(Properties(name));
+
+        t = measure([&]() {
+            Float sum = 0.f;
+            for (size_t i = 0; i < packet_count; ++i)
+                sum += hsum(depolarize(bsdf->sample(ctx, interactions[i], samples[i].x(),
+                                                    samples[i]).second));
+            benchmark_sink += hsum(sum);
+        });
+        record(std::string("bsdf_sample_") + name, "samples", item_count, t);
+
+        t = measure([&]() {
+            Float sum = 0.f;
+            for (size_t i = 0; i < packet_count; ++i)
+                sum += hsum(depolarize(bsdf->eval(ctx, interactions[i], directions[i])));
+            benchmark_sink += hsum(sum);
+        });
+        record(std::string("bsdf_eval_") + name, "evals", item_count, t);
+    }
+
+    // ---------------------------------------------------------------------
+    //  Texture lookups
+    // ---------------------------------------------------------------------
+
+    /* The bitmap texture plugin loads its data from disk, so write a
+       noise image to a temporary file first */
+    fs::path texture_path = temporary_path("mtsbench_texture.exr");
+    {
+        ref<Bitmap> bitmap = new Bitmap(Bitmap::PixelFormat::RGB,
+                                        Struct::Type::Float32, Vector2u(1024, 1024));
+        PCG32<uint32_t> rng;
+        float *data = (float *) bitmap->data();
+        for (size_t i = 0; i < bitmap->pixel_count() * bitmap->channel_count(); ++i)
+            data[i] = rng.next_float32();
+        bitmap->write(texture_path);
+    }
+
+    Properties bitmap_props("bitmap");
+    bitmap_props.set_string("filename", texture_path.string());
+
+    std::vector<std::pair<std::string, ref<Texture>>> textures = {
+        { "checkerboard", pmgr->create_object<Texture>(Properties("checkerboard")) },
+        { "bitmap", pmgr->create_object<Texture>(bitmap_props) }
+    };
+    fs::remove(texture_path);
+
+    for (auto &[name, texture] : textures) {
+        t = measure([&]() {
+            Float sum = 0.f;
+            for (size_t i = 0; i < packet_count; ++i)
+                sum += hsum(texture->eval(interactions[i]));
+            benchmark_sink += hsum(sum);
+        });
+        record("texture_eval_" + name, "lookups", item_count, t);
+    }
+    interactions.clear();
+
+    // ---------------------------------------------------------------------
+    //  ImageBlock splatting
+    // ---------------------------------------------------------------------
+
+    ref<ReconstructionFilter> rfilter =
+        pmgr->create_object<ReconstructionFilter>(Properties("gaussian"));
+    ScalarVector2i block_size(64, 64);
+    ref<ImageBlock> block = new ImageBlock(block_size, 5, rfilter.get(), false, false);
+    block->clear();
+
+    for (size_t i = 0; i < packet_count; ++i)
+        samples[i] = sampler->next_2d() * ScalarVector2f(block_size);
+
+    Spectrum value(.5f);
+    t = measure([&]() {
+        for (size_t i = 0; i < packet_count; ++i)
+            block->put(samples[i], sample_wavelengths(), value, Float(1.f));
+    });
+    record("imageblock_put", "samples", item_count, t);
+
+    // ---------------------------------------------------------------------
+    //  Struct conversion (film development)
+    // ---------------------------------------------------------------------
+
+    ref<Bitmap> source = new Bitmap(Bitmap::PixelFormat::RGBA,
+                                    Struct::Type::Float32, Vector2u(3840, 2160));
+    {
+        PCG32<uint32_t> rng;
+        float *data = (float *) source->data();
+        for (size_t i = 0; i < source->pixel_count() * source->channel_count(); ++i)
+            data[i] = rng.next_float32();
+    }
+
+    t = measure([&]() {
+        ref<Bitmap> target = source->convert(Bitmap::PixelFormat::RGBA,
+                                             Struct::Type::UInt8, true);
+        benchmark_sink += target->uint8_data()[0];
+    });
+    record("struct_convert_rgba32f_to_srgb8", "pixels", source->pixel_count(), t);
+
+    t = measure([&]() {
+        ref<Bitmap> target = source->convert(Bitmap::PixelFormat::RGBA,
+                                             Struct::Type::Float16, false);
+        benchmark_sink += (double) target->uint8_data()[0];
+    });
+    record("struct_convert_rgba32f_to_rgba16f", "pixels", source->pixel_count(), t);
+
+    // Same conversion restricted to a single thread to show the parallel speedup
+    tbb::task_arena serial_arena(1);
+    t = measure([&]() {
+        serial_arena.execute([&]() {
+            ref<Bitmap> target = source->convert(Bitmap::PixelFormat::RGBA,
+                                                 Struct::Type::UInt8, true);
+            benchmark_sink += target->uint8_data()[0];
+        });
+    });
+    record("struct_convert_rgba32f_to_srgb8_serial", "pixels", source->pixel_count(), t);
+    source = nullptr;
+
+    // ---------------------------------------------------------------------
+    //  Volumetric path tracing (time to equal error on a dense cloud)
+    // ---------------------------------------------------------------------
+
+    if constexpr (!is_polarized_v<Spectrum>)
+        run_cloud_benchmark<Float, Spectrum>(variant, results);
+}
+
+template <typename Float, typename Spectrum>
+bool run_benchmarks(const std::string &variant, Object *parsed, size_t iterations,
+                    uint32_t resolution, std::vector<BenchmarkResult> &results) {
+    if constexpr (is_dynamic_array_v<Float>) {
+        ENOKI_MARK_USED(parsed);
+        ENOKI_MARK_USED(iterations);
+        ENOKI_MARK_USED(resolution);
+        ENOKI_MARK_USED(results);
+        Log(Warn, "Skipping variant \"%s\": only scalar and packet variants "
+                  "can be benchmarked.", variant);
+        return false;
+    } else {
+        run_benchmarks_impl<Float, Spectrum>(variant, parsed, iterations,
+                                             resolution, results);
+        return true;
+    }
+}
+
+/// Serialize the benchmark results into a JSON document
+static void write_json(std::ostream &os, const std::vector<BenchmarkResult> &results,
+                       size_t thread_count) {
+    os << "{" << std::endl
+       << "  \"version\": \"" << MTS_VERSION << "\"," << std::endl
+       << "  \"threads\": " << thread_count << "," << std::endl
+       << "  \"results\": [" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult &r = results[i];
+        os << "    { \"variant\": \"" << r.variant << "\", "
+           << "\"name\": \"" << r.name << "\", "
+           << "\"unit\": \"" << r.unit << "\", "
+           << "\"items\": " << r.items << ", "
+           << "\"seconds\": " << r.seconds << ", "
+           << "\"items_per_second\": " << (r.items / r.seconds);
+        if (r.error > 0.0)
+            os << ", \"error\": " << r.error;
+        if (r.memory > 0)
+            os << ", \"memory\": " << r.memory;
+        os << " }"
+           << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    os << "  ]" << std::endl << "}" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    Jit::static_initialization();
+    Class::static_initialization();
+    Thread::static_initialization();
+    Logger::static_initialization();
+    Bitmap::static_initialization();
+    Profiler::static_initialization();
+
+    // Ensure that the mitsuba-render shared library is loaded
+    librender_nop();
+
+    ArgParser parser;
+    using StringVec     = std::vector<std::string>;
+    auto arg_threads    = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_verbose    = parser.add(StringVec{ "-v", "--verbose" }, false);
+    auto arg_iterations = parser.add(StringVec{ "-n", "--iterations" }, true);
+    auto arg_resolution = parser.add(StringVec{ "-r", "--resolution" }, true);
+    auto arg_output     = parser.add(StringVec{ "-o", "--output" }, true);
+    auto arg_help       = parser.add(StringVec{ "-h", "--help" });
+    auto arg_mode       = parser.add(StringVec{ "-m", "--mode" }, true);
+    auto arg_extra      = parser.add("", true);
+    std::string error_msg;
+
+    try {
+        // Parse all command line options
+        parser.parse(argc, argv);
+
+        /* Keep standard output free for the JSON report */
+        if (!*arg_output && !*arg_help) {
+            auto logger = Thread::thread()->logger();
+            logger->clear_appenders();
+            logger->add_appender(new StreamAppender(&std::cerr));
+        }
+
+        if (*arg_verbose) {
+            auto logger = Thread::thread()->logger();
+            if (arg_verbose->next())
+                logger->set_log_level(Trace);
+            else
+                logger->set_log_level(Debug);
+        }
+
+        // Initialize Intel Thread Building Blocks with the requested number of threads
+        if (*arg_threads)
+            __global_thread_count = arg_threads->as_int();
+        if (__global_thread_count < 1)
+            Throw("Thread count must be >= 1!");
+        tbb::task_scheduler_init init((int) __global_thread_count);
+
+        if (*arg_help) {
+            help((int) __global_thread_count);
+        } else {
+            size_t iterations = *arg_iterations ? (size_t) arg_iterations->as_int() : 1000000;
+            uint32_t resolution = *arg_resolution ? (uint32_t) arg_resolution->as_int() : 512;
+            if (iterations == 0 || resolution == 0)
+                Throw("Iteration count and mesh resolution must be >= 1!");
+
+#if !defined(NDEBUG)
+            Log(Warn, "mtsbench is compiled in debug mode, timings will not be representative.");
+#endif
+
+            // Append the mitsuba directory to the FileResolver search path list
+            ref<Thread> thread = Thread::thread();
+            ref<FileResolver> fr = thread->file_resolver();
+            filesystem::path base_path = util::library_path().parent_path();
+            if (!fr->contains(base_path))
+                fr->append(base_path);
+
+            StringVec modes;
+            for (auto arg = arg_mode; arg && *arg; arg = arg->next())
+                modes.push_back(arg->as_string());
+            if (modes.empty())
+                modes.push_back(MTS_DEFAULT_VARIANT);
+
+            std::vector<BenchmarkResult> results;
+            for (const std::string &mode : modes) {
+                ref<Object> parsed;
+                if (*arg_extra) {
+                    filesystem::path filename(arg_extra->as_string());
+                    if (!fr->contains(filename.parent_path()))
+                        fr->append(filename.parent_path());
+                    parsed = xml::load_file(arg_extra->as_string(), mode);
+                }
+
+                MTS_INVOKE_VARIANT(mode, run_benchmarks, mode, parsed.get(),
+                                   iterations, resolution, results);
+            }
+
+            if (*arg_output) {
+                std::ofstream os(arg_output->as_string());
+                if (!os.good())
+                    Throw("Unable to open output file \"%s\"!", arg_output->as_string());
+                write_json(os, results, __global_thread_count);
+            } else {
+                write_json(std::cout, results, __global_thread_count);
+            }
+        }
+    } catch (const std::exception &e) {
+        error_msg = std::string("Caught a critical exception: ") + e.what();
+    } catch (...) {
+        error_msg = std::string("Caught a critical exception of unknown type!");
+    }
+
+    if (!error_msg.empty())
+        std::cerr << std::endl << error_msg << std::endl;
+
+    Profiler::static_shutdown();
+    Bitmap::static_shutdown();
+    Logger::static_shutdown();
+    Thread::static_shutdown();
+    Class::static_shutdown();
+    Jit::static_shutdown();
+    return error_msg.empty() ? 0 : -1;
+}
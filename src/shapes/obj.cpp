@@ -4,6 +4,7 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/mmap.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/timer.h>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -94,6 +95,7 @@ public:
     }
 
     OBJMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
         /* Causes all texture coordinates to be vertically flipped.
            Enabled by default, for consistence with the Mitsuba 1 behavior. */
         bool flip_tex_coords = props.bool_("flip_tex_coords", true);
@@ -5,6 +5,7 @@
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/timer.h>
 #include <enoki/half.h>
 #include <unordered_map>
@@ -78,6 +79,7 @@ public:
     };
 
     PLYMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
         /// Process vertex/index records in large batches
         constexpr size_t elements_per_packet = 1024;
 
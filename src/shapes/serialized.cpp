@@ -4,6 +4,7 @@
 #include <mitsuba/core/zstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/profiler.h>
 #include <mitsuba/core/timer.h>
 
 NAMESPACE_BEGIN(mitsuba)
@@ -172,6 +173,7 @@ public:
     }
 
     SerializedMesh(const Properties &props) : Base(props) {
+        ScopedPhase sp(ProfilerPhase::LoadGeometry);
         auto fail = [&](const std::string &descr) {
             Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
         };
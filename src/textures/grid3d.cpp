@@ -1,9 +1,11 @@
 #include <enoki/stl.h>
+#include <enoki/half.h>
 
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/srgb.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/volume_texture.h>
@@ -28,6 +30,16 @@ class GridVolumeImpl;
  * operation makes sense after the file has been mapped into memory:
  *     data[((zpos*yres + ypos)*xres + xpos)*channels + chan]}
  *     where (xpos, ypos, zpos, chan) denotes the lookup location.
+ *
+ * Storage precision:
+ * The "storage" parameter selects how the values are kept in memory. The
+ * default ("float32") uses the floating point type of the variant. "float16"
+ * stores half precision values, and "uint8" quantizes the values of every
+ * brick of 8x8x8 grid points to 8 bits relative to the value range of the
+ * brick. Values are decoded on the fly during trilinear interpolation, and
+ * the minimum and maximum of the grid refer to the decoded values. Quantized
+ * storage is not supported for spectrally upsampled RGB data, and the GPU and
+ * differentiable variants always use full precision.
  */
 template <typename Float, typename Spectrum>
 class GridVolume final : public Volume<Float, Spectrum> {
@@ -61,6 +73,8 @@ public:
                 scaled_data_ptr += 4;
             }
             m_metadata.mean = mean;
+            // The spectral upsampling does not preserve a useful lower bound
+            m_metadata.min = 0.f;
             m_metadata.max = max;
             m_data = DynamicBuffer<Float>::copy(scaled_data.get(), size * 4);
         } else {
@@ -70,6 +84,7 @@ public:
         // Mark values which are only used in the implementation class as queried
         props.mark_queried("use_grid_bbox");
         props.mark_queried("max_value");
+        props.mark_queried("storage");
     }
 
     Mask is_inside(const Interaction3f & /* it */, Mask /*active*/) const override {
@@ -112,6 +127,13 @@ public:
     MTS_IMPORT_BASE(Volume, is_inside, update_bbox, m_world_to_local)
     MTS_IMPORT_TYPES()
 
+    /// Number of values stored per grid point (RGB data is upsampled to 3 coefficients + scale)
+    static constexpr uint32_t StorageChannels =
+        (is_spectral_v<Spectrum> && !Raw && Channels == 3) ? 4 : Channels;
+
+    /// Side length of the bricks that share a value range in quantized storage
+    static constexpr uint32_t BrickSize = 8;
+
     GridVolumeImpl(const Properties &props, const VolumeMetadata &meta,
                const DynamicBuffer<Float> &data)
         : Base(props) {
@@ -124,6 +146,30 @@ public:
             update_bbox();
         }
 
+        std::string storage = string::to_lower(props.string("storage", "float32"));
+        if (storage == "float32")
+            m_storage = StorageFormat::Float32;
+        else if (storage == "float16")
+            m_storage = StorageFormat::Float16;
+        else if (storage == "uint8")
+            m_storage = StorageFormat::UInt8;
+        else
+            Throw("Invalid storage format \"%s\", must be one of: \"float32\", "
+                  "\"float16\" or \"uint8\"!", storage);
+
+        if (m_storage != StorageFormat::Float32) {
+            if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+                Log(Warn, "Reduced-precision storage of grid volumes is not supported by "
+                          "this variant, using full precision instead.");
+                m_storage = StorageFormat::Float32;
+            } else {
+                if (StorageChannels == 4 && m_storage == StorageFormat::UInt8)
+                    Throw("\"uint8\" storage is not supported for spectrally upsampled RGB "
+                          "data, use \"float16\" instead!");
+                pack_data();
+            }
+        }
+
         if (props.has_property("max_value")) {
             m_fixed_max    = true;
             m_metadata.max = props.float_("max_value");
@@ -270,15 +316,15 @@ public:
         Index index = fmadd(fmadd(pi.z(), ny, pi.y()), nx, pi.x());
 
         // Load 8 grid positions to perform trilinear interpolation
-        auto raw_data = m_data.data();
-        auto d000 = gather<StorageType>(raw_data, index, active),
-             d001 = gather<StorageType>(raw_data, index + 1, active),
-             d010 = gather<StorageType>(raw_data, index + nx, active),
-             d011 = gather<StorageType>(raw_data, index + nx + 1, active),
-             d100 = gather<StorageType>(raw_data, index + z_offset, active),
-             d101 = gather<StorageType>(raw_data, index + z_offset + 1, active),
-             d110 = gather<StorageType>(raw_data, index + z_offset + nx, active),
-             d111 = gather<StorageType>(raw_data, index + z_offset + nx + 1, active);
+        Index3 pj = pi + 1u;
+        auto d000 = fetch<StorageType>(index,                     pi.x(), pi.y(), pi.z(), active),
+             d001 = fetch<StorageType>(index + 1,                 pj.x(), pi.y(), pi.z(), active),
+             d010 = fetch<StorageType>(index + nx,                pi.x(), pj.y(), pi.z(), active),
+             d011 = fetch<StorageType>(index + nx + 1,            pj.x(), pj.y(), pi.z(), active),
+             d100 = fetch<StorageType>(index + z_offset,          pi.x(), pi.y(), pj.z(), active),
+             d101 = fetch<StorageType>(index + z_offset + 1,      pj.x(), pi.y(), pj.z(), active),
+             d110 = fetch<StorageType>(index + z_offset + nx,     pi.x(), pj.y(), pj.z(), active),
+             d111 = fetch<StorageType>(index + z_offset + nx + 1, pj.x(), pj.y(), pj.z(), active);
 
         ResultType v000, v001, v010, v011, v100, v101, v110, v111;
         Float scale = 1.f;
@@ -340,17 +386,172 @@ public:
 
     }
 
+    /**
+     * Load the values of the grid point with linear index \c index and
+     * integer coordinates (\c x, \c y, \c z), decoding them if the grid uses
+     * reduced-precision storage.
+     */
+    template <typename StorageType>
+    MTS_INLINE StorageType fetch(const UInt32 &index, const UInt32 &x, const UInt32 &y,
+                                 const UInt32 &z, Mask active) const {
+        if constexpr (is_cuda_array_v<Float> || is_diff_array_v<Float>) {
+            ENOKI_MARK_USED(x); ENOKI_MARK_USED(y); ENOKI_MARK_USED(z);
+            return gather<StorageType>(m_data.data(), index, active);
+        } else {
+            if (m_storage == StorageFormat::Float32)
+                return gather<StorageType>(m_data.data(), index, active);
+
+            StorageType result;
+            UInt32 offset = index * StorageChannels;
+            if (m_storage == StorageFormat::Float16) {
+                for (size_t c = 0; c < StorageChannels; ++c)
+                    result.coeff(c) = half_to_float(load_packed<uint16_t>(offset + c, active));
+            } else {
+                UInt32 brick = fmadd(fmadd(z / BrickSize, m_brick_res.y(), y / BrickSize),
+                                     m_brick_res.x(), x / BrickSize) * StorageChannels;
+                for (size_t c = 0; c < StorageChannels; ++c) {
+                    Float q = Float(load_packed<uint8_t>(offset + c, active));
+                    result.coeff(c) = fmadd(q, gather<Float>(m_brick_scale.get(), brick + c, active),
+                                            gather<Float>(m_brick_offset.get(), brick + c, active));
+                }
+            }
+            return result;
+        }
+    }
+
+    /// Load packed values of type \c T from \c m_packed and zero-extend them to 32 bit
+    template <typename T>
+    MTS_INLINE UInt32 load_packed(const UInt32 &offset, Mask active) const {
+        const T *ptr = (const T *) m_packed.get();
+        if constexpr (!is_array_v<Float>) {
+            return active ? (uint32_t) ptr[offset] : 0u;
+        } else {
+            /* Gather 32 bits starting at each value and discard the upper
+               part. The buffer is padded so that this never reads past its end */
+            return gather<UInt32, sizeof(T)>(ptr, offset, active) &
+                   (uint32_t) std::numeric_limits<T>::max();
+        }
+    }
+
+    /// Decode IEEE 754 half precision values (Inf and NaN are not supported)
+    MTS_INLINE static Float half_to_float(const UInt32 &h) {
+        using Float32 = float32_array_t<Float>;
+        // Shift exponent & mantissa into place and rebias the exponent (15 -> 127)
+        Float32 magnitude = reinterpret_array<Float32>((h & 0x7fffu) << 13) * 0x1p112f;
+        return Float(reinterpret_array<Float32>(reinterpret_array<UInt32>(magnitude) |
+                                                ((h & 0x8000u) << 16)));
+    }
+
+    /// Convert \c m_data into the reduced-precision representation selected by \c m_storage
+    void pack_data() {
+        const ScalarFloat *data = (const ScalarFloat *) m_data.data();
+        size_t count = m_size * StorageChannels,
+               value_size = m_storage == StorageFormat::Float16 ? sizeof(uint16_t)
+                                                                : sizeof(uint8_t);
+
+        // Pad the buffer, load_packed() reads 32 bits at a time
+        m_packed = std::unique_ptr<uint8_t[]>(new uint8_t[count * value_size + sizeof(uint32_t)]());
+        std::unique_ptr<ScalarFloat[]> decoded(new ScalarFloat[count]);
+
+        if (m_storage == StorageFormat::Float16) {
+            uint16_t *out = (uint16_t *) m_packed.get();
+            for (size_t i = 0; i < count; ++i) {
+                out[i]     = enoki::half::float32_to_float16((float) data[i]);
+                decoded[i] = (ScalarFloat) enoki::half::float16_to_float32(out[i]);
+            }
+        } else {
+            ScalarVector3u shape(m_metadata.shape);
+            m_brick_res = (shape + (BrickSize - 1)) / BrickSize;
+            size_t brick_count = hprod(m_brick_res) * StorageChannels;
+            m_brick_offset = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[brick_count]);
+            m_brick_scale  = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[brick_count]);
+
+            auto brick_index = [&](size_t i) {
+                size_t x = i % shape.x(), y = (i / shape.x()) % shape.y(),
+                       z = i / (shape.x() * shape.y());
+                return (((z / BrickSize) * m_brick_res.y() + y / BrickSize) * m_brick_res.x() +
+                        x / BrickSize) * StorageChannels;
+            };
+
+            // Determine the value range of every brick
+            std::vector<ScalarFloat> brick_max(brick_count, -math::Infinity<ScalarFloat>);
+            for (size_t i = 0; i < brick_count; ++i)
+                m_brick_offset[i] = math::Infinity<ScalarFloat>;
+            for (size_t i = 0; i < m_size; ++i) {
+                size_t brick = brick_index(i);
+                for (size_t c = 0; c < StorageChannels; ++c) {
+                    ScalarFloat value = data[i * StorageChannels + c];
+                    m_brick_offset[brick + c] = std::min(m_brick_offset[brick + c], value);
+                    brick_max[brick + c] = std::max(brick_max[brick + c], value);
+                }
+            }
+            for (size_t i = 0; i < brick_count; ++i)
+                m_brick_scale[i] = (brick_max[i] - m_brick_offset[i]) / 255.f;
+
+            // Quantize relative to the range of the containing brick
+            uint8_t *out = m_packed.get();
+            for (size_t i = 0; i < m_size; ++i) {
+                size_t brick = brick_index(i);
+                for (size_t c = 0; c < StorageChannels; ++c) {
+                    size_t k = i * StorageChannels + c;
+                    ScalarFloat offset = m_brick_offset[brick + c],
+                                scale  = m_brick_scale[brick + c];
+                    ScalarFloat q = scale > 0.f ? std::round((data[k] - offset) / scale) : 0.f;
+                    q = std::min(std::max(q, (ScalarFloat) 0), (ScalarFloat) 255);
+                    out[k] = (uint8_t) q;
+                    decoded[k] = fmadd(q, scale, offset);
+                }
+            }
+        }
+
+        /* Heterogeneous media use the maximum as majorant, so the value range
+           must refer to the decoded values (only the scale matters for
+           spectrally upsampled data) */
+        ScalarFloat min_value = math::Infinity<ScalarFloat>,
+                    max_value = -math::Infinity<ScalarFloat>;
+        for (size_t i = 0; i < count; ++i) {
+            if (StorageChannels == 4 && i % 4 != 3)
+                continue;
+            min_value = std::min(min_value, decoded[i]);
+            max_value = std::max(max_value, decoded[i]);
+        }
+        if (StorageChannels != 4)
+            m_metadata.min = min_value;
+        m_metadata.max = max_value;
+
+        Log(Debug, "Grid volume data stored as %s: %s (instead of %s)", storage_name(),
+            util::mem_string(count * value_size), util::mem_string(count * sizeof(ScalarFloat)));
+
+        // The full-precision copy of the data is no longer needed
+        m_data = DynamicBuffer<Float>();
+    }
+
+    const char *storage_name() const {
+        switch (m_storage) {
+            case StorageFormat::Float16: return "float16";
+            case StorageFormat::UInt8: return "uint8";
+            default: return "float32";
+        }
+    }
+
     ScalarFloat max() const override { return m_metadata.max; }
+    ScalarFloat min() const override { return m_metadata.min; }
     ScalarVector3i resolution() const override { return m_metadata.shape; };
     size_t data_size() const { return m_data.size(); }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_data);
-        callback->put_parameter("size", m_size);
+        // Packed data can't be exposed as a parameter
+        if (m_storage == StorageFormat::Float32) {
+            callback->put_parameter("data", m_data);
+            callback->put_parameter("size", m_size);
+        }
         Base::traverse(callback);
     }
 
     void parameters_changed() override {
+        if (m_storage != StorageFormat::Float32)
+            return;
+
         size_t new_size = data_size();
         if (m_size != new_size) {
             // Only support a special case: resolution doubling along all axes
@@ -369,6 +570,12 @@ public:
             auto maximum = hmax(hmax(m_data));
             m_metadata.max = slice(maximum, 0);
         }
+        if (Channels == 1 || Raw || !is_spectral_v<Spectrum>) {
+            auto minimum = hmin(hmin(detach(m_data)));
+            m_metadata.min = std::max((ScalarFloat) slice(minimum, 0), (ScalarFloat) 0.f);
+        } else {
+            m_metadata.min = 0.f;
+        }
     }
 
     std::string to_string() const override {
@@ -377,18 +584,29 @@ public:
             << "  world_to_local = " << m_world_to_local << "," << std::endl
             << "  dimensions = " << m_metadata.shape << "," << std::endl
             << "  mean = " << m_metadata.mean << "," << std::endl
+            << "  min = " << m_metadata.min << "," << std::endl
             << "  max = " << m_metadata.max << "," << std::endl
-            << "  channels = " << m_metadata.channel_count << std::endl
+            << "  channels = " << m_metadata.channel_count << "," << std::endl
+            << "  storage = " << storage_name() << std::endl
             << "]";
         return oss.str();
     }
 
     MTS_DECLARE_CLASS()
 protected:
+    enum class StorageFormat : uint32_t { Float32, Float16, UInt8 };
+
     DynamicBuffer<Float> m_data;
     bool m_fixed_max = false;
     VolumeMetadata m_metadata;
     size_t m_size;
+
+    StorageFormat m_storage;
+    /// Reduced-precision values (float16 or uint8 storage)
+    std::unique_ptr<uint8_t[]> m_packed;
+    /// Value range of every brick (uint8 storage): value = offset + scale * q
+    std::unique_ptr<ScalarFloat[]> m_brick_offset, m_brick_scale;
+    ScalarVector3u m_brick_res;
 };
 
 MTS_IMPLEMENT_CLASS_VARIANT(GridVolume, Volume)
@@ -0,0 +1,84 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def make_texture(tmpdir, data, filter_type):
+    from mitsuba.core import Bitmap
+    from mitsuba.core.xml import load_string
+
+    filename = str(tmpdir.join('texture.exr'))
+    Bitmap(data).write(filename)
+    return load_string("""<texture version="2.0.0" type="bitmap">
+            <string name="filename" value="{}"/>
+            <string name="filter_type" value="{}"/>
+            <boolean name="raw" value="true"/>
+        </texture>""".format(filename, filter_type))
+
+
+def test01_trilinear_levels(variant_scalar_rgb, tmpdir):
+    from mitsuba.render import SurfaceInteraction3f
+
+    np.random.seed(1234)
+    data = np.random.uniform(size=(64, 64, 1)).astype(np.float32)
+
+    bilinear = make_texture(tmpdir, data, 'bilinear')
+    trilinear = make_texture(tmpdir, data, 'trilinear')
+    assert not bilinear.needs_differentials()
+    assert trilinear.needs_differentials()
+
+    si = SurfaceInteraction3f()
+    si.uv = [0.3, 0.6]
+
+    # Without a footprint, the full-resolution image is used
+    value = bilinear.eval_1(si)
+    assert ek.allclose(trilinear.eval_1(si), value, atol=1e-6)
+
+    # A footprint covering the whole texture selects the coarsest (2x2) level
+    si.duv_dx = [1, 0]
+    si.duv_dy = [0, 1]
+    assert ek.allclose(si.footprint(), 1.0)
+
+    q = data[:, :, 0].reshape(2, 32, 2, 32).mean(axis=(1, 3))
+    u, v = si.uv
+    ref = (1 - v) * ((1 - u) * q[0, 0] + u * q[0, 1]) + \
+          v * ((1 - u) * q[1, 0] + u * q[1, 1])
+    assert ek.allclose(trilinear.eval_1(si), ref, atol=1e-5)
+
+    # Bilinear lookups ignore the footprint
+    assert ek.allclose(bilinear.eval_1(si), value, atol=1e-6)
+
+
+def test02_invalid_filter_type(variant_scalar_rgb, tmpdir):
+    with pytest.raises(RuntimeError):
+        make_texture(tmpdir, np.zeros((4, 4, 1), dtype=np.float32), 'ewa')
+
+
+def test03_trilinear_data_update(variant_scalar_rgb, tmpdir):
+    from mitsuba.render import SurfaceInteraction3f
+    from mitsuba.python.util import traverse
+
+    np.random.seed(1234)
+    data = np.random.uniform(size=(64, 64, 1)).astype(np.float32)
+    texture = make_texture(tmpdir, data, 'trilinear')
+
+    # Only the full-resolution image is exposed
+    params = traverse(texture)
+    assert len(params['data']) == 64 * 64
+
+    # The coarser levels are recomputed from it
+    params['data'] = type(params['data'])([0.25] * (64 * 64))
+    params.update()
+
+    si = SurfaceInteraction3f()
+    si.uv = [0.3, 0.6]
+    si.duv_dx = [1, 0]
+    si.duv_dy = [0, 1]
+    assert ek.allclose(texture.eval_1(si), 0.25, atol=1e-6)
+    assert ek.allclose(texture.mean(), 0.25, atol=1e-6)
+
+    # Buffers of the wrong size are rejected
+    params['data'] = type(params['data'])([0.5] * 10)
+    with pytest.raises(RuntimeError):
+        params.update()
@@ -0,0 +1,57 @@
+import mitsuba
+import pytest
+import enoki as ek
+import numpy as np
+
+
+def write_volume(filename, data):
+    res = data.shape[0]
+    with open(filename, 'wb') as f:
+        f.write(b'VOL')
+        f.write(np.uint8(3).tobytes())                 # Version
+        f.write(np.int32(1).tobytes())                 # Float32 data
+        f.write(np.array([res] * 3 + [1], dtype=np.int32).tobytes())
+        f.write(np.array([0, 0, 0, 1, 1, 1], dtype=np.float32).tobytes())
+        f.write(data.astype(np.float32).tobytes())
+
+
+def make_medium(filename, storage):
+    from mitsuba.core.xml import load_string
+
+    return load_string("""<medium version="2.0.0" type="heterogeneous">
+            <volume name="sigma_t" type="gridvolume">
+                <string name="filename" value="{}"/>
+                <string name="storage" value="{}"/>
+            </volume>
+            <rgb name="albedo" value="0.5"/>
+        </medium>""".format(filename, storage))
+
+
+@pytest.mark.parametrize('storage, atol', [('float16', 5e-3), ('uint8', 2e-2)])
+def test01_reduced_precision_storage(variant_scalar_rgb, tmpdir, storage, atol):
+    from mitsuba.render import MediumInteraction3f
+
+    # Smooth density with a spatially varying range
+    res = 20
+    z, y, x = np.meshgrid(*[np.linspace(0, 1, res)] * 3, indexing='ij')
+    data = 1 + 2 * np.sin(3 * x) * np.cos(2 * y) * z
+
+    filename = str(tmpdir.join('grid.vol'))
+    write_volume(filename, data)
+    reference = make_medium(filename, 'float32')
+    medium = make_medium(filename, storage)
+
+    np.random.seed(1234)
+    mi = MediumInteraction3f()
+    for p in np.random.uniform(size=(100, 3)):
+        mi.p = p
+        value = medium.get_scattering_coefficients(mi)[2]
+        expected = reference.get_scattering_coefficients(mi)[2]
+        assert ek.allclose(value, expected, atol=atol)
+
+
+def test02_invalid_storage(variant_scalar_rgb, tmpdir):
+    filename = str(tmpdir.join('grid.vol'))
+    write_volume(filename, np.ones((2, 2, 2)))
+    with pytest.raises(RuntimeError, match='Invalid storage format'):
+        make_medium(filename, 'int4')
@@ -80,6 +80,7 @@ read_binary_volume_data(const std::string &filename) {
                                     ScalarPoint3f(dims[3], dims[4], dims[5]));
     meta.transform = detail::bbox_transform(meta.bbox);
     meta.mean      = 0.;
+    meta.min       = math::Infinity<ScalarFloat>;
     meta.max       = -math::Infinity<ScalarFloat>;
 
     auto raw_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * meta.channel_count]);
@@ -89,14 +90,15 @@ read_binary_volume_data(const std::string &filename) {
             auto val    = detail::read<float>(f);
             raw_data[k] = val;
             meta.mean += (double) val;
+            meta.min = std::min(meta.min, val);
             meta.max = std::max(meta.max, val);
             ++k;
         }
     }
     meta.mean /= double(size * meta.channel_count);
 
-    Log(Debug, "Loaded grid volume data from file %s: dimensions %s, mean value %f, max value %f",
-        filename, meta.shape, meta.mean, meta.max);
+    Log(Debug, "Loaded grid volume data from file %s: dimensions %s, mean value %f, "
+        "min value %f, max value %f", filename, meta.shape, meta.mean, meta.min, meta.max);
 
     return { meta, std::move(raw_data) };
 }